@@ -0,0 +1,229 @@
+#include "AllocTrack.h"
+#include "Profiler.h"
+#include <atomic>
+#include <thread>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace std;
+
+// Nothing in here may allocate through operator new: it runs inside it.
+
+// -------------------- Counters --------------------
+struct AllocSiteRow {
+    bool used = false;
+    int zone = PZ_COUNT;
+    const char* site = nullptr;
+    AllocCounts frame, total, worst;
+};
+
+static atomic<bool> allocTracking{ false };
+static thread::id allocThread;                  // written before allocTracking is set
+
+static thread_local const char* allocSite = nullptr;
+
+static AllocSiteRow allocSites[ALLOC_MAX_SITES + 1];   // last row: overflow
+static AllocCounts allocZoneFrame[PZ_COUNT + 1], allocZoneLast[PZ_COUNT + 1];
+static AllocCounts allocFrame, allocLast, allocWorst, allocTotal;
+static int allocFrames = 0, allocWorstIndex = -1;
+
+static AllocSiteRow& SiteRow(int zone, const char* site) {
+    uintptr_t h = ((uintptr_t)site >> 3) * 31 + (uintptr_t)zone;
+    for (int probe = 0; probe < ALLOC_MAX_SITES; probe++) {
+        AllocSiteRow& row = allocSites[(h + probe) % ALLOC_MAX_SITES];
+        if (!row.used) {
+            row.used = true;
+            row.zone = zone;
+            row.site = site;
+            return row;
+        }
+        if (row.zone == zone && row.site == site) return row;
+    }
+    return allocSites[ALLOC_MAX_SITES];
+}
+
+static void CountAllocation(size_t size) {
+    if (!allocTracking.load(memory_order_relaxed) || this_thread::get_id() != allocThread) return;
+
+    int zone = profiler.currentZone();
+    AllocSiteRow& row = SiteRow(zone, allocSite);
+    row.frame.count++;
+    row.frame.bytes += (long long)size;
+    allocZoneFrame[zone].count++;
+    allocZoneFrame[zone].bytes += (long long)size;
+    allocFrame.count++;
+    allocFrame.bytes += (long long)size;
+}
+
+static void* Allocate(size_t size) {
+    CountAllocation(size);
+    return malloc(size ? size : 1);
+}
+
+// Over-aligned types (alignas above the default) come through the
+// align_val_t overloads; they are counted the same way
+static void* AllocateAligned(size_t size, align_val_t align) {
+    CountAllocation(size);
+    size_t alignment = max((size_t)align, sizeof(void*));
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, size ? size : 1) == 0 ? p : nullptr;
+#endif
+}
+
+static void FreeAligned(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// -------------------- Global new / delete --------------------
+void* operator new(size_t size) {
+    void* p = Allocate(size);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    void* p = Allocate(size);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept { return Allocate(size); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return Allocate(size); }
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+void* operator new(size_t size, align_val_t align) {
+    void* p = AllocateAligned(size, align);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size, align_val_t align) {
+    void* p = AllocateAligned(size, align);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size, align_val_t align, const nothrow_t&) noexcept { return AllocateAligned(size, align); }
+void* operator new[](size_t size, align_val_t align, const nothrow_t&) noexcept { return AllocateAligned(size, align); }
+
+void operator delete(void* p, align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { FreeAligned(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { FreeAligned(p); }
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept { FreeAligned(p); }
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept { FreeAligned(p); }
+
+// -------------------- Frames --------------------
+void AllocTrackingEnable(bool on) {
+    if (on) allocThread = this_thread::get_id();
+    allocTracking.store(on, memory_order_release);
+}
+
+bool AllocTrackingEnabled() {
+    return allocTracking.load(memory_order_relaxed);
+}
+
+void AllocFrameBegin() {
+    if (!AllocTrackingEnabled()) return;
+
+    for (AllocSiteRow& row : allocSites) {
+        if (!row.used) continue;
+        row.total.count += row.frame.count;
+        row.total.bytes += row.frame.bytes;
+        if (row.frame.count > row.worst.count) row.worst = row.frame;
+        row.frame = AllocCounts();
+    }
+    for (int z = 0; z <= PZ_COUNT; z++) {
+        allocZoneLast[z] = allocZoneFrame[z];
+        allocZoneFrame[z] = AllocCounts();
+    }
+
+    allocLast = allocFrame;
+    allocTotal.count += allocFrame.count;
+    allocTotal.bytes += allocFrame.bytes;
+    if (allocWorstIndex < 0 || allocFrame.count > allocWorst.count) {
+        allocWorst = allocFrame;
+        allocWorstIndex = allocFrames;
+    }
+    allocFrame = AllocCounts();
+    allocFrames++;
+}
+
+int AllocFrames() { return allocFrames; }
+AllocCounts AllocLastFrame() { return allocLast; }
+AllocCounts AllocLastFrameInZone(int zone) { return zone >= 0 && zone <= PZ_COUNT ? allocZoneLast[zone] : AllocCounts(); }
+AllocCounts AllocWorstFrame() { return allocWorst; }
+int AllocWorstFrameIndex() { return allocWorstIndex; }
+AllocCounts AllocTotal() { return allocTotal; }
+
+// -------------------- Report --------------------
+vector<AllocSiteReport> AllocSites() {
+    vector<AllocSiteReport> out;
+    for (int i = 0; i <= ALLOC_MAX_SITES; i++) {
+        const AllocSiteRow& row = allocSites[i];
+        if (!row.used || row.total.count == 0) continue;
+        AllocSiteReport r;
+        r.zone = row.zone;
+        r.site = i == ALLOC_MAX_SITES ? "(other sites)" : row.site;
+        r.total = row.total;
+        r.worstFrame = row.worst;
+        out.push_back(r);
+    }
+    sort(out.begin(), out.end(), [](const AllocSiteReport& a, const AllocSiteReport& b) {
+        return a.total.count > b.total.count;
+    });
+    return out;
+}
+
+void PrintAllocReport(int topSites) {
+    int frames = max(1, allocFrames);
+    ios::fmtflags flags = cout.flags();
+    streamsize precision = cout.precision();
+    cout << fixed << setprecision(1);
+    cout << "Allocations over " << allocFrames << " frames: " << allocTotal.count / (double)frames << " per frame ("
+        << allocTotal.bytes / (double)frames << " bytes), worst frame " << allocWorstIndex << " with "
+        << allocWorst.count << " (" << allocWorst.bytes << " bytes)\n";
+
+    vector<AllocSiteReport> sites = AllocSites();
+    int shown = min(topSites, (int)sites.size());
+    for (int i = 0; i < shown; i++) {
+        const AllocSiteReport& s = sites[i];
+        string where = string(ProfileZoneName(s.zone)) + " / " + (s.site ? s.site : "-");
+        if (s.zone == PZ_COUNT) where = string("(no zone) / ") + (s.site ? s.site : "-");
+        cout << "  " << left << setw(36) << where << right
+            << setw(9) << s.total.count / (double)frames << " /frame"
+            << setw(11) << s.total.bytes / (double)frames << " B/frame"
+            << "   worst " << s.worstFrame.count << "\n";
+    }
+    cout.flags(flags);
+    cout.precision(precision);
+}
+
+// -------------------- ScopedAllocSite --------------------
+ScopedAllocSite::ScopedAllocSite(const char* name) : previous(allocSite) {
+    allocSite = name;
+}
+
+ScopedAllocSite::~ScopedAllocSite() {
+    allocSite = previous;
+}
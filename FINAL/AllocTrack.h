@@ -0,0 +1,59 @@
+#pragma once
+#ifndef ALLOC_TRACK_H
+#define ALLOC_TRACK_H
+
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+// -------------------- Allocation Tracking --------------------
+// AllocTrack.cpp replaces the global operator new / delete. They only count
+// once AllocTrackingEnable(true) is called (--track-allocs, or the headless
+// runner's --alloc-budget); until then they are plain malloc / free.
+//
+// Only the thread that enabled tracking is counted, like ScopedIoTimer:
+// the audio, writer and loader threads allocate freely. Each allocation is
+// charged to the profiler zone it happens in (see Profiler.h) and to the
+// innermost ScopedAllocSite, so a report reads "Red / navigateToTile".
+const int ALLOC_MAX_SITES = 128;        // distinct (zone, site) pairs; later ones share one row
+
+struct AllocCounts {
+    long long count = 0;
+    long long bytes = 0;
+};
+
+struct AllocSiteReport {
+    int zone;                   // ProfileZone; PZ_COUNT = outside every zone
+    const char* site;           // nullptr = not inside a ScopedAllocSite
+    AllocCounts total;          // since tracking was enabled
+    AllocCounts worstFrame;
+};
+
+void AllocTrackingEnable(bool on);      // call from the thread to be counted
+bool AllocTrackingEnabled();
+
+void AllocFrameBegin();                 // once per frame, next to profiler.frameBegin()
+int AllocFrames();                      // frames closed since tracking was enabled
+AllocCounts AllocLastFrame();
+AllocCounts AllocLastFrameInZone(int zone);
+AllocCounts AllocWorstFrame();
+int AllocWorstFrameIndex();             // which frame that was (0 = first tracked)
+AllocCounts AllocTotal();
+
+vector<AllocSiteReport> AllocSites();   // most allocations first
+void PrintAllocReport(int topSites = 15);
+
+// Names the code allocating inside it; the innermost site wins
+class ScopedAllocSite {
+public:
+    explicit ScopedAllocSite(const char* name);
+    ~ScopedAllocSite();
+    ScopedAllocSite(const ScopedAllocSite&) = delete;
+    ScopedAllocSite& operator=(const ScopedAllocSite&) = delete;
+
+private:
+    const char* previous;
+};
+
+#endif // ALLOC_TRACK_H
@@ -0,0 +1,152 @@
+#include "AssetPack.h"
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cctype>
+
+using namespace std;
+
+// -------------------- Reading --------------------
+bool AssetPack::open(const string& path) {
+    close();
+    if (!file.open(path)) return false;
+
+    const unsigned char* base = file.bytes();
+    size_t size = file.size();
+    AssetPackHeader h;
+    if (size < sizeof(h)) { close(); return false; }
+    memcpy(&h, base, sizeof(h));
+
+    size_t tocBytes = (size_t)h.count * sizeof(AssetPackEntry);
+    bool ok = memcmp(h.magic, ASSETPACK_MAGIC, 4) == 0 && h.version == ASSETPACK_VERSION
+        && size - sizeof(h) >= tocBytes;
+    if (ok) {
+        uint32_t crc = Crc32(&h, offsetof(AssetPackHeader, crc));
+        ok = Crc32(base + sizeof(h), tocBytes, crc) == h.crc;
+    }
+    if (!ok) {
+        cout << path << " is not a valid asset pack\n";
+        close();
+        return false;
+    }
+
+    // The table lives in the mapping; entries only need their bounds checked
+    entries = (const AssetPackEntry*)(base + sizeof(h));
+    count = h.count;
+    for (uint32_t i = 0; i < count; i++) {
+        if (entries[i].offset > size || entries[i].size > size - entries[i].offset) {
+            cout << path << ": entry " << i << " points past the end of the file\n";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+const unsigned char* AssetPack::find(const string& name, size_t& size, uint32_t* crc) const {
+    auto nameOf = [](const AssetPackEntry& e) {
+        return string(e.name, strnlen(e.name, ASSETPACK_NAME_BYTES));
+    };
+    const AssetPackEntry* last = entries + count;
+    const AssetPackEntry* e = lower_bound(entries, last, name,
+        [&](const AssetPackEntry& a, const string& n) { return nameOf(a) < n; });
+    if (e == last || nameOf(*e) != name) return nullptr;
+
+    size = (size_t)e->size;
+    if (crc) *crc = e->crc;
+    return file.bytes() + e->offset;
+}
+
+// -------------------- Building --------------------
+static string Extension(const string& name) {
+    size_t dot = name.find_last_of('.');
+    string ext = dot == string::npos ? "" : name.substr(dot + 1);
+    for (char& c : ext) c = (char)tolower((unsigned char)c);
+    return ext;
+}
+
+// Cheap signature check so a truncated or misnamed file fails here, not at startup
+static bool LooksLike(const string& ext, const vector<unsigned char>& d) {
+    auto starts = [&](const char* sig, size_t at = 0) {
+        size_t n = strlen(sig);
+        return d.size() >= at + n && memcmp(d.data() + at, sig, n) == 0;
+    };
+    if (ext == "png") return starts("\x89PNG\r\n\x1a\n");
+    if (ext == "wav") return starts("RIFF") && starts("WAVE", 8);
+    if (ext == "ogg") return starts("OggS");
+    if (ext == "ttf" || ext == "otf")
+        return (d.size() >= 4 && memcmp(d.data(), "\0\1\0\0", 4) == 0) || starts("true") || starts("OTTO");
+    if (ext == "mp3") return starts("ID3") || (d.size() >= 2 && d[0] == 0xFF && (d[1] & 0xE0) == 0xE0);
+    return true;    // unknown types are packed as they are
+}
+
+bool BuildAssetPack(const string& outPath, const string& dir, const vector<string>& names) {
+    vector<string> sorted = names;
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+
+    vector<vector<unsigned char>> contents(sorted.size());
+    int problems = 0;
+    for (size_t i = 0; i < sorted.size(); i++) {
+        const string& name = sorted[i];
+        string path = dir.empty() ? name : dir + "/" + name;
+        if (name.size() >= (size_t)ASSETPACK_NAME_BYTES) {
+            cout << "Asset name too long: " << name << "\n";
+            problems++;
+            continue;
+        }
+        ifstream in(path, ios::binary);
+        if (!in.is_open()) {
+            cout << "Missing asset: " << path << "\n";
+            problems++;
+            continue;
+        }
+        contents[i].assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        if (contents[i].empty()) {
+            cout << "Empty asset: " << path << "\n";
+            problems++;
+        }
+        else if (!LooksLike(Extension(name), contents[i])) {
+            cout << "Asset is not a valid ." << Extension(name) << " file: " << path << "\n";
+            problems++;
+        }
+    }
+    if (problems > 0) {
+        cout << problems << " asset problem(s); " << outPath << " was not written\n";
+        return false;
+    }
+
+    // Header and table first, then each file on an aligned offset
+    vector<AssetPackEntry> toc(sorted.size());
+    size_t at = sizeof(AssetPackHeader) + toc.size() * sizeof(AssetPackEntry);
+    for (size_t i = 0; i < sorted.size(); i++) {
+        at = (at + ASSETPACK_ALIGN - 1) / ASSETPACK_ALIGN * ASSETPACK_ALIGN;
+        memset(&toc[i], 0, sizeof(toc[i]));
+        memcpy(toc[i].name, sorted[i].data(), sorted[i].size());
+        toc[i].offset = at;
+        toc[i].size = contents[i].size();
+        toc[i].crc = Crc32(contents[i].data(), contents[i].size());
+        at += contents[i].size();
+    }
+
+    AssetPackHeader h;
+    memcpy(h.magic, ASSETPACK_MAGIC, 4);
+    h.version = ASSETPACK_VERSION;
+    h.count = (uint32_t)toc.size();
+    h.crc = Crc32(toc.data(), toc.size() * sizeof(AssetPackEntry), Crc32(&h, offsetof(AssetPackHeader, crc)));
+
+    vector<unsigned char> buffer(at, 0);
+    memcpy(buffer.data(), &h, sizeof(h));
+    if (!toc.empty()) memcpy(buffer.data() + sizeof(h), toc.data(), toc.size() * sizeof(AssetPackEntry));
+    for (size_t i = 0; i < toc.size(); i++)
+        memcpy(buffer.data() + toc[i].offset, contents[i].data(), contents[i].size());
+
+    if (!WriteFileAtomic(outPath, buffer.data(), buffer.size())) {
+        cout << "Could not write " << outPath << "\n";
+        return false;
+    }
+    cout << "Packed " << toc.size() << " assets (" << buffer.size() << " bytes) into " << outPath << "\n";
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include "FileIO.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+// -------------------- .pak Asset Archive --------------------
+// Little-endian. Layout on disk:
+//   AssetPackHeader
+//   table of contents   count AssetPackEntry, sorted by name
+//   file contents       each starting on a 16-byte boundary
+// The header CRC covers the header fields before it and the whole table, so
+// a damaged table is caught on open; each entry has its own CRC for its
+// contents, checked where the asset is decoded. The game maps the pack once
+// and hands raylib pointers straight into the mapping.
+const char ASSETPACK_MAGIC[4] = { 'P', 'P', 'A', 'K' };
+const uint32_t ASSETPACK_VERSION = 1;
+const int ASSETPACK_NAME_BYTES = 48;        // NUL padded
+const size_t ASSETPACK_ALIGN = 16;
+
+struct AssetPackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t crc;                           // header before it + table of contents
+};
+
+struct AssetPackEntry {
+    char name[ASSETPACK_NAME_BYTES];
+    uint64_t offset;                        // from the start of the file
+    uint64_t size;
+    uint32_t crc;                           // of the contents
+    uint32_t reserved;
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "header layout is part of the file format");
+static_assert(sizeof(AssetPackEntry) == 72, "entry layout is part of the file format");
+
+// -------------------- AssetPack --------------------
+class AssetPack {
+public:
+    bool open(const string& path);          // one open + one map; checks the table
+    void close() { file.close(); entries = nullptr; count = 0; }
+    bool isOpen() const { return file.isOpen(); }
+
+    // Contents of name inside the mapping, nullptr if it isn't in the pack.
+    // Valid until close().
+    const unsigned char* find(const string& name, size_t& size, uint32_t* crc = nullptr) const;
+
+private:
+    MappedFile file;
+    const AssetPackEntry* entries = nullptr;
+    uint32_t count = 0;
+};
+
+// Packs dir/name for every name into outPath. Every file must exist, be
+// non-empty and look like its extension says (PNG, TTF/OTF, WAV, MP3, OGG);
+// otherwise nothing is written and each problem is printed.
+bool BuildAssetPack(const string& outPath, const string& dir, const vector<string>& names);
+
+#endif // ASSET_PACK_H
@@ -0,0 +1,201 @@
+#include "Assets.h"
+#include <iostream>
+#include <algorithm>
+
+using namespace std;
+
+// Same as LoadFont() for a .ttf: 32 px glyphs for ASCII 32..126, 4 px padding
+const int ASSET_FONT_SIZE = 32;
+const int ASSET_FONT_GLYPHS = 95;
+const int ASSET_FONT_PADDING = 4;
+
+// -------------------- AssetLoader --------------------
+AssetLoader::~AssetLoader() {
+    join();
+}
+
+void AssetLoader::join() {
+    for (auto& w : workers)
+        if (w.joinable()) w.join();
+    workers.clear();
+}
+
+void AssetLoader::queue(GameAssets& assets, HighscoreLog& scoreLog) {
+    join();
+    jobs.clear();
+    nextJob = 0;
+    finished = 0;
+
+    // One open and one map for every asset; loose files are the fallback
+    if (!pack.isOpen() && !pack.open(ASSET_PACK_FILE))
+        cout << "No " << ASSET_PACK_FILE << ", loading loose asset files\n";
+
+    // Order matches AssetJob and ASSET_FILES
+    jobs.emplace_back(new Job(MUSIC, ASSET_FILES[ASSET_LOADING_MUSIC], &assets.loadingMusic));
+    jobs.emplace_back(new Job(FONT, ASSET_FILES[ASSET_TITLE_FONT], &assets.titleFont));
+    jobs.emplace_back(new Job(FONT, ASSET_FILES[ASSET_INSTRUCTION_FONT], &assets.instructionFont));
+    jobs.emplace_back(new Job(TEXTURE, ASSET_FILES[ASSET_GHOST_TEXTURE], &assets.ghostTexture));
+    jobs.emplace_back(new Job(MUSIC, ASSET_FILES[ASSET_INTRO_MUSIC], &assets.introMusic));
+    jobs.back()->looping = false;
+    jobs.emplace_back(new Job(SOUND, ASSET_FILES[ASSET_GAME_OVER_SOUND], &assets.gameOverWave));
+    jobs.emplace_back(new Job(HIGHSCORES, "highscores.bin", &scoreLog));
+}
+
+void AssetLoader::start(GameAssets& assets, HighscoreLog& scoreLog, int threads) {
+    queue(assets, scoreLog);
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+    threads = max(1, min(threads, (int)jobs.size()));
+
+    // Each worker takes the next job in order until none are left
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([this]() {
+            for (int i = nextJob++; i < (int)jobs.size(); i = nextJob++) {
+                decode(*jobs[i]);
+                jobs[i]->decoded = true;    // publishes the results to update()
+            }
+        });
+    }
+}
+
+void AssetLoader::loadNow(GameAssets& assets, HighscoreLog& scoreLog) {
+    queue(assets, scoreLog);
+    for (auto& job : jobs) {
+        decode(*job);
+        job->decoded = true;
+    }
+    update();
+}
+
+bool AssetLoader::update() {
+    for (auto& job : jobs) {
+        if (job->uploaded || !job->decoded) continue;
+        upload(*job);
+        job->uploaded = true;
+        finished++;
+        if (!job->ok) cout << "Could not load " << job->path << "\n";
+    }
+    if (done()) join();
+    return done();
+}
+
+// Worker thread: the file's contents, pointing into the pack when there is one
+bool AssetLoader::readBytes(Job& job) {
+    if (pack.isOpen()) {
+        size_t size = 0;
+        uint32_t crc = 0;
+        job.bytes = pack.find(job.path, size, &crc);
+        if (!job.bytes) return false;
+        if (Crc32(job.bytes, size) != crc) {
+            cout << job.path << " is damaged in " << ASSET_PACK_FILE << "\n";
+            job.bytes = nullptr;
+            return false;
+        }
+        job.byteCount = (int)size;
+        return true;
+    }
+    job.fileData = LoadFileData(job.path.c_str(), &job.byteCount);
+    job.bytes = job.fileData;
+    return job.bytes != nullptr;
+}
+
+// Worker thread: file reads and CPU decoding only, nothing that touches GL or the audio device
+void AssetLoader::decode(Job& job) {
+    if (job.kind == HIGHSCORES) {
+        ((HighscoreLog*)job.target)->load(job.path, "highscores.txt");
+        job.ok = true;
+        return;
+    }
+    if (!readBytes(job)) return;
+    string ext = job.path.substr(job.path.find_last_of('.'));
+
+    switch (job.kind) {
+    case TEXTURE:
+        job.image = LoadImageFromMemory(ext.c_str(), job.bytes, job.byteCount);
+        job.ok = job.image.data != nullptr;
+        break;
+    case FONT:
+        job.glyphs = LoadFontData(job.bytes, job.byteCount, ASSET_FONT_SIZE, nullptr, ASSET_FONT_GLYPHS, FONT_DEFAULT);
+        if (!job.glyphs) break;
+        job.image = GenImageFontAtlas(job.glyphs, &job.recs, ASSET_FONT_GLYPHS, ASSET_FONT_SIZE, ASSET_FONT_PADDING, 0);
+        job.ok = job.image.data != nullptr;
+        break;
+    case MUSIC:
+        job.ok = true;  // decoded while it plays
+        return;
+    case SOUND:
+        job.wave = LoadWaveFromMemory(ext.c_str(), job.bytes, job.byteCount);
+        job.ok = job.wave.data != nullptr;
+        if (job.ok) WaveFormat(&job.wave, AUDIO_SAMPLE_RATE, 16, 1);     // resampled here, not on the audio thread
+        break;
+    case HIGHSCORES:
+        break;
+    }
+
+    // Everything but music is decoded now; a loose file copy isn't needed any more
+    if (job.fileData) UnloadFileData(job.fileData);
+    job.fileData = nullptr;
+    job.bytes = nullptr;
+}
+
+// Main thread: turns decoded data into textures and audio buffers
+void AssetLoader::upload(Job& job) {
+    if (!job.ok) return;
+    switch (job.kind) {
+    case TEXTURE:
+        *(Texture2D*)job.target = LoadTextureFromImage(job.image);
+        UnloadImage(job.image);
+        job.image = {};
+        break;
+    case FONT: {
+        Font& font = *(Font*)job.target;
+        font.baseSize = ASSET_FONT_SIZE;
+        font.glyphCount = ASSET_FONT_GLYPHS;
+        font.glyphPadding = ASSET_FONT_PADDING;
+        font.glyphs = job.glyphs;
+        font.recs = job.recs;
+        font.texture = LoadTextureFromImage(job.image);
+        UnloadImage(job.image);
+        job.image = {};
+        job.glyphs = nullptr;   // owned by the font now
+        job.recs = nullptr;
+        break;
+    }
+    case MUSIC: {
+        string ext = job.path.substr(job.path.find_last_of('.'));
+        Music& music = *(Music*)job.target;
+        music = LoadMusicStreamFromMemory(ext.c_str(), job.bytes, job.byteCount);
+        music.looping = job.looping;
+        break;
+    }
+    case SOUND:
+        *(Wave*)job.target = job.wave;     // CPU only; owned by GameAssets now
+        job.wave = {};
+        break;
+    case HIGHSCORES:
+        break;
+    }
+}
+
+void AssetLoader::unload() {
+    join();
+    for (auto& job : jobs) {
+        if (job->uploaded && job->ok) {
+            switch (job->kind) {
+            case TEXTURE: UnloadTexture(*(Texture2D*)job->target); break;
+            case FONT: UnloadFont(*(Font*)job->target); break;
+            case MUSIC: UnloadMusicStream(*(Music*)job->target); break;
+            case SOUND: UnloadWave(*(Wave*)job->target); break;
+            case HIGHSCORES: break;
+            }
+        }
+        // Decoded but never uploaded
+        if (job->image.data) UnloadImage(job->image);
+        if (job->glyphs) UnloadFontData(job->glyphs, ASSET_FONT_GLYPHS);
+        if (job->recs) MemFree(job->recs);
+        if (job->wave.data) UnloadWave(job->wave);
+        if (job->fileData) UnloadFileData(job->fileData);
+    }
+    jobs.clear();
+    finished = 0;
+    pack.close();   // music streams were reading from it
+}
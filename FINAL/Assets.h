@@ -0,0 +1,103 @@
+#pragma once
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include "raylib.h"
+#include "Highscore.h"
+#include "AssetPack.h"
+#include "Audio.h"
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+using namespace std;
+
+// Everything the game loads from disk at startup
+struct GameAssets {
+    Texture2D ghostTexture = {};
+    Font titleFont = {};
+    Font instructionFont = {};
+    Music loadingMusic = {};
+    Music introMusic = {};
+    Wave gameOverWave = {};     // mixer format (AUDIO_SAMPLE_RATE, 16-bit mono), played by AudioSystem
+};
+
+// Indices of the jobs, in the order they are queued: the loading screen's
+// own music and font come first so it can use them early
+enum AssetJob { ASSET_LOADING_MUSIC, ASSET_TITLE_FONT, ASSET_INSTRUCTION_FONT, ASSET_GHOST_TEXTURE,
+    ASSET_INTRO_MUSIC, ASSET_GAME_OVER_SOUND, ASSET_HIGHSCORES };
+
+// Files the game needs, in AssetJob order. --pack-assets packs exactly
+// these, and refuses to write a pack if any is missing.
+const char* const ASSET_PACK_FILE = "assets.pak";
+const char* const ASSET_FILES[] = { "wakawaka.mp3", "pacman_font.ttf", "instruction.ttf",
+    "Ghost16.png", "pacIntro.mp3", "gameover2.wav" };
+static_assert(sizeof(ASSET_FILES) / sizeof(ASSET_FILES[0]) == ASSET_HIGHSCORES, "one file per asset job");
+
+// -------------------- Asset Loader --------------------
+// Reads and decodes assets on worker threads while the loading screen runs.
+// Only what needs the GL context or the audio device (texture uploads,
+// audio buffers) happens on the main thread, in update().
+// With assets.pak present the whole pack is mapped once and raylib decodes
+// straight from the mapping; otherwise the loose files are read. Music
+// streams decode from those bytes while playing, so the mapping (or the
+// file copy) stays alive until unload(). Highscores load on a worker too;
+// the log must not be touched until done().
+class AssetLoader {
+public:
+    ~AssetLoader();
+
+    void start(GameAssets& assets, HighscoreLog& scoreLog, int threads = 0);
+    void loadNow(GameAssets& assets, HighscoreLog& scoreLog);  // same work, all on this thread
+
+    // Main thread, once per frame: finishes whatever the workers decoded.
+    // Returns true once everything is loaded.
+    bool update();
+
+    bool done() const { return finished == (int)jobs.size(); }
+    float progress() const { return jobs.empty() ? 1.0f : (float)finished / jobs.size(); }
+    bool isLoaded(int job) const { return job < (int)jobs.size() && jobs[job]->uploaded && jobs[job]->ok; }
+
+    void unload();  // GPU/audio resources, the music file bytes and the pack
+
+private:
+    enum Kind { TEXTURE, FONT, MUSIC, SOUND, HIGHSCORES };
+
+    struct Job {
+        Kind kind;
+        string path;
+        void* target = nullptr;         // Texture2D, Font, Music or Wave in GameAssets; HighscoreLog
+        bool looping = true;            // MUSIC
+        bool ok = false;
+
+        // Worker output
+        const unsigned char* bytes = nullptr;   // file contents: in the pack, or fileData
+        int byteCount = 0;
+        unsigned char* fileData = nullptr;      // loose file copy; MUSIC keeps it while playing
+        Image image = {};               // TEXTURE, FONT atlas
+        GlyphInfo* glyphs = nullptr;    // FONT
+        Rectangle* recs = nullptr;
+        Wave wave = {};                 // SOUND
+
+        atomic<bool> decoded{ false };
+        bool uploaded = false;
+
+        Job(Kind k, const string& p, void* t) : kind(k), path(p), target(t) {}
+    };
+
+    AssetPack pack;
+    vector<unique_ptr<Job>> jobs;
+    vector<thread> workers;
+    atomic<int> nextJob{ 0 };
+    int finished = 0;
+
+    void queue(GameAssets& assets, HighscoreLog& scoreLog);
+    bool readBytes(Job& job);           // worker thread
+    void decode(Job& job);              // worker thread
+    static void upload(Job& job);       // main thread
+    void join();
+};
+
+#endif // ASSETS_H
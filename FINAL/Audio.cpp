@@ -0,0 +1,231 @@
+#include "Audio.h"
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+static atomic<AudioSystem*> activeAudio{ nullptr };
+static thread::id audioOwner;      // the thread whose PlaySfx calls are heard
+static thread_local int sfxMuted = 0;   // ScopedSfxMute depth on this thread
+
+// -------------------- Built-in Effects --------------------
+// Short square/triangle sweeps, generated once at start(). freq(t) gives the
+// pitch in Hz at t in [0, 1]; the level fades out over the last fadeFrom.
+template <typename Pitch>
+static vector<int16_t>* Synth(float seconds, bool square, float level, float fadeFrom, Pitch freq) {
+    int frames = (int)(seconds * AUDIO_SAMPLE_RATE);
+    vector<int16_t>* pcm = new vector<int16_t>(frames);
+    double phase = 0.0;
+    for (int i = 0; i < frames; i++) {
+        float t = (float)i / frames;
+        phase += freq(t) / AUDIO_SAMPLE_RATE;
+        double frac = phase - floor(phase);
+        double wave = square ? (frac < 0.5 ? 1.0 : -1.0) : 4.0 * fabs(frac - 0.5) - 1.0;
+        float env = t < fadeFrom ? 1.0f : 1.0f - (t - fadeFrom) / (1.0f - fadeFrom);
+        (*pcm)[i] = (int16_t)(wave * env * level * 32767.0);
+    }
+    return pcm;
+}
+
+// -------------------- AudioSystem --------------------
+AudioSystem::~AudioSystem() {
+    stop();
+}
+
+void AudioSystem::start() {
+    stop();
+
+    // Waka: down one pellet, up the next
+    sfx[SFX_PELLET] = Synth(0.07f, false, 0.35f, 0.6f, [](float t) { return 480.0f - 240.0f * t; });
+    vector<int16_t>* alt = Synth(0.07f, false, 0.35f, 0.6f, [](float t) { return 240.0f + 240.0f * t; });
+    wakaAlt.swap(*alt);
+    delete alt;
+    sfx[SFX_GHOST_EATEN] = Synth(0.35f, true, 0.18f, 0.7f, [](float t) { return 200.0f + 1400.0f * t * t; });
+    sfx[SFX_DEATH] = Synth(1.2f, true, 0.18f, 0.75f, [](float t) {
+        return (900.0f - 750.0f * t) * (1.0f + 0.08f * sinf(t * 1.2f * 12.0f * 6.2831853f));
+    });
+    sfxSet[SFX_PELLET] = sfxSet[SFX_GHOST_EATEN] = sfxSet[SFX_DEATH] = true;
+
+    // Small mixer buffers keep effects responsive
+    SetAudioStreamBufferSizeDefault(AUDIO_SFX_BUFFER_FRAMES);
+    mixer = LoadAudioStream(AUDIO_SAMPLE_RATE, 16, 1);
+    SetAudioStreamBufferSizeDefault(0);
+    mixBuffer.assign(AUDIO_SFX_BUFFER_FRAMES, 0);
+    outBuffer.assign(AUDIO_SFX_BUFFER_FRAMES, 0);
+
+    audioOwner = this_thread::get_id();
+    activeAudio = this;
+    running = true;
+    worker = thread([this]() { run(); });
+}
+
+void AudioSystem::stop() {
+    if (!worker.joinable()) return;
+    activeAudio = nullptr;
+    running = false;
+    worker.join();
+
+    // Whatever was still queued, including sounds never handed over
+    Command c;
+    while (commands.pop(c))
+        if (c.type == CMD_SET_SFX) delete c.pcm;
+    for (int i = 0; i < SFX_COUNT; i++) {
+        delete sfx[i];
+        sfx[i] = nullptr;
+        sfxSet[i] = false;
+    }
+    for (int i = 0; i < MUSIC_COUNT; i++) {
+        musicLoaded[i] = musicSet[i] = false;
+        musicPlaying[i] = false;
+    }
+    for (Voice& v : voices) v = Voice();
+    UnloadAudioStream(mixer);
+    mixer = {};
+}
+
+void AudioSystem::send(const Command& c) {
+    if (commands.push(c)) return;
+    dropped++;      // queue full: the audio thread is stuck; never block the frame on it
+    if (c.type == CMD_SET_SFX) delete c.pcm;
+}
+
+void AudioSystem::setMusic(MusicId id, const Music& m) {
+    Command c = {};
+    c.type = CMD_SET_MUSIC;
+    c.id = id;
+    c.music = m;
+    send(c);
+    musicSet[id] = true;
+}
+
+void AudioSystem::setSfx(SfxId id, const Wave& wave) {
+    if (!wave.data || wave.frameCount == 0) return;
+
+    // The loader already converts on its worker; anything else is converted here
+    Wave w = WaveCopy(wave);
+    if (w.sampleRate != (unsigned)AUDIO_SAMPLE_RATE || w.sampleSize != 16 || w.channels != 1)
+        WaveFormat(&w, AUDIO_SAMPLE_RATE, 16, 1);
+    const int16_t* samples = (const int16_t*)w.data;
+
+    Command c = {};
+    c.type = CMD_SET_SFX;
+    c.id = id;
+    c.pcm = new vector<int16_t>(samples, samples + w.frameCount);
+    UnloadWave(w);
+    send(c);
+    sfxSet[id] = true;
+}
+
+void AudioSystem::playMusic(MusicId id) {
+    Command c = {};
+    c.type = CMD_PLAY_MUSIC;
+    c.id = id;
+    send(c);
+}
+
+void AudioSystem::stopMusic(MusicId id) {
+    Command c = {};
+    c.type = CMD_STOP_MUSIC;
+    c.id = id;
+    send(c);
+}
+
+void AudioSystem::playSfx(SfxId id, float volume) {
+    Command c = {};
+    c.type = CMD_PLAY_SFX;
+    c.id = id;
+    c.volume = volume;
+    send(c);
+}
+
+// -------------------- Audio Thread --------------------
+void AudioSystem::run() {
+    PlayAudioStream(mixer);
+    while (running) {
+        Command c;
+        while (commands.pop(c)) apply(c);
+
+        for (int i = 0; i < MUSIC_COUNT; i++) {
+            if (!musicLoaded[i]) continue;
+            UpdateMusicStream(music[i]);    // refills only what has been played
+            musicPlaying[i].store(IsMusicStreamPlaying(music[i]), memory_order_relaxed);
+        }
+        while (IsAudioStreamProcessed(mixer)) mix();
+
+        this_thread::sleep_for(chrono::milliseconds(AUDIO_TICK_MS));
+    }
+    for (int i = 0; i < MUSIC_COUNT; i++)
+        if (musicLoaded[i]) StopMusicStream(music[i]);
+    StopAudioStream(mixer);
+}
+
+void AudioSystem::apply(const Command& c) {
+    switch (c.type) {
+    case CMD_SET_MUSIC:
+        music[c.id] = c.music;
+        musicLoaded[c.id] = true;
+        break;
+    case CMD_SET_SFX:
+        // A voice may still point at the old buffer
+        for (Voice& v : voices)
+            if (v.pcm == sfx[c.id]) v.pcm = nullptr;
+        delete sfx[c.id];
+        sfx[c.id] = c.pcm;
+        break;
+    case CMD_PLAY_MUSIC:
+        if (musicLoaded[c.id] && !IsMusicStreamPlaying(music[c.id])) PlayMusicStream(music[c.id]);
+        musicPlaying[c.id] = musicLoaded[c.id];
+        break;
+    case CMD_STOP_MUSIC:
+        if (musicLoaded[c.id]) StopMusicStream(music[c.id]);
+        musicPlaying[c.id] = false;
+        break;
+    case CMD_PLAY_SFX: {
+        const vector<int16_t>* pcm = sfx[c.id];
+        if (c.id == SFX_PELLET) {
+            wakaFlip = !wakaFlip;
+            if (wakaFlip) pcm = &wakaAlt;
+        }
+        if (pcm) startVoice(pcm, c.volume);
+        break;
+    }
+    }
+}
+
+void AudioSystem::startVoice(const vector<int16_t>* pcm, float volume) {
+    Voice* slot = &voices[0];
+    for (Voice& v : voices) {
+        if (!v.pcm) { slot = &v; break; }
+        if (v.started < slot->started) slot = &v;   // steal the oldest
+    }
+    slot->pcm = pcm;
+    slot->at = 0;
+    slot->volume = volume;
+    slot->started = ++voiceCounter;
+}
+
+void AudioSystem::mix() {
+    fill(mixBuffer.begin(), mixBuffer.end(), 0);
+    for (Voice& v : voices) {
+        if (!v.pcm) continue;
+        size_t n = min((size_t)AUDIO_SFX_BUFFER_FRAMES, v.pcm->size() - v.at);
+        int gain = (int)(v.volume * 256.0f);
+        const int16_t* src = v.pcm->data() + v.at;
+        for (size_t i = 0; i < n; i++) mixBuffer[i] += (src[i] * gain) >> 8;
+        v.at += n;
+        if (v.at >= v.pcm->size()) v.pcm = nullptr;
+    }
+    for (int i = 0; i < AUDIO_SFX_BUFFER_FRAMES; i++)
+        outBuffer[i] = (int16_t)max(-32768, min(32767, mixBuffer[i]));
+    UpdateAudioStream(mixer, outBuffer.data(), AUDIO_SFX_BUFFER_FRAMES);
+}
+
+// -------------------- Triggering --------------------
+void PlaySfx(SfxId id, float volume) {
+    AudioSystem* audio = activeAudio.load(memory_order_acquire);
+    if (audio && sfxMuted == 0 && this_thread::get_id() == audioOwner) audio->playSfx(id, volume);
+}
+
+ScopedSfxMute::ScopedSfxMute() { sfxMuted++; }
+ScopedSfxMute::~ScopedSfxMute() { sfxMuted--; }
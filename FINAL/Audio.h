@@ -0,0 +1,108 @@
+#pragma once
+#ifndef AUDIO_H
+#define AUDIO_H
+
+#include "raylib.h"
+#include "SpscQueue.h"
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+enum SfxId { SFX_PELLET, SFX_GHOST_EATEN, SFX_DEATH, SFX_GAME_OVER, SFX_COUNT };
+enum MusicId { MUSIC_LOADING, MUSIC_INTRO, MUSIC_COUNT };
+
+const int AUDIO_SAMPLE_RATE = 44100;        // SFX are mono 16-bit at this rate
+const int AUDIO_SFX_VOICES = 16;            // sounds playing at once; the oldest is cut when full
+const int AUDIO_SFX_BUFFER_FRAMES = 512;    // mixer buffer, about 12 ms
+const int AUDIO_TICK_MS = 3;
+
+// -------------------- Audio Thread --------------------
+// Owns all playback on its own thread, so a slow frame can't starve the
+// music or mixer buffers. The game thread only pushes commands on a
+// lock-free queue; the audio thread streams the music and mixes sound
+// effects (PCM decoded or generated once, played through a voice pool) into
+// one raylib AudioStream.
+class AudioSystem {
+public:
+    ~AudioSystem();
+
+    // After InitAudioDevice. Generates the built-in effects and starts the thread.
+    void start();
+    void stop();                            // before the music streams are unloaded
+
+    // Game thread only. Music and sounds are handed over once loaded; the
+    // audio thread uses them from then on.
+    void setMusic(MusicId id, const Music& music);
+    void setSfx(SfxId id, const Wave& wave);        // copied and converted to the mixer format
+    bool hasMusic(MusicId id) const { return musicSet[id]; }
+    bool hasSfx(SfxId id) const { return sfxSet[id]; }
+
+    void playMusic(MusicId id);             // no-op if it is already playing
+    void stopMusic(MusicId id);
+    void playSfx(SfxId id, float volume = 1.0f);
+    bool isMusicPlaying(MusicId id) const { return musicPlaying[id].load(memory_order_relaxed); }
+
+    int droppedCommands() const { return dropped; }
+
+private:
+    enum CommandType { CMD_SET_MUSIC, CMD_SET_SFX, CMD_PLAY_MUSIC, CMD_STOP_MUSIC, CMD_PLAY_SFX };
+    struct Command {
+        CommandType type;
+        int id;
+        float volume;
+        Music music;                        // CMD_SET_MUSIC
+        vector<int16_t>* pcm;               // CMD_SET_SFX, owned by the audio thread once sent
+    };
+
+    struct Voice {
+        const vector<int16_t>* pcm = nullptr;
+        size_t at = 0;
+        float volume = 1.0f;
+        uint64_t started = 0;
+    };
+
+    SpscQueue<Command, 256> commands;
+    thread worker;
+    atomic<bool> running{ false };
+    atomic<bool> musicPlaying[MUSIC_COUNT] = {};
+    bool musicSet[MUSIC_COUNT] = {};        // game thread's view
+    bool sfxSet[SFX_COUNT] = {};
+    int dropped = 0;
+
+    // Audio thread only
+    Music music[MUSIC_COUNT] = {};
+    bool musicLoaded[MUSIC_COUNT] = {};
+    vector<int16_t>* sfx[SFX_COUNT] = {};
+    vector<int16_t> wakaAlt;                // every other pellet uses this pitch
+    bool wakaFlip = false;
+    Voice voices[AUDIO_SFX_VOICES];
+    uint64_t voiceCounter = 0;
+    AudioStream mixer = {};
+    vector<int32_t> mixBuffer;
+    vector<int16_t> outBuffer;
+
+    void send(const Command& c);
+    void run();
+    void apply(const Command& c);
+    void startVoice(const vector<int16_t>* pcm, float volume);
+    void mix();
+};
+
+// Plays a sound effect through the running AudioSystem. Only calls from the
+// thread that started it are heard, so simulations on worker threads stay silent.
+void PlaySfx(SfxId id, float volume = 1.0f);
+
+// Silences PlaySfx on this thread while alive, for simulations that run on
+// the owner thread (e.g. the autopilot playing ahead)
+class ScopedSfxMute {
+public:
+    ScopedSfxMute();
+    ~ScopedSfxMute();
+    ScopedSfxMute(const ScopedSfxMute&) = delete;
+    ScopedSfxMute& operator=(const ScopedSfxMute&) = delete;
+};
+
+#endif // AUDIO_H
@@ -0,0 +1,381 @@
+#include "Autopilot.h"
+#include "Audio.h"
+#include "Profiler.h"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+// -------------------- Search Helpers --------------------
+static void PacTile(const GameWorld& world, int& tx, int& ty) {
+    const Pacman& pac = world.pac;
+    tx = min(max((int)((pac.x + pac.tileSize / 2) / pac.tileSize), 0), world.maze.cols - 1);
+    ty = min(max((int)((pac.y + pac.tileSize / 2) / pac.tileSize), 0), world.maze.rows - 1);
+}
+
+// True around the middle of Pacman's tile along the way it is going: the
+// window is one frame's move wide, so every pass through a tile hits it
+static bool NearTileCentre(const GameWorld& world, int tx, int ty) {
+    const Pacman& pac = world.pac;
+    float half = pac.tileSize / 2.0f;
+    bool horizontal = pac.direction == Pacman::LEFT || pac.direction == Pacman::RIGHT;
+    float offset = horizontal ? pac.x + half - (tx * pac.tileSize + half) : pac.y + half - (ty * pac.tileSize + half);
+    return fabs(offset) <= pac.speed * 0.5f;
+}
+
+// Directions Pacman could turn to from its tile. Cornering early can leave
+// it jammed off-centre where none of those can move, and the only way out is
+// toward a tile the nav tables call a wall: then it's whatever can move.
+// Never empty.
+static int PacMoves(GameWorld& world, int moves[4]) {
+    Pacman& pac = world.pac;
+    int tx, ty;
+    PacTile(world, tx, ty);
+    const MapNav& nav = world.maze.nav;
+    unsigned char mask = nav.walkMask ? nav.walkMask[ty * nav.cols + tx] : 0;
+
+    float half = pac.tileSize / 2.0f;
+    unsigned char canMove = 0;
+    for (int d = 0; d < 4; d++)
+        if (!pac.collidesAtCenter(world.maze, pac.x + NAV_DX[d] * pac.speed + half, pac.y + NAV_DY[d] * pac.speed + half))
+            canMove |= 1 << d;
+    if (!(mask & canMove)) mask = canMove;
+
+    int count = 0;
+    for (int d = 0; d < 4; d++)
+        if (mask >> d & 1) moves[count++] = d;
+    if (count == 0) moves[count++] = pac.direction;
+    return count;
+}
+
+// Plays frames until Pacman reaches the centre of another tile or stops;
+// true when the game can't go on from here for the search (a life lost,
+// game over, level cleared)
+static bool PlaySegment(GameWorld& world, const LevelInfo& level, int direction) {
+    Pacman& pac = world.pac;
+    pac.desiredDirection = (Pacman::Direction)direction;
+    int lives = pac.lives;
+    int sx, sy;
+    PacTile(world, sx, sy);
+
+    for (int f = 0; f < AUTOPILOT_SEGMENT_FRAMES; f++) {
+        float px = pac.x, py = pac.y;
+        UpdateGameplay(world, level);
+        if (pac.lives < lives || pac.lives <= 0 || world.maze.pelletsLeft <= 0) return true;
+        if (pac.x == px && pac.y == py) return false;
+        int tx, ty;
+        PacTile(world, tx, ty);
+        if ((tx != sx || ty != sy) && NearTileCentre(world, tx, ty)) return false;
+    }
+    return false;
+}
+
+static float Evaluate(const GameWorld& world, int rootScore, int rootLives) {
+    const Pacman& pac = world.pac;
+    float value = (pac.score - rootScore) / AUTOPILOT_SCORE_SCALE - (float)(rootLives - pac.lives);
+    if (world.maze.pelletsLeft <= 0) return value + AUTOPILOT_CLEAR_BONUS;
+
+    // Nothing else separates quiet moves in an empty corridor: head for food
+    const MapNav& nav = world.maze.nav;
+    if (pac.dying || !nav.hasAllPairs()) return value;
+    int tx, ty;
+    PacTile(world, tx, ty);
+    int nearest = -1;
+    for (const MapChunk& c : world.maze.chunks)
+        for (CoinNode* n = c.coins.head; n; n = n->next) {
+            int d = nav.distance(tx, ty, n->x, n->y);
+            if (d >= 0 && (nearest < 0 || d < nearest)) nearest = d;
+        }
+    return nearest > 0 ? value - AUTOPILOT_PELLET_PULL * nearest : value;
+}
+
+// -------------------- Searcher --------------------
+// One thread's tree and world copy. Nodes and their snapshots are kept
+// between decisions so a search allocates only when the tree outgrows them.
+struct Autopilot::Searcher {
+    struct Node {
+        int parent;
+        int action;                 // direction taken from the parent
+        int child[4];               // per direction, -1 = not expanded
+        int untried[4];
+        int untriedCount;
+        int visits;
+        float total;
+        bool terminal;
+    };
+
+    unique_ptr<GameWorld> world;
+    mt19937 rng;
+    vector<Node> nodes;
+    vector<GameSnapshot> states;    // per node; only the first nodes.size() are live
+    int iterations = 0;
+
+    int addNode(int parent, int action, bool terminal) {
+        Node n;
+        n.parent = parent;
+        n.action = action;
+        fill(begin(n.child), end(n.child), -1);
+        n.untriedCount = terminal ? 0 : PacMoves(*world, n.untried);
+        n.visits = 0;
+        n.total = 0.0f;
+        n.terminal = terminal;
+        nodes.push_back(n);
+        if (states.size() < nodes.size()) states.resize(nodes.size());
+        CaptureGame(*world, states[nodes.size() - 1]);
+        return (int)nodes.size() - 1;
+    }
+
+    int bestChild(int parent) const {
+        const Node& p = nodes[parent];
+        float logN = log((float)max(p.visits, 1));
+        int best = -1;
+        float bestScore = 0.0f;
+        for (int d = 0; d < 4; d++) {
+            int c = p.child[d];
+            if (c < 0) continue;
+            const Node& n = nodes[c];
+            float score = n.total / n.visits + AUTOPILOT_EXPLORATION * sqrt(logN / n.visits);
+            if (best < 0 || score > bestScore) { best = c; bestScore = score; }
+        }
+        return best;
+    }
+
+    void rollout(const LevelInfo& level) {
+        for (int i = 0; i < AUTOPILOT_ROLLOUT_DECISIONS; i++) {
+            // Random walk that doesn't turn back unless it has to
+            int moves[4];
+            int count = PacMoves(*world, moves);
+            int reverse = world->pac.direction ^ 1;
+            if (count > 1) {
+                int* end = remove(moves, moves + count, reverse);
+                count = (int)(end - moves);
+            }
+            if (PlaySegment(*world, level, moves[rng() % count])) return;
+        }
+    }
+
+    void search(const GameSnapshot& root, const LevelInfo& level, int budget,
+        chrono::steady_clock::time_point deadline, bool timed) {
+        ScopedSfxMute mute;
+        nodes.clear();
+        RestoreGame(*world, root);
+        addNode(-1, -1, false);
+        int rootScore = root.pac.score, rootLives = root.pac.lives;
+
+        for (iterations = 0; budget <= 0 || iterations < budget; iterations++) {
+            if (timed && chrono::steady_clock::now() >= deadline) break;
+
+            // Select down the tree while every move has been tried
+            int n = 0;
+            while (!nodes[n].terminal && nodes[n].untriedCount == 0) {
+                int next = bestChild(n);
+                if (next < 0) break;
+                n = next;
+            }
+            RestoreGame(*world, states[n]);
+
+            // Expand one untried move
+            if (nodes[n].untriedCount > 0) {
+                Node& node = nodes[n];
+                int pick = rng() % node.untriedCount;
+                int action = node.untried[pick];
+                node.untried[pick] = node.untried[--node.untriedCount];
+                bool terminal = PlaySegment(*world, level, action);
+                int child = addNode(n, action, terminal);
+                nodes[n].child[action] = child;
+                n = child;
+            }
+
+            if (!nodes[n].terminal) rollout(level);
+            float value = Evaluate(*world, rootScore, rootLives);
+            for (; n >= 0; n = nodes[n].parent) {
+                nodes[n].visits++;
+                nodes[n].total += value;
+            }
+        }
+    }
+};
+
+// -------------------- Autopilot --------------------
+Autopilot::Autopilot() {}
+Autopilot::~Autopilot() {}
+
+void Autopilot::configure(const AutopilotConfig& c) {
+    config = c;
+}
+
+void Autopilot::forget() {
+    searchers.clear();
+    clonedNav = nullptr;
+    lastTileX = lastTileY = -1;
+}
+
+bool Autopilot::wantsDecision(const GameWorld& world) {
+    const Pacman& pac = world.pac;
+    if (pac.dying || pac.lives <= 0 || world.maze.pelletsLeft <= 0) {
+        lastTileX = lastTileY = -1;
+        return false;
+    }
+    int tx, ty;
+    PacTile(world, tx, ty);
+    bool due = (tx != lastTileX || ty != lastTileY) && NearTileCentre(world, tx, ty);
+    bool stuck = pac.x == lastX && pac.y == lastY;
+    lastX = pac.x;
+    lastY = pac.y;
+    if (!due && !stuck) return false;
+    lastTileX = tx;
+    lastTileY = ty;
+    return true;
+}
+
+int Autopilot::decide(GameWorld& world, const LevelInfo& level) {
+    ScopedZone zone(PZ_AUTOPILOT);
+    ScopedProfilePause pause;   // the simulated frames aren't this frame's gameplay
+    auto start = chrono::steady_clock::now();
+
+    int threads = config.threads > 0 ? config.threads : (int)thread::hardware_concurrency();
+    threads = max(threads, 1);
+    const Map& maze = world.maze;
+    if ((int)searchers.size() != threads || clonedNav != maze.nav.walkMask ||
+        clonedCols != maze.cols || clonedRows != maze.rows || clonedHard != maze.isHard) {
+        searchers.clear();
+        for (int i = 0; i < threads; i++) {
+            unique_ptr<Searcher> s(new Searcher());
+            s->world = CloneGameWorld(world);
+            searchers.push_back(move(s));
+        }
+        clonedNav = maze.nav.walkMask;
+        clonedCols = maze.cols;
+        clonedRows = maze.rows;
+        clonedHard = maze.isHard;
+    }
+    // F7 / F8 change these on the live world; the search must tick ghosts the same way
+    for (auto& s : searchers) {
+        s->world->ghostAI.config = world.ghostAI.config;
+        s->world->twoPhaseGhosts = world.twoPhaseGhosts;
+    }
+
+    CaptureGame(world, root);
+
+    bool timed = config.timeMs > 0.0f;
+    int budget = config.iterations > 0 ? (config.iterations + threads - 1) / threads : 0;
+    if (!timed && budget <= 0) budget = 1;
+    auto deadline = start + chrono::microseconds((long long)(config.timeMs * 1000.0f));
+
+    for (int i = 0; i < threads; i++)
+        searchers[i]->rng.seed(config.seed + 7919u * (uint32_t)lastStats.decisions + 104729u * (uint32_t)i);
+
+    // Root parallel: one tree per thread, the calling thread runs the first
+    vector<thread> workers;
+    for (int i = 1; i < threads; i++)
+        workers.emplace_back([&, i]() { searchers[i]->search(root, level, budget, deadline, timed); });
+    searchers[0]->search(root, level, budget, deadline, timed);
+    for (thread& t : workers) t.join();
+
+    int visits[4] = {};
+    float total[4] = {};
+    lastStats.iterations = 0;
+    for (auto& s : searchers) {
+        lastStats.iterations += s->iterations;
+        const Searcher::Node& r = s->nodes[0];
+        for (int d = 0; d < 4; d++) {
+            if (r.child[d] < 0) continue;
+            visits[d] += s->nodes[r.child[d]].visits;
+            total[d] += s->nodes[r.child[d]].total;
+        }
+    }
+
+    // Most visited move; ties go to the better average
+    int best = world.pac.direction;
+    for (int d = 0; d < 4; d++) {
+        if (visits[d] == 0) continue;
+        if (visits[best] == 0 || visits[d] > visits[best] ||
+            (visits[d] == visits[best] && total[d] / visits[d] > total[best] / visits[best])) best = d;
+    }
+
+    copy(begin(visits), end(visits), lastStats.visits);
+    lastStats.decisions++;
+    lastStats.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    lastStats.totalMs += lastStats.ms;
+    return best;
+}
+
+void Autopilot::drive(GameWorld& world, const LevelInfo& level) {
+    if (wantsDecision(world)) world.pac.desiredDirection = (Pacman::Direction)decide(world, level);
+}
+
+// -------------------- Evaluation --------------------
+static const int AUTOPILOT_EVAL_MAX_FRAMES = 10 * 60 * 60;     // a game that lasts longer is stopped
+
+int RunAutopilotEval(const LevelInfo& level, int games, int iterations, int threads) {
+    unique_ptr<Map> map = BuildLevelMap(level, TILE_SIZE);
+    if (!map) {
+        cout << "Level '" << level.name << "' failed to load\n";
+        return 1;
+    }
+    GameWorld world(move(*map), Texture2D(), TILE_SIZE);
+    Autopilot pilot;
+    games = max(games, 1);
+
+    struct Totals { double score = 0, cleared = 0, eaten = 0, frames = 0, livesLost = 0, decisionMs = 0; int decisions = 0; };
+    Totals results[2];
+    const char* names[2] = { "easy", "hard" };
+
+    cout << "Autopilot: " << games << " games per difficulty of '" << level.name << "', "
+        << iterations << " iterations per decision\n" << fixed << setprecision(1);
+    for (int hard = 0; hard < 2; hard++) {
+        SetGameDifficulty(world, hard == 1);
+        Totals& t = results[hard];
+        for (int g = 0; g < games; g++) {
+            AutopilotConfig config;
+            config.iterations = iterations;
+            config.threads = threads;
+            config.seed = (uint32_t)g + 1;
+            pilot.configure(config);
+            ResetGameWorld(world, level);
+            int pellets = world.maze.pelletsLeft, livesLost = 0;
+            int decisions = pilot.stats().decisions;
+            double decisionMs = pilot.stats().totalMs;
+
+            int frames = 0;
+            while (frames < AUTOPILOT_EVAL_MAX_FRAMES && world.pac.lives > 0 && world.maze.pelletsLeft > 0) {
+                int lives = world.pac.lives;    // power-ups can give lives back, so count each loss
+                pilot.drive(world, level);
+                UpdateGameplay(world, level);
+                livesLost += max(lives - world.pac.lives, 0);
+                frames++;
+            }
+
+            bool cleared = world.maze.pelletsLeft <= 0;
+            t.score += world.pac.score;
+            t.cleared += cleared ? 1 : 0;
+            t.eaten += 100.0 * (pellets - world.maze.pelletsLeft) / max(pellets, 1);
+            t.frames += frames;
+            t.livesLost += livesLost;
+            t.decisions += pilot.stats().decisions - decisions;
+            t.decisionMs += pilot.stats().totalMs - decisionMs;
+            cout << "  " << names[hard] << " game " << g + 1 << ": score " << world.pac.score
+                << (cleared ? ", cleared" : "") << ", " << frames / 60.0 << " s\n";
+        }
+
+        cout << names[hard] << ": avg score " << t.score / games << ", cleared " << t.cleared << "/" << games
+            << ", pellets " << t.eaten / games << "%, survived " << t.frames / games / 60.0 << " s, "
+            << setprecision(2) << t.livesLost / max(t.frames / 3600.0, 1e-9) << " lives lost per minute, "
+            << (t.decisions ? t.decisionMs / t.decisions : 0.0) << " ms per decision\n" << setprecision(1);
+    }
+
+    const Totals& easy = results[0];
+    const Totals& hard = results[1];
+    cout << "hard vs easy: " << setprecision(2) << (easy.score > 0 ? hard.score / easy.score : 0.0) << "x score, "
+        << hard.eaten / games - easy.eaten / games << " points of pellets cleared";
+    if (easy.livesLost > 0 && hard.frames > 0)
+        cout << ", " << (hard.livesLost / hard.frames) / (easy.livesLost / easy.frames) << "x lives lost per minute";
+    cout << "\n";
+    cout.unsetf(ios::floatfield);
+    cout << setprecision(6);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+#include "Game.h"
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Autopilot --------------------
+// Monte Carlo tree search player. Every time Pacman reaches the centre of a
+// new tile (or stands still against a wall) it picks the direction to take:
+// each tree edge plays real UpdateGameplay() frames on a private copy of the
+// world until Pacman reaches the next tile centre, then a few random moves
+// finish the rollout. Results are scored by points gained, lives lost and a
+// level clear, with a small pull toward the nearest pellet.
+//
+// Search is root-parallel: each thread grows its own tree on its own
+// CloneGameWorld() copy and the root visit counts are summed at the end.
+// With an iteration budget (and a fixed thread count) the choice only
+// depends on the seed; a time budget trades that for a steady frame rate.
+const int AUTOPILOT_SEGMENT_FRAMES = 60;        // one edge: until the next tile, or this many frames
+const int AUTOPILOT_ROLLOUT_DECISIONS = 3;      // random moves after the tree's leaf
+const float AUTOPILOT_EXPLORATION = 0.7f;       // UCT exploration constant
+const float AUTOPILOT_SCORE_SCALE = 500.0f;     // points worth as much as one life
+const float AUTOPILOT_CLEAR_BONUS = 4.0f;       // in lives
+const float AUTOPILOT_PELLET_PULL = 0.002f;     // per tile to the nearest pellet after a rollout
+
+struct AutopilotConfig {
+    int iterations = 64;        // per decision, over all threads; 0 = time budget only
+    float timeMs = 0.0f;        // per decision; 0 = iteration budget only
+    int threads = 0;            // 0 = one per core
+    uint32_t seed = 1;
+};
+
+struct AutopilotStats {
+    int decisions = 0;
+    int iterations = 0;         // in the last decision, over all threads
+    double ms = 0.0;            // last decision
+    double totalMs = 0.0;
+    int visits[4] = {};         // root visits per Pacman::Direction, last decision
+};
+
+class Autopilot {
+public:
+    Autopilot();
+    ~Autopilot();
+    Autopilot(const Autopilot&) = delete;
+    Autopilot& operator=(const Autopilot&) = delete;
+
+    void configure(const AutopilotConfig& config);
+    const AutopilotConfig& settings() const { return config; }
+    const AutopilotStats& stats() const { return lastStats; }
+
+    // True once per tile, as Pacman passes its centre, and every frame it is stuck
+    bool wantsDecision(const GameWorld& world);
+
+    // Searches from the world's current state and returns a Pacman::Direction
+    int decide(GameWorld& world, const LevelInfo& level);
+
+    // Call before UpdateGameplay(): steers Pacman when a decision is due
+    void drive(GameWorld& world, const LevelInfo& level);
+
+    void forget();              // drop the search copies (e.g. after a level change)
+
+private:
+    struct Searcher;
+
+    AutopilotConfig config;
+    AutopilotStats lastStats;
+    vector<unique_ptr<Searcher>> searchers;
+    GameSnapshot root;          // the state being searched; keeps its buffers between decisions
+
+    // What the search copies were cloned from; any change rebuilds them
+    const unsigned char* clonedNav = nullptr;
+    int clonedCols = 0, clonedRows = 0;
+    bool clonedHard = false;
+
+    int lastTileX = -1, lastTileY = -1;
+    float lastX = 0.0f, lastY = 0.0f;
+};
+
+// -------------------- Evaluation --------------------
+// --autopilot-eval [games] [iterations] [threads]: lets the autopilot play
+// full games of the level on easy and on hard and prints how it did (score,
+// clears, pellets eaten, survival), a soak test of the whole game loop and a
+// measure of how much harder DIFF_HARD is. Returns the process exit code.
+int RunAutopilotEval(const LevelInfo& level, int games, int iterations, int threads);
+
+#endif // AUTOPILOT_H
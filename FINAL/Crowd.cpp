@@ -0,0 +1,326 @@
+#include "Crowd.h"
+#include "Game.h"
+#include "Audio.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+// -------------------- FlowField --------------------
+bool FlowField::update(const MapNav& nav, int tx, int ty) {
+    if (!nav.walkable(tx, ty)) return false;    // off the grid (a tunnel mouth): keep the last field
+    int tiles = nav.cols * nav.rows;
+    int target = ty * nav.cols + tx;
+    if (builtFor == nav.walkMask && target == targetTile && (int)dist.size() == tiles) return false;
+
+    dist.assign(tiles, NAV_UNREACHABLE);
+    dir.assign(tiles, NAV_NONE);
+    queue.clear();
+    dist[target] = 0;
+    queue.push_back(target);
+    for (size_t head = 0; head < queue.size(); head++) {
+        int t = queue[head];
+        unsigned char mask = nav.walkMask[t];
+        for (int d = 0; d < 4; d++) {
+            if (!(mask >> d & 1)) continue;
+            int n = t + NAV_DX[d] + NAV_DY[d] * nav.cols;
+            if (dist[n] != NAV_UNREACHABLE) continue;
+            dist[n] = dist[t] + 1;
+            dir[n] = (unsigned char)(d ^ 1);    // from n back toward t
+            queue.push_back(n);
+        }
+    }
+    builtFor = nav.walkMask;
+    targetTile = target;
+    rebuildCount++;
+    return true;
+}
+
+// -------------------- GhostCrowd --------------------
+static uint32_t NextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static int TileOf(const MapNav& nav, int tileSize, float px, float py) {
+    int tx = (int)floorf(px / tileSize), ty = (int)floorf(py / tileSize);
+    if (tx < 0 || ty < 0 || tx >= nav.cols || ty >= nav.rows) return -1;
+    return ty * nav.cols + tx;
+}
+
+int GhostCrowd::randomTile(Map& maze, int minSteps) {
+    const MapNav& nav = maze.nav;
+    if (nav.walkableCount == 0) return -1;
+    // A few random picks, then whatever reachable tile comes next in index order
+    for (int attempt = 0; attempt < 64; attempt++) {
+        int t = nav.indexTile[NextRandom(rng) % nav.walkableCount];
+        int steps = field.steps(t);
+        if (steps != NAV_UNREACHABLE && steps >= minSteps) return t;
+    }
+    int start = NextRandom(rng) % nav.walkableCount;
+    for (int k = 0; k < nav.walkableCount; k++) {
+        int t = nav.indexTile[(start + k) % nav.walkableCount];
+        if (field.steps(t) != NAV_UNREACHABLE) return t;
+    }
+    return -1;
+}
+
+bool GhostCrowd::spawn(Map& maze, const Pacman& pac, int count, uint32_t seed) {
+    clear();
+    count = min(count, CROWD_MAX_GHOSTS);
+    int tileSize = maze.tileSize;
+    int px = (int)((pac.x + tileSize / 2) / tileSize), py = (int)((pac.y + tileSize / 2) / tileSize);
+    field = FlowField();
+    if (!field.update(maze.nav, px, py)) {
+        cout << "Crowd: Pacman's tile " << px << "," << py << " is not walkable\n";
+        return false;
+    }
+    rng = seed ? seed : 1;
+    for (int i = 0; i < count; i++) {
+        int t = randomTile(maze, CROWD_SPAWN_MIN_STEPS);
+        if (t < 0) {
+            cout << "Crowd: nowhere to put the ghosts\n";
+            clear();
+            return false;
+        }
+        // Spread within the tile so a shared tile doesn't start fully stacked
+        float jx = ((int)(NextRandom(rng) % 21) - 10) / 40.0f, jy = ((int)(NextRandom(rng) % 21) - 10) / 40.0f;
+        x.push_back((t % maze.cols + 0.5f + jx) * tileSize);
+        y.push_back((t / maze.cols + 0.5f + jy) * tileSize);
+    }
+    nextX.resize(x.size());
+    nextY.resize(y.size());
+    return true;
+}
+
+void GhostCrowd::clear() {
+    x.clear();
+    y.clear();
+    nextX.clear();
+    nextY.clear();
+    touched.clear();
+    lastStats = CrowdStats();
+}
+
+void GhostCrowd::respawn(Map& maze, int i) {
+    int t = randomTile(maze, CROWD_SPAWN_MIN_STEPS);
+    if (t < 0) return;
+    x[i] = (t % maze.cols + 0.5f) * maze.tileSize;
+    y[i] = (t / maze.cols + 0.5f) * maze.tileSize;
+}
+
+void GhostCrowd::clearAround(Map& maze, int tx, int ty) {
+    if (!field.update(maze.nav, tx, ty) && field.target() != ty * maze.cols + tx) return;
+    for (int i = 0; i < size(); i++) {
+        int t = TileOf(maze.nav, maze.tileSize, x[i], y[i]);
+        if (t < 0 || field.steps(t) < CROWD_SPAWN_MIN_STEPS) respawn(maze, i);
+    }
+}
+
+// Counting sort of the ghosts by tile; ghosts off the grid go in no bucket
+void GhostCrowd::buildBuckets(const MapNav& nav, int tileSize) {
+    int tiles = nav.cols * nav.rows;
+    bucketStart.assign(tiles + 1, 0);
+    bucketGhosts.resize(x.size());
+    for (size_t i = 0; i < x.size(); i++) {
+        int t = TileOf(nav, tileSize, x[i], y[i]);
+        if (t >= 0) bucketStart[t + 1]++;
+    }
+    lastStats.maxPerTile = 0;
+    for (int t = 0; t < tiles; t++) {
+        lastStats.maxPerTile = max(lastStats.maxPerTile, bucketStart[t + 1]);
+        bucketStart[t + 1] += bucketStart[t];
+    }
+    bucketFill.assign(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < x.size(); i++) {
+        int t = TileOf(nav, tileSize, x[i], y[i]);
+        if (t >= 0) bucketGhosts[bucketFill[t]++] = (int)i;
+    }
+}
+
+int GhostCrowd::update(Map& maze, const Pacman& pac, float speed, JobSystem* jobs) {
+    auto started = chrono::steady_clock::now();
+    updateCount++;
+    const MapNav& nav = maze.nav;
+    int tileSize = maze.tileSize;
+    float pacX = pac.x + tileSize / 2.0f, pacY = pac.y + tileSize / 2.0f;
+    field.update(nav, (int)(pacX / tileSize), (int)(pacY / tileSize));
+    buildBuckets(nav, tileSize);
+
+    bool flee = pac.energizer_timer > 0;
+    float step = flee ? speed * CROWD_FLEE_SPEED : speed;
+    float spacing = CROWD_SPACING * tileSize;
+    int cols = nav.cols, rows = nav.rows;
+
+    auto move = [&](int i) {
+        float gx = x[i], gy = y[i];
+        int t = TileOf(nav, tileSize, gx, gy);
+        if (t < 0 || field.steps(t) == NAV_UNREACHABLE) {
+            nextX[i] = gx;
+            nextY[i] = gy;
+            return;
+        }
+
+        // Toward the centre of the next tile on the field (or Pacman himself on his tile)
+        float goalX = pacX, goalY = pacY;
+        int d = field.direction(t);
+        if (flee) {
+            int bestSteps = field.steps(t);
+            d = NAV_NONE;
+            for (int k = 0; k < 4; k++) {
+                if (!(nav.walkMask[t] >> k & 1)) continue;
+                int s = field.steps(t + NAV_DX[k] + NAV_DY[k] * cols);
+                if (s != NAV_UNREACHABLE && s > bestSteps) { bestSteps = s; d = k; }
+            }
+        }
+        if (d != NAV_NONE) {
+            goalX = (t % cols + NAV_DX[d] + 0.5f) * tileSize;
+            goalY = (t / cols + NAV_DY[d] + 0.5f) * tileSize;
+        }
+        else if (flee) {
+            goalX = gx;
+            goalY = gy;
+        }
+        float vx = goalX - gx, vy = goalY - gy;
+        float len = sqrtf(vx * vx + vy * vy);
+        if (len > step) { vx = vx / len * step; vy = vy / len * step; }
+
+        // Separation from the ghosts in the 3x3 tiles around
+        float pushX = 0.0f, pushY = 0.0f;
+        int tx = t % cols, ty = t / cols;
+        for (int ny = max(0, ty - 1); ny <= min(rows - 1, ty + 1); ny++) {
+            for (int nx = max(0, tx - 1); nx <= min(cols - 1, tx + 1); nx++) {
+                int b = ny * cols + nx;
+                for (int k = bucketStart[b]; k < bucketStart[b + 1]; k++) {
+                    int j = bucketGhosts[k];
+                    if (j == i) continue;
+                    float dx = gx - x[j], dy = gy - y[j];
+                    float dist2 = dx * dx + dy * dy;
+                    if (dist2 >= spacing * spacing) continue;
+                    float dist = sqrtf(dist2);
+                    float overlap = (spacing - dist) * CROWD_PUSH;
+                    if (dist < 0.001f) {
+                        // Exactly stacked: split them by index
+                        dx = i < j ? -1.0f : 1.0f;
+                        dy = 0.0f;
+                        dist = 1.0f;
+                    }
+                    pushX += dx / dist * overlap;
+                    pushY += dy / dist * overlap;
+                }
+            }
+        }
+        float pushLen = sqrtf(pushX * pushX + pushY * pushY);
+        if (pushLen > step) { pushX = pushX / pushLen * step; pushY = pushY / pushLen * step; }
+
+        // Each axis only moves onto a walkable tile, so walls stop ghosts and they slide along them
+        float nx = gx + vx + pushX, ny = gy + vy + pushY;
+        int after = TileOf(nav, tileSize, nx, gy);
+        if (after < 0 || field.steps(after) == NAV_UNREACHABLE) nx = gx;
+        after = TileOf(nav, tileSize, nx, ny);
+        if (after < 0 || field.steps(after) == NAV_UNREACHABLE) ny = gy;
+        nextX[i] = nx;
+        nextY[i] = ny;
+    };
+    int count = size();
+    if (jobs) jobs->parallelFor(count, move, CROWD_JOB_GRAIN);
+    else for (int i = 0; i < count; i++) move(i);
+    x.swap(nextX);
+    y.swap(nextY);
+
+    // Who touches Pacman, by the same distance checkPacmanGhostCollision uses
+    touched.clear();
+    float reach = pac.radius + tileSize * 0.40f;
+    for (int i = 0; i < count; i++) {
+        float dx = x[i] - pacX, dy = y[i] - pacY;
+        if (dx * dx + dy * dy < reach * reach) touched.push_back(i);
+    }
+    lastStats.touching = (int)touched.size();
+    lastStats.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    return lastStats.touching;
+}
+
+void GhostCrowd::draw(Map& maze, Texture2D texture, bool frightened, int frame) {
+    static const Color colours[4] = { RED, Color{ 255,182,255,255 }, Color{ 0,255,255,255 }, Color{ 255,182,85,255 } };
+    int tileSize = maze.tileSize;
+    int bodyFrame = (frame / GHOST_ANIMATION_SPEED) % GHOST_ANIMATION_FRAMES;
+    Rectangle srcBody = { bodyFrame * 16.0f, 0.0f, 16.0f, 16.0f };
+    Rectangle srcFace = { frightened ? 4.0f * CELL_SIZE : 0.0f, (float)CELL_SIZE, (float)CELL_SIZE, (float)CELL_SIZE };
+    for (int i = 0; i < size(); i++) {
+        if (!maze.isVisible(x[i], y[i])) continue;
+        Rectangle dst = { x[i] - tileSize / 2.0f, y[i] - tileSize / 2.0f, (float)tileSize, (float)tileSize };
+        DrawTexturePro(texture, srcBody, dst, { 0.0f, 0.0f }, 0.0f, frightened ? Color{ 36,36,255,255 } : colours[i % 4]);
+        DrawTexturePro(texture, srcFace, dst, { 0.0f, 0.0f }, 0.0f, WHITE);
+    }
+}
+
+// -------------------- Benchmark --------------------
+static const int CROWD_BENCH_TURN_FRAMES = 30;      // Pacman picks a new random direction this often
+
+int RunCrowdBenchmark(const LevelInfo& level, int ghosts, int frames, int threads) {
+    unique_ptr<Map> map = BuildLevelMap(level, TILE_SIZE);
+    if (!map) {
+        cout << "Level '" << level.name << "' failed to load\n";
+        return 1;
+    }
+    GameWorld world(move(*map), Texture2D(), TILE_SIZE);
+    ResetGameWorld(world, level);
+    unique_ptr<JobSystem> jobs(threads == 1 ? nullptr : new JobSystem(threads));
+    world.ghostJobs = jobs.get();
+    if (!world.crowd.spawn(world.maze, world.pac, ghosts, 1)) return 1;
+    ScopedSfxMute mute;
+
+    mt19937 rng(1);
+    double totalMs = 0.0, worstMs = 0.0, frameMs = 0.0;
+    long long crowdFrames = 0, crowdedSum = 0;
+    int catches = 0, games = 1;
+    for (int f = 0; f < frames; f++) {
+        if (f % CROWD_BENCH_TURN_FRAMES == 0) world.pac.desiredDirection = (Pacman::Direction)(rng() % 4);
+        int lives = world.pac.lives;
+        int updates = world.crowd.updates();
+
+        auto start = chrono::steady_clock::now();
+        UpdateGameplay(world, level);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        if (world.pac.lives < lives) catches++;
+        // Both averages cover the same frames: those where the crowd moved
+        if (world.crowd.updates() != updates) {
+            const CrowdStats& s = world.crowd.stats();
+            frameMs += ms;
+            totalMs += s.ms;
+            worstMs = max(worstMs, s.ms);
+            crowdedSum += s.maxPerTile;
+            crowdFrames++;
+        }
+        if (world.pac.lives <= 0 || world.maze.pelletsLeft <= 0) {
+            ResetGameWorld(world, level);
+            games++;
+        }
+    }
+
+    // Positions hash the same for any thread count
+    uint64_t hash = 1469598103934665603ull;
+    for (int i = 0; i < world.crowd.size(); i++) {
+        hash = (hash ^ (uint64_t)(int64_t)(world.crowd.x[i] * 1024.0f)) * 1099511628211ull;
+        hash = (hash ^ (uint64_t)(int64_t)(world.crowd.y[i] * 1024.0f)) * 1099511628211ull;
+    }
+
+    int threadCount = jobs ? jobs->threadCount() : 1;
+    cout << "Crowd: " << world.crowd.size() << " ghosts on '" << level.name << "' (" << world.maze.nav.walkableCount
+        << " walkable tiles), " << frames << " frames, " << threadCount << " thread" << (threadCount == 1 ? "" : "s") << "\n";
+    cout << fixed << setprecision(3) << "crowd update: avg " << (crowdFrames ? totalMs / crowdFrames : 0.0) << " ms, worst "
+        << worstMs << " ms; whole frame avg " << (crowdFrames ? frameMs / crowdFrames : 0.0) << " ms (over the "
+        << crowdFrames << " frames the crowd moved)\n";
+    cout << "flow field rebuilt " << world.crowd.flowField().rebuilds() << " times; most ghosts on one tile: avg "
+        << setprecision(1) << (crowdFrames ? (double)crowdedSum / crowdFrames : 0.0) << "\n";
+    cout.unsetf(ios::floatfield);
+    cout << "Pacman caught " << catches << " times over " << games << " games\n";
+    cout << "Crowd hash 0x" << hex << hash << dec << " (the same for any thread count)\n";
+    return 0;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#ifndef CROWD_H
+#define CROWD_H
+
+#include "raylib.h"
+#include "MapNav.h"
+#include "Map.h"
+#include "Pacman.h"
+#include "Level.h"
+#include "JobSystem.h"
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Flow Field --------------------
+// Steps from every tile to one target tile, and the first step to take, from
+// a single BFS over the nav walk mask. Every ghost chasing the same target
+// reads it instead of running its own search (compare navigateToTile).
+class FlowField {
+public:
+    // Rebuilds only when the target tile or the map changed; true if it did
+    bool update(const MapNav& nav, int tx, int ty);
+
+    int direction(int tile) const { return dir[tile]; }     // NAV_NONE at the target or when unreachable
+    int steps(int tile) const { return dist[tile]; }        // NAV_UNREACHABLE when unreachable
+    int target() const { return targetTile; }
+    int rebuilds() const { return rebuildCount; }
+
+private:
+    const unsigned char* builtFor = nullptr;
+    int targetTile = -1;
+    int rebuildCount = 0;
+    vector<unsigned short> dist;
+    vector<unsigned char> dir;
+    vector<int> queue;
+};
+
+// -------------------- Ghost Crowd --------------------
+// Party mode: thousands of plain ghosts that all chase Pacman down one shared
+// flow field, rebuilt only when Pacman enters a new tile. Each ghost heads
+// for the centre of the next tile on the field (away from Pacman along it
+// while he is energized) and is pushed off the ghosts around it, found
+// through per-tile buckets, so crowds queue along corridors instead of
+// stacking on one spot.
+//
+// Ghosts read the previous frame's positions and write new ones, so the
+// step can run on a job system and still give the same result for any
+// thread count.
+const int CROWD_DEFAULT_GHOSTS = 2000;
+const int CROWD_MAX_GHOSTS = 1 << 16;
+const float CROWD_SPACING = 0.6f;           // in tiles: closer ghosts push each other apart
+const float CROWD_PUSH = 0.5f;              // share of the overlap corrected per frame
+const float CROWD_FLEE_SPEED = 0.7f;        // while Pacman is energized, as in fleeFromPacman
+const int CROWD_SPAWN_MIN_STEPS = 8;        // new and eaten ghosts appear at least this far from Pacman
+const int CROWD_JOB_GRAIN = 256;            // ghosts per job
+
+struct CrowdStats {
+    double ms = 0.0;            // last update
+    int touching = 0;           // ghosts touching Pacman after the last update
+    int maxPerTile = 0;         // most ghosts sharing one tile in the last update
+};
+
+class GhostCrowd {
+public:
+    // Ghost centres in pixels
+    vector<float> x, y;
+
+    // Places count ghosts on random tiles Pacman can reach, away from him
+    bool spawn(Map& maze, const Pacman& pac, int count, uint32_t seed);
+    void clear();
+    bool empty() const { return x.empty(); }
+    int size() const { return (int)x.size(); }
+
+    // One frame: the field, then every ghost's step (on jobs when given).
+    // Returns how many ghosts touch Pacman afterwards; touching() lists them.
+    int update(Map& maze, const Pacman& pac, float speed, JobSystem* jobs);
+    const vector<int>& touching() const { return touched; }
+
+    // Moves ghost i to a random tile far from Pacman (after it was eaten)
+    void respawn(Map& maze, int i);
+    // Respawns every ghost within CROWD_SPAWN_MIN_STEPS of tile (x, y), e.g.
+    // Pacman's start after he was caught
+    void clearAround(Map& maze, int tx, int ty);
+
+    // Visible ghosts only; call inside BeginMode2D
+    void draw(Map& maze, Texture2D texture, bool frightened, int frame);
+
+    const FlowField& flowField() const { return field; }
+    const CrowdStats& stats() const { return lastStats; }
+    int updates() const { return updateCount; }     // update() calls so far; stats() is from the last one
+
+private:
+    FlowField field;
+    vector<float> nextX, nextY;
+    vector<int> bucketStart, bucketGhosts;  // ghosts by tile: counting sort of the current positions
+    vector<int> bucketFill;
+    vector<int> touched;                    // ascending
+    uint32_t rng = 1;
+    int updateCount = 0;
+    CrowdStats lastStats;
+
+    int randomTile(Map& maze, int minSteps);
+    void buildBuckets(const MapNav& nav, int tileSize);
+};
+
+// --bench-crowd [ghosts] [frames] [threads]: plays the first level without
+// a window with a ghost crowd chasing Pacman and prints the cost per frame
+// and how the crowd spread. Returns the process exit code.
+int RunCrowdBenchmark(const LevelInfo& level, int ghosts, int frames, int threads);
+
+#endif // CROWD_H
@@ -0,0 +1,272 @@
+#pragma once
+#ifndef DEFAULT_MAZE_H
+#define DEFAULT_MAZE_H
+
+#include "MapNav.h"
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <cstring>
+
+using namespace std;
+
+// -------------------- Built-in Maze --------------------
+// The classic maze and all of its lookup tables are computed by the compiler,
+// so starting the default level parses nothing and runs no BFS: the tables
+// live in read-only memory and Map just points its MapNav at them.
+//
+// Each all-pairs row is its own constant evaluation, which keeps every one
+// far below the compilers' step limits (MSVC /constexpr:steps, clang
+// -fconstexpr-steps). Define PACMAZE_NO_CONSTEXPR_NAV to skip the all-pairs
+// tables entirely; the map then builds them at runtime as for any other maze.
+namespace DefaultMaze {
+
+    constexpr int ROWS = 21;
+    constexpr int COLS = 21;
+
+    constexpr char LAYOUT[ROWS][COLS + 1] = {
+        " ################### ",
+        " #.O......#..... ..# ",
+        " #.##.###.#.###.##.# ",
+        " #.................# ",
+        " #.##.#.#####.#.##.# ",
+        " #. ..#...#...#....# ",
+        " ####.### # ###.#### ",
+        "    #.#       #.#    ",
+        "#####.# GGGGG #.#####",
+        "     .  #GGG#  .     ",
+        "#####.# GGGGG #.#####",
+        "    #.#....O..#.#    ",
+        " ####.#.#####.#.#### ",
+        " #.. .....#.... ...# ",
+        " #.##.###.#.###.##.# ",
+        " #..#.O... .....#..# ",
+        " ##.#.#.#####.P.#.## ",
+        " #....#...#...#....# ",
+        " #.######.#.######.# ",
+        " #.. ............O.# ",
+        " ################### "
+    };
+
+    constexpr bool Walk(int x, int y) {
+        return x >= 0 && y >= 0 && x < COLS && y < ROWS && IsNavWalkable(LAYOUT[y][x]);
+    }
+
+    constexpr int CountWalkable() {
+        int n = 0;
+        for (int y = 0; y < ROWS; y++)
+            for (int x = 0; x < COLS; x++)
+                if (Walk(x, y)) n++;
+        return n;
+    }
+
+    constexpr int WALKABLE = CountWalkable();
+
+    // Per-tile tables and what Map would otherwise scan the layout for
+    struct Tables {
+        unsigned char walkMask[ROWS * COLS] = {};
+        int tileIndex[ROWS * COLS] = {};
+        int indexTile[WALKABLE] = {};
+        unsigned char gateHop[ROWS * COLS] = {};
+        unsigned short gateDist[ROWS * COLS] = {};
+
+        int pelletCount = 0;                // '.' tiles
+
+        int pacStartX = -1, pacStartY = -1;
+        int houseMinX = COLS, houseMinY = ROWS, houseMaxX = -1, houseMaxY = -1;
+        int gateX = 0, gateY = 0;           // top centre of the ghost house, as Map::findMetadata
+        int navGateX = 0, navGateY = 0;     // tile the gate tables lead to (one above the gate)
+    };
+
+    constexpr Tables BuildTables() {
+        Tables t{};
+        int nextIndex = 0;
+
+        for (int y = 0; y < ROWS; y++) {
+            for (int x = 0; x < COLS; x++) {
+                char c = LAYOUT[y][x];
+                int id = y * COLS + x;
+                if (c == '.') t.pelletCount++;
+                if (c == 'P' && t.pacStartX == -1) { t.pacStartX = x; t.pacStartY = y; }
+                if (c == 'G') {
+                    t.houseMinX = t.houseMinX < x ? t.houseMinX : x;
+                    t.houseMaxX = t.houseMaxX > x ? t.houseMaxX : x;
+                    t.houseMinY = t.houseMinY < y ? t.houseMinY : y;
+                    t.houseMaxY = t.houseMaxY > y ? t.houseMaxY : y;
+                }
+
+                t.tileIndex[id] = -1;
+                t.gateHop[id] = NAV_NONE;
+                t.gateDist[id] = NAV_UNREACHABLE;
+                if (!Walk(x, y)) continue;
+
+                // Dense indices in row-major order, as BuildMapNav
+                t.tileIndex[id] = nextIndex;
+                t.indexTile[nextIndex++] = id;
+                for (int d = 0; d < 4; d++)
+                    if (Walk(x + NAV_DX[d], y + NAV_DY[d])) t.walkMask[id] |= (unsigned char)(1 << d);
+            }
+        }
+
+        t.gateX = (t.houseMinX + t.houseMaxX) / 2;
+        t.gateY = t.houseMinY;
+        t.navGateX = t.gateX;
+        t.navGateY = t.gateY - 1;
+
+        // Gate tables: BFS outward from the gate tile
+        int queue[ROWS * COLS] = {};
+        int head = 0, tail = 0;
+        int start = t.navGateY * COLS + t.navGateX;
+        queue[tail++] = start;
+        t.gateDist[start] = 0;
+        while (head < tail) {
+            int cur = queue[head++];
+            int cx = cur % COLS, cy = cur / COLS;
+            for (int d : NAV_BFS_DIRS) {
+                int nx = cx + NAV_DX[d], ny = cy + NAV_DY[d];
+                if (!Walk(nx, ny) || t.gateDist[ny * COLS + nx] != NAV_UNREACHABLE) continue;
+                t.gateDist[ny * COLS + nx] = (unsigned short)(t.gateDist[cur] + 1);
+                t.gateHop[ny * COLS + nx] = (unsigned char)(d ^ 1);
+                queue[tail++] = ny * COLS + nx;
+            }
+        }
+        return t;
+    }
+
+    inline constexpr Tables TABLES = BuildTables();
+
+    static_assert(TABLES.pacStartX >= 0, "built-in maze has no P");
+    static_assert(TABLES.houseMaxX >= 0, "built-in maze has no ghost house");
+    static_assert(Walk(TABLES.navGateX, TABLES.navGateY), "tile above the gate must be walkable");
+    static_assert(WALKABLE <= NAV_MAX_ALL_PAIRS, "built-in maze too big for all-pairs tables");
+
+#ifndef PACMAZE_NO_CONSTEXPR_NAV
+    // -------------------- All-pairs Tables --------------------
+    // One BFS from a single source, same order and tie-breaks as BuildMapNav
+    struct HopRow {
+        array<unsigned char, WALKABLE> hop{};
+        array<unsigned short, WALKABLE> dist{};
+    };
+
+    constexpr HopRow BuildHopRow(int src) {
+        HopRow row{};
+        for (int i = 0; i < WALKABLE; i++) { row.hop[i] = NAV_NONE; row.dist[i] = NAV_UNREACHABLE; }
+
+        int bfs[WALKABLE] = {};
+        int head = 0, tail = 0;
+        bfs[tail++] = src;
+        row.dist[src] = 0;
+        while (head < tail) {
+            int cur = bfs[head++];
+            int tile = TABLES.indexTile[cur];
+            int cx = tile % COLS, cy = tile / COLS;
+            for (int d : NAV_BFS_DIRS) {
+                int nx = cx + NAV_DX[d], ny = cy + NAV_DY[d];
+                if (!Walk(nx, ny)) continue;
+                int nb = TABLES.tileIndex[ny * COLS + nx];
+                if (row.dist[nb] != NAV_UNREACHABLE) continue;
+                row.dist[nb] = (unsigned short)(row.dist[cur] + 1);
+                row.hop[nb] = (cur == src) ? (unsigned char)d : row.hop[cur];
+                bfs[tail++] = nb;
+            }
+        }
+        return row;
+    }
+
+    // A variable template per source, so each row is a separate evaluation
+    template <int Src>
+    constexpr HopRow HOP_ROW = BuildHopRow(Src);
+
+    struct AllPairs {
+        array<array<unsigned char, WALKABLE>, WALKABLE> nextHop;
+        array<array<unsigned short, WALKABLE>, WALKABLE> dist;
+    };
+
+    template <int... Src>
+    constexpr AllPairs GatherRows(integer_sequence<int, Src...>) {
+        return AllPairs{ { { HOP_ROW<Src>.hop... } }, { { HOP_ROW<Src>.dist... } } };
+    }
+
+    inline constexpr AllPairs ALL_PAIRS = GatherRows(make_integer_sequence<int, WALKABLE>());
+    static_assert(sizeof(ALL_PAIRS.nextHop) == (size_t)WALKABLE * WALKABLE, "rows must be contiguous");
+#endif
+
+    // View for Map: points straight at the compile-time tables
+    inline MapNav Nav() {
+        MapNav nav;
+        nav.cols = COLS;
+        nav.rows = ROWS;
+        nav.walkableCount = WALKABLE;
+        nav.gateX = TABLES.navGateX;
+        nav.gateY = TABLES.navGateY;
+        nav.walkMask = TABLES.walkMask;
+        nav.tileIndex = TABLES.tileIndex;
+        nav.indexTile = TABLES.indexTile;
+        nav.gateHop = TABLES.gateHop;
+        nav.gateDist = TABLES.gateDist;
+#ifndef PACMAZE_NO_CONSTEXPR_NAV
+        nav.nextHop = ALL_PAIRS.nextHop[0].data();
+        nav.dist = ALL_PAIRS.dist[0].data();
+#endif
+        return nav;
+    }
+
+    // Everything Map needs for the built-in maze, so its constructor scans nothing
+    inline MapPrebuilt Prebuilt() {
+        MapPrebuilt p;
+        p.nav = Nav();
+        p.pacStartX = TABLES.pacStartX;
+        p.pacStartY = TABLES.pacStartY;
+        p.gateX = TABLES.gateX;
+        p.gateY = TABLES.gateY;
+        p.houseMinX = TABLES.houseMinX;
+        p.houseMinY = TABLES.houseMinY;
+        p.houseMaxX = TABLES.houseMaxX;
+        p.houseMaxY = TABLES.houseMaxY;
+        p.pelletCount = TABLES.pelletCount;
+        return p;
+    }
+
+    inline bool HasStaticAllPairs() {
+#ifndef PACMAZE_NO_CONSTEXPR_NAV
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    inline vector<string> Layout() {
+        return vector<string>(begin(LAYOUT), end(LAYOUT));
+    }
+
+    inline bool Matches(const vector<string>& layout) {
+        if ((int)layout.size() != ROWS) return false;
+        for (int y = 0; y < ROWS; y++)
+            if (layout[y] != LAYOUT[y]) return false;
+        return true;
+    }
+
+    // The compile-time tables against BuildMapNav on the same layout, table by
+    // table. The compiler can't run BuildMapNav, so BuildLevelMap asserts this
+    // in debug builds the first time it uses the tables.
+    inline bool SameAsRuntimeNav() {
+        MapNavStorage storage;
+        BuildMapNav(Layout(), TABLES.navGateX, TABLES.navGateY, storage);
+        MapNav a = Nav();
+        MapNav b = storage.view(COLS, ROWS, TABLES.navGateX, TABLES.navGateY);
+        size_t tiles = (size_t)ROWS * COLS, n = WALKABLE;
+        auto same = [](const void* x, const void* y, size_t bytes) {
+            return (x == nullptr) == (y == nullptr) && (x == nullptr || memcmp(x, y, bytes) == 0);
+        };
+        return a.walkableCount == b.walkableCount && a.gateX == b.gateX && a.gateY == b.gateY
+            && same(a.walkMask, b.walkMask, tiles) && same(a.tileIndex, b.tileIndex, tiles * sizeof(int))
+            && same(a.indexTile, b.indexTile, n * sizeof(int))
+            && same(a.gateHop, b.gateHop, tiles) && same(a.gateDist, b.gateDist, tiles * sizeof(unsigned short))
+            && (!a.hasAllPairs() || (same(a.nextHop, b.nextHop, n * n)
+                && same(a.dist, b.dist, n * n * sizeof(unsigned short))));
+    }
+}
+
+#endif // DEFAULT_MAZE_H
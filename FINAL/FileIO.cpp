@@ -0,0 +1,239 @@
+#include "FileIO.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+// -------------------- Main-Thread I/O Time --------------------
+// Static initialisation runs on the main thread
+static const thread::id ioMainThread = this_thread::get_id();
+static int ioTimerDepth = 0;                                            // main thread only
+static long long ioFrameNs = 0, ioLastFrameNs = 0, ioWorstFrameNs = 0;   // main thread only
+
+static long long NowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+ScopedIoTimer::ScopedIoTimer() {
+    if (this_thread::get_id() != ioMainThread) return;
+    counting = ioTimerDepth++ == 0;
+    if (counting) startNs = NowNs();
+}
+
+ScopedIoTimer::~ScopedIoTimer() {
+    if (this_thread::get_id() != ioMainThread) return;
+    ioTimerDepth--;
+    if (counting) ioFrameNs += NowNs() - startNs;
+}
+
+void IoFrameBegin() {
+    ioLastFrameNs = ioFrameNs;
+    ioWorstFrameNs = max(ioWorstFrameNs, ioFrameNs);
+    ioFrameNs = 0;
+}
+
+double IoLastFrameMs() { return ioLastFrameNs / 1e6; }
+double IoWorstFrameMs() { return ioWorstFrameNs / 1e6; }
+
+// -------------------- MappedFile --------------------
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string& path) {
+    ScopedIoTimer io;
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(f, &sz) || sz.QuadPart == 0) { CloseHandle(f); return false; }
+
+    HANDLE m = CreateFileMappingA(f, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m) { CloseHandle(f); return false; }
+
+    void* view = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+    if (!view) { CloseHandle(m); CloseHandle(f); return false; }
+
+    fileHandle = f;
+    mapHandle = m;
+    data = (const unsigned char*)view;
+    length = (size_t)sz.QuadPart;
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps its own reference
+    if (view == MAP_FAILED) return false;
+
+    data = (const unsigned char*)view;
+    length = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    data = other.data;
+    length = other.length;
+    other.data = nullptr;
+    other.length = 0;
+#ifdef _WIN32
+    fileHandle = other.fileHandle;
+    mapHandle = other.mapHandle;
+    other.fileHandle = other.mapHandle = nullptr;
+#endif
+    return *this;
+}
+
+void MappedFile::close() {
+    if (!data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle((HANDLE)mapHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mapHandle = fileHandle = nullptr;
+#else
+    munmap((void*)data, length);
+#endif
+    data = nullptr;
+    length = 0;
+}
+
+// -------------------- CRC-32 (IEEE, reflected) --------------------
+struct CrcTable {
+    uint32_t entries[256];
+    CrcTable() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+// -------------------- Safe Replace --------------------
+bool ReplaceFileAtomic(const string& tmpPath, const string& path) {
+    ScopedIoTimer io;
+#ifdef _WIN32
+    return MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return ::rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+}
+
+bool WriteFileAtomic(const string& path, const void* data, size_t len) {
+    ScopedIoTimer io;
+    string tmpPath = path + ".tmp";
+#ifdef _WIN32
+    HANDLE f = CreateFileA(tmpPath.c_str(), GENERIC_WRITE, 0, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+
+    const unsigned char* p = (const unsigned char*)data;
+    bool ok = true;
+    while (ok && len > 0) {
+        DWORD chunk = (DWORD)min(len, (size_t)1 << 30), written = 0;
+        ok = WriteFile(f, p, chunk, &written, nullptr) && written == chunk;
+        p += written;
+        len -= written;
+    }
+    ok = ok && FlushFileBuffers(f);
+    CloseHandle(f);
+#else
+    int f = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (f < 0) return false;
+
+    const unsigned char* p = (const unsigned char*)data;
+    bool ok = true;
+    while (ok && len > 0) {
+        ssize_t written = ::write(f, p, len);
+        ok = written > 0;
+        if (ok) { p += written; len -= (size_t)written; }
+    }
+    ok = ok && fsync(f) == 0;
+    ::close(f);
+#endif
+    if (!ok) return false;
+    return ReplaceFileAtomic(tmpPath, path);
+}
+
+// -------------------- AppendFile --------------------
+AppendFile::~AppendFile() {
+    close();
+}
+
+bool AppendFile::open(const string& path) {
+    ScopedIoTimer io;
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    handle = f;
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) return false;
+#endif
+    return true;
+}
+
+void AppendFile::close() {
+#ifdef _WIN32
+    if (handle) CloseHandle((HANDLE)handle);
+    handle = nullptr;
+#else
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+#endif
+}
+
+bool AppendFile::isOpen() const {
+#ifdef _WIN32
+    return handle != nullptr;
+#else
+    return fd >= 0;
+#endif
+}
+
+bool AppendFile::append(const void* data, size_t len) {
+    if (!isOpen()) return false;
+    ScopedIoTimer io;
+#ifdef _WIN32
+    DWORD written = 0;
+    if (!WriteFile((HANDLE)handle, data, (DWORD)len, &written, nullptr) || written != len) return false;
+    return FlushFileBuffers((HANDLE)handle) != 0;
+#else
+    ssize_t written = ::write(fd, data, len);
+    if (written != (ssize_t)len) return false;
+    return fsync(fd) == 0;
+#endif
+}
+
+uint32_t Crc32(const void* data, size_t len, uint32_t crc) {
+    static const CrcTable crcTable; // thread-safe one-time init
+    const uint32_t* table = crcTable.entries;
+
+    const unsigned char* p = (const unsigned char*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
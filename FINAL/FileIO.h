@@ -0,0 +1,94 @@
+#pragma once
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Kept free of raylib.h: windows.h (needed for file mapping) clashes with it.
+
+// -------------------- Memory-Mapped File --------------------
+// Read-only view of a whole file. Pages are only read from disk when touched.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { *this = move(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const string& path);
+    void close();
+
+    bool isOpen() const { return data != nullptr; }
+    const unsigned char* bytes() const { return data; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mapHandle = nullptr;
+#endif
+};
+
+// -------------------- Safe Replace --------------------
+// Renames tmpPath over path in one step, so readers see the old or the new
+// file and never a half-written one.
+bool ReplaceFileAtomic(const string& tmpPath, const string& path);
+
+// Writes path.tmp, syncs it to disk, then renames it over path
+bool WriteFileAtomic(const string& path, const void* data, size_t len);
+
+// -------------------- Durable Append --------------------
+// Each append is one write, synced to disk before it returns.
+class AppendFile {
+public:
+    AppendFile() = default;
+    ~AppendFile();
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+
+    bool open(const string& path);
+    void close();
+    bool isOpen() const;
+    bool append(const void* data, size_t len);
+
+private:
+#ifdef _WIN32
+    void* handle = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// -------------------- Main-Thread I/O Time --------------------
+// How long the main (render) thread is blocked on files each frame. The
+// functions above time themselves; other waits on I/O (e.g. for a writer
+// thread) are wrapped in a ScopedIoTimer. Other threads are not counted,
+// and nested timers count once.
+class ScopedIoTimer {
+public:
+    ScopedIoTimer();
+    ~ScopedIoTimer();
+    ScopedIoTimer(const ScopedIoTimer&) = delete;
+    ScopedIoTimer& operator=(const ScopedIoTimer&) = delete;
+
+private:
+    long long startNs = 0;
+    bool counting = false;
+};
+
+void IoFrameBegin();        // once per frame: the time so far becomes the last frame's
+double IoLastFrameMs();     // main-thread I/O in the previous frame
+double IoWorstFrameMs();    // worst frame since startup
+
+// -------------------- Checksums --------------------
+uint32_t Crc32(const void* data, size_t len, uint32_t crc = 0);
+
+#endif // FILE_IO_H
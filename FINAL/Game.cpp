@@ -0,0 +1,625 @@
+#include "Game.h"
+#include "Profiler.h"
+#include "AllocTrack.h"
+#include "Audio.h"
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+// -------------------- GameWorld --------------------
+GameWorld::GameWorld(Map&& map, Texture2D ghostTexture, int tileSize)
+    : maze(move(map)),
+    pac(maze.pacStartX * tileSize, maze.pacStartY * tileSize, tileSize),
+    red(10, 8, 0, ghostTexture, tileSize),
+    pink(9, 9, 1, ghostTexture, tileSize),
+    orange(10, 9, 3, ghostTexture, tileSize),
+    blue(11, 9, 2, ghostTexture, tileSize)
+{
+    redRelease.state = R_ACTIVE;
+    startPowerUps = maze.mysteryPowerUps;
+
+    // hashedValues start at 0 and hashedPowerUps empty; hash that, then catch up
+    for (int i = 0; i < SF_VALUES; i++) valueHash ^= StateKey(SF_FIRST_VALUE + i, 0);
+    UpdateStateHash(*this);
+}
+
+void ResetGameWorld(GameWorld& world, const LevelInfo& level) {
+    int tileSize = world.maze.tileSize;
+    world.maze.reset();
+    world.maze.mysteryPowerUps = world.startPowerUps;
+
+    Pacman& pac = world.pac;
+    pac.lives = pac.isHard ? 1 : 3;
+    pac.score = 0;
+    pac.speedTimer = pac.scoreCooldown = pac.speedCooldown = 0;
+    pac.animation_timer = 0;
+
+    Ghost* ghosts[4] = { &world.red, &world.pink, &world.orange, &world.blue };
+    for (Ghost* g : ghosts) {
+        g->direction = 0;
+        g->animation_timer = 0;
+        g->releaseState = R_IN_CAGE;
+        g->eyesPath.clear();
+        g->eyesPathIndex = 0;
+        g->leftCageFrame = -1;
+    }
+    StartLevel(level, world.maze, pac, world.red, world.pink, world.orange, world.blue, tileSize);
+
+    world.redRelease = ReleaseInfo();
+    world.redRelease.state = R_ACTIVE;
+    world.pinkRelease = world.orangeRelease = world.blueRelease = ReleaseInfo();
+    world.globalFrames = 0;
+    world.waveTimer = 0;
+    world.scatterMode = true;
+    world.frightenedTimer = 0;
+    if (!world.crowd.empty()) world.crowd.clearAround(world.maze, world.maze.pacStartX, world.maze.pacStartY);
+    UpdateStateHash(world);
+}
+
+void SetGameDifficulty(GameWorld& world, bool hard) {
+    world.pac.lives = hard ? 1 : 3;
+    world.pac.setHardMode(hard);
+    world.maze.setHardMode(hard);
+    world.red.setHardMode(hard);
+    world.pink.setHardMode(hard);
+    world.blue.setHardMode(hard);
+    world.orange.setHardMode(hard);
+}
+
+// -------------------- State Hash --------------------
+static void ReadStateValues(const GameWorld& world, int64_t out[SF_VALUES]) {
+    const Pacman& pac = world.pac;
+    const int cols = world.maze.cols, tileSize = pac.tileSize;
+    auto tileOf = [&](float px, float py) {
+        return (int64_t)((py + tileSize / 2) / tileSize) * cols + (int64_t)((px + tileSize / 2) / tileSize);
+    };
+    auto at = [&](int feature) -> int64_t& { return out[feature - SF_FIRST_VALUE]; };
+
+    at(SF_PAC_TILE) = tileOf(pac.x, pac.y);
+    at(SF_PAC_DIRECTION) = pac.direction;
+    at(SF_PAC_DYING) = pac.dying ? 1 + pac.death_timer : 0;
+    at(SF_LIVES) = pac.lives;
+    at(SF_SCORE) = pac.score;
+    at(SF_ENERGIZER_TIMER) = pac.energizer_timer;
+
+    const Ghost* ghosts[4] = { &world.red, &world.pink, &world.orange, &world.blue };
+    const ReleaseInfo* releases[4] = { &world.redRelease, &world.pinkRelease, &world.orangeRelease, &world.blueRelease };
+    for (int i = 0; i < 4; i++) {
+        at(SF_GHOST_TILE + i) = tileOf(ghosts[i]->position.x, ghosts[i]->position.y);
+        at(SF_GHOST_DIRECTION + i) = ghosts[i]->direction;
+        at(SF_GHOST_MODE + i) = ghosts[i]->frightened_mode;
+        at(SF_GHOST_RELEASE + i) = ghosts[i]->releaseState;
+        at(SF_RELEASE + i) = releases[i]->state;
+        at(SF_RELEASE_TIMER + i) = releases[i]->timer;
+    }
+
+    at(SF_SCATTER) = world.scatterMode;
+    at(SF_WAVE_TIMER) = world.waveTimer;
+    at(SF_FRIGHTENED_TIMER) = world.frightenedTimer;
+    at(SF_FRAME) = world.globalFrames;
+}
+
+static uint64_t PowerUpHash(const vector<pair<int, int>>& powerUps, int cols) {
+    uint64_t hash = 0;
+    for (auto& p : powerUps) hash ^= StateKey(SF_POWER_UP, (int64_t)p.second * cols + p.first);
+    return hash;
+}
+
+void UpdateStateHash(GameWorld& world) {
+    int64_t now[SF_VALUES];
+    ReadStateValues(world, now);
+    for (int i = 0; i < SF_VALUES; i++) {
+        if (now[i] == world.hashedValues[i]) continue;
+        world.valueHash ^= StateKey(SF_FIRST_VALUE + i, world.hashedValues[i]) ^ StateKey(SF_FIRST_VALUE + i, now[i]);
+        world.hashedValues[i] = now[i];
+    }
+
+    // A handful at most, and they only change when one is eaten or on a reset
+    const vector<pair<int, int>>& powerUps = world.maze.mysteryPowerUps;
+    if (powerUps != world.hashedPowerUps) {
+        int cols = world.maze.cols;
+        world.valueHash ^= PowerUpHash(world.hashedPowerUps, cols) ^ PowerUpHash(powerUps, cols);
+        world.hashedPowerUps = powerUps;
+    }
+}
+
+uint64_t ComputeStateHash(GameWorld& world) {
+    int64_t values[SF_VALUES];
+    ReadStateValues(world, values);
+    uint64_t hash = world.maze.computeEatenHash() ^ PowerUpHash(world.maze.mysteryPowerUps, world.maze.cols);
+    for (int i = 0; i < SF_VALUES; i++) hash ^= StateKey(SF_FIRST_VALUE + i, values[i]);
+    return hash;
+}
+
+// -------------------- Snapshots --------------------
+static int ChunkBit(const MapChunk& c, int x, int y) {
+    return (y - c.y0) * CHUNK_TILES + (x - c.x0);
+}
+
+static uint64_t CoinMask(const MapChunk& c) {
+    uint64_t mask = 0;
+    for (CoinNode* n = c.coins.head; n; n = n->next) mask |= 1ull << ChunkBit(c, n->x, n->y);
+    return mask;
+}
+
+static uint64_t EnergizerMask(const Map& maze, const MapChunk& c) {
+    uint64_t mask = 0;
+    for (int y = c.y0; y < c.y1; y++)
+        for (int x = c.x0; x < c.x1; x++)
+            if (maze.layout[y][x] == 'O') mask |= 1ull << ChunkBit(c, x, y);
+    return mask;
+}
+
+void CaptureGame(GameWorld& world, GameSnapshot& out) {
+    Map& maze = world.maze;
+    out.pac = world.pac;
+    out.red = world.red;
+    out.pink = world.pink;
+    out.orange = world.orange;
+    out.blue = world.blue;
+    out.redRelease = world.redRelease;
+    out.pinkRelease = world.pinkRelease;
+    out.orangeRelease = world.orangeRelease;
+    out.blueRelease = world.blueRelease;
+    out.globalFrames = world.globalFrames;
+    out.waveTimer = world.waveTimer;
+    out.scatterMode = world.scatterMode;
+    out.frightenedTimer = world.frightenedTimer;
+    out.ghostFrame = world.ghostAI.frameNumber();
+
+    out.pelletsLeft = maze.pelletsLeft;
+    out.eatenHash = maze.eatenHash;
+    out.coinMasks.resize(maze.chunks.size());
+    out.energizerMasks.resize(maze.chunks.size());
+    for (size_t i = 0; i < maze.chunks.size(); i++) {
+        MapChunk& c = maze.chunks[i];
+        if (!c.loaded) maze.loadChunk(c);
+        out.coinMasks[i] = CoinMask(c);
+        out.energizerMasks[i] = EnergizerMask(maze, c);
+    }
+    out.powerUps = maze.mysteryPowerUps;
+}
+
+void RestoreGame(GameWorld& world, const GameSnapshot& snapshot) {
+    Map& maze = world.maze;
+    world.pac = snapshot.pac;
+    world.red = snapshot.red;
+    world.pink = snapshot.pink;
+    world.orange = snapshot.orange;
+    world.blue = snapshot.blue;
+    world.redRelease = snapshot.redRelease;
+    world.pinkRelease = snapshot.pinkRelease;
+    world.orangeRelease = snapshot.orangeRelease;
+    world.blueRelease = snapshot.blueRelease;
+    world.globalFrames = snapshot.globalFrames;
+    world.waveTimer = snapshot.waveTimer;
+    world.scatterMode = snapshot.scatterMode;
+    world.frightenedTimer = snapshot.frightenedTimer;
+    world.ghostAI.setFrameNumber(snapshot.ghostFrame);
+
+    maze.pelletsLeft = snapshot.pelletsLeft;
+    maze.eatenHash = snapshot.eatenHash;
+    size_t count = min(maze.chunks.size(), snapshot.coinMasks.size());
+    for (size_t i = 0; i < count; i++) {
+        MapChunk& c = maze.chunks[i];
+        if (!c.loaded) maze.loadChunk(c);
+
+        uint64_t coins = snapshot.coinMasks[i];
+        if (CoinMask(c) != coins) {
+            c.coins.clear();
+            for (int bit = 0; bit < CHUNK_TILES * CHUNK_TILES; bit++)
+                if (coins >> bit & 1) c.coins.addCoin(c.x0 + bit % CHUNK_TILES, c.y0 + bit / CHUNK_TILES);
+        }
+
+        // Energizers only ever go from 'O' to ' ', so the two masks say which tiles to flip
+        uint64_t now = EnergizerMask(maze, c), want = snapshot.energizerMasks[i];
+        for (uint64_t diff = now ^ want; diff; diff &= diff - 1) {
+            int bit = 0;
+            while (!(diff >> bit & 1)) bit++;
+            maze.layout[c.y0 + bit / CHUNK_TILES][c.x0 + bit % CHUNK_TILES] = (want >> bit & 1) ? 'O' : ' ';
+        }
+    }
+    maze.mysteryPowerUps = snapshot.powerUps;
+    UpdateStateHash(world);
+}
+
+unique_ptr<GameWorld> CloneGameWorld(GameWorld& source) {
+    GameSnapshot state;
+    CaptureGame(source, state);     // also loads every chunk, so layout is complete
+
+    Map& src = source.maze;
+    MapPrebuilt tables = src.prebuilt();
+    unique_ptr<GameWorld> copy(new GameWorld(Map(src.layout, src.tileSize, &tables), source.red.texture, src.tileSize));
+    copy->maze.setHardMode(src.isHard);
+    copy->startPowerUps = source.startPowerUps;
+    copy->ghostAI.config = source.ghostAI.config;
+    copy->twoPhaseGhosts = source.twoPhaseGhosts;
+    RestoreGame(*copy, state);
+    return copy;
+}
+
+// -------------------- Gameplay Frame --------------------
+// A ghost's full update when the scheduler wants a decision, its last step otherwise
+template <typename Update>
+static void ScheduleGhost(GhostScheduler& ai, Ghost& g, Map& maze, Update update) {
+    if (ai.beginDecision(g, maze)) {
+        update();
+        ai.endDecision(g);
+    }
+    else g.followPlan(maze.tileSize);
+}
+
+// Party mode: the crowd chases at the ghosts' speed. Energized, Pacman eats
+// every crowd ghost he touches; otherwise one touch catches him as a ghost
+// would, and the crowd is cleared away from his start.
+static void UpdateCrowd(GameWorld& world) {
+    GhostCrowd& crowd = world.crowd;
+    Pacman& pac = world.pac;
+    if (crowd.update(world.maze, pac, world.red.speed, world.ghostJobs) == 0) return;
+
+    if (pac.energizer_timer > 0) {
+        for (int i : crowd.touching()) crowd.respawn(world.maze, i);
+        PlaySfx(SFX_GHOST_EATEN);
+        return;
+    }
+    pac.dying = true;
+    pac.death_timer = 0;
+    pac.lives--;
+    PlaySfx(SFX_DEATH);
+    pac.x = pac.startXPos;
+    pac.y = pac.startYPos;
+    pac.direction = Pacman::RIGHT;
+    pac.alive = true;
+    crowd.clearAround(world.maze, world.maze.pacStartX, world.maze.pacStartY);
+}
+
+// What a ghost does in one pass of the two-phase tick
+enum GhostStep { GS_NONE, GS_EYES, GS_UPDATE };
+
+static void TickGhostsTwoPhase(GameWorld& world, const GhostStep steps[4]) {
+    ScopedZone zone(PZ_GHOST_JOBS);
+    Map& maze = world.maze;
+    int tileSize = maze.tileSize;
+    GhostScheduler& ai = world.ghostAI;
+    GhostTickScratch& scratch = world.ghostScratch;
+    Ghost* ghosts[4] = { &world.red, &world.pink, &world.orange, &world.blue };
+    Ghost* copies[4] = { &scratch.red, &scratch.pink, &scratch.orange, &scratch.blue };
+
+    // Who runs a full update; the scheduler may extend the others' plans.
+    // Chunks are loaded first so the jobs only ever read the map.
+    if (maze.fileBacked)
+        for (MapChunk& c : maze.chunks)
+            if (!c.loaded) maze.loadChunk(c);
+    bool full[4];
+    double ms[4] = {};
+    for (int i = 0; i < 4; i++) {
+        full[i] = steps[i] == GS_EYES || (steps[i] == GS_UPDATE && ai.beginDecision(*ghosts[i], maze));
+        if (full[i]) *copies[i] = *ghosts[i];
+    }
+
+    // Phase 1, in parallel: each job moves only its own copy
+    auto step = [&](int i) {
+        if (!full[i]) return;
+        auto start = chrono::steady_clock::now();
+        if (steps[i] == GS_EYES) backtrackToGate(*copies[i], maze, tileSize, 1.0f);
+        else if (i == 0) scratch.red.update(world.pac, maze, tileSize, world.scatterMode);
+        else if (i == 1) scratch.pink.update(world.pac, maze, tileSize, world.scatterMode);
+        else if (i == 2) scratch.orange.update(world.pac, maze, tileSize, world.scatterMode);
+        else scratch.blue.update(world.pac, world.red, maze, tileSize, world.scatterMode);
+        ms[i] = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    };
+    if (world.ghostJobs) world.ghostJobs->parallelFor(4, step);
+    else for (int i = 0; i < 4; i++) step(i);
+
+    // Phase 2, in ghost order: write the copies back, replay the rest
+    for (int i = 0; i < 4; i++) {
+        if (full[i]) {
+            *ghosts[i] = *copies[i];
+            if (steps[i] == GS_UPDATE) ai.recordDecision(*ghosts[i], ms[i]);
+        }
+        else if (steps[i] != GS_NONE) ghosts[i]->followPlan(tileSize);
+    }
+}
+
+void UpdateGameplay(GameWorld& world, const LevelInfo& level) {
+    Map& maze = world.maze;
+    Pacman& pac = world.pac;
+    RedGhost& red = world.red;
+    PinkGhost& pink = world.pink;
+    OrangeGhost& orange = world.orange;
+    BlueGhost& blue = world.blue;
+    ReleaseInfo& redRelease = world.redRelease;
+    ReleaseInfo& pinkRelease = world.pinkRelease;
+    ReleaseInfo& orangeRelease = world.orangeRelease;
+    ReleaseInfo& blueRelease = world.blueRelease;
+    int& globalFrames = world.globalFrames;
+    int& waveTimer = world.waveTimer;
+    bool& scatterMode = world.scatterMode;
+    int& frightenedTimer = world.frightenedTimer;
+    int tileSize = maze.tileSize;
+
+    globalFrames++;
+    world.ghostAI.beginFrame(maze, pac, scatterMode);
+
+    int pacGridX = (int)((pac.x + pac.tileSize / 2) / pac.tileSize);
+    int pacGridY = (int)((pac.y + pac.tileSize / 2) / pac.tileSize);
+
+    {
+        ScopedZone zone(PZ_POWER_UPS);
+        for (int i = 0; i < (int)maze.mysteryPowerUps.size(); i++) {
+            int mx = maze.mysteryPowerUps[i].first;
+            int my = maze.mysteryPowerUps[i].second;
+
+            if (pacGridX == mx && pacGridY == my) {
+                processMysteryPowerUp(pac);  // apply PQ logic
+                maze.mysteryPowerUps.erase(maze.mysteryPowerUps.begin() + i); // remove eaten tile
+                i--; // adjust index
+            }
+        }
+    }
+
+    // Pacman death animation handler
+      
+        if (pac.dying) {
+            pac.death_timer++;
+            if (pac.death_timer > 90) {
+                pac.dying = false;
+                pac.death_timer = 0;
+
+                // Reset Pac-Man
+                pac.x = pac.startXPos;
+                pac.y = pac.startYPos;
+                pac.direction = Pacman::RIGHT;
+                pac.desiredDirection = Pacman::RIGHT;
+
+                // Reset Ghosts
+                red.position = { (float)red.cageX * tileSize, (float)red.cageY * tileSize };
+                pink.position = { (float)pink.cageX * tileSize, (float)pink.cageY * tileSize };
+                orange.position = { (float)orange.cageX * tileSize, (float)orange.cageY * tileSize };  // Now correctly x=11
+                blue.position = { (float)blue.cageX * tileSize, (float)blue.cageY * tileSize };        // Now correctly x=10
+
+
+                red.frightened_mode = pink.frightened_mode = orange.frightened_mode = blue.frightened_mode = 0;
+
+                // Ghost release reset
+                redRelease.state = R_ACTIVE;
+                pinkRelease.state = orangeRelease.state = blueRelease.state = R_IN_CAGE;
+
+                globalFrames = 0;    // FOR RELEASE SYSTEM
+            }
+        }
+    
+    else {
+        // Release ghosts
+        {
+            ScopedZone zone(PZ_RELEASE);
+            releaseGhost(pink, red, maze, tileSize, globalFrames, pinkRelease);
+            releaseGhost(orange, red, maze, tileSize, globalFrames, orangeRelease);
+            releaseGhost(blue, red, maze, tileSize, globalFrames, blueRelease);
+        }
+
+        // 1?? Pac-Man moves
+        {
+            ScopedZone zone(PZ_PACMAN);
+            CoinList coins;
+            pac.updatePacMan(maze, coins);
+        }
+
+        // 2?? Check for large pellet
+
+        // -------------------- Update ghosts (call in your main loop) --------------------
+
+        if (world.twoPhaseGhosts) {
+            GhostStep steps[4];
+            Ghost* ghosts[4] = { &red, &pink, &orange, &blue };
+            for (int i = 0; i < 4; i++) steps[i] = ghosts[i]->frightened_mode == 2 ? GS_EYES : GS_UPDATE;
+            TickGhostsTwoPhase(world, steps);
+        }
+        else {
+            // Red
+            {
+                ScopedZone zone(PZ_GHOST_RED);
+                if (red.frightened_mode == 2) {
+                    // eyes-eaten state ? backtrack to gate using BFS
+                    backtrackToGate(red, maze, tileSize, 1.0f);
+                }
+                else {
+                    // normal behaviour (frightened_mode==1 handled inside update if you implemented it)
+                    ScheduleGhost(world.ghostAI, red, maze, [&] { red.update(pac, maze, tileSize, scatterMode); });
+                }
+            }
+
+            // Pink
+            {
+                ScopedZone zone(PZ_GHOST_PINK);
+                if (pink.frightened_mode == 2) {
+                    backtrackToGate(pink, maze, tileSize, 1.0);
+                }
+                else {
+                    ScheduleGhost(world.ghostAI, pink, maze, [&] { pink.update(pac, maze, tileSize, scatterMode); });
+                }
+            }
+
+            // Orange
+            {
+                ScopedZone zone(PZ_GHOST_ORANGE);
+                if (orange.frightened_mode == 2) {
+                    backtrackToGate(orange, maze, tileSize, 1.0f);
+                }
+                else {
+                    ScheduleGhost(world.ghostAI, orange, maze, [&] { orange.update(pac, maze, tileSize, scatterMode); });
+                }
+            }
+
+            // Blue (note: Blue's update needs Red reference)
+            {
+                ScopedZone zone(PZ_GHOST_BLUE);
+                if (blue.frightened_mode == 2) {
+                    backtrackToGate(blue, maze, tileSize, 1.0f);
+                }
+                else {
+                    ScheduleGhost(world.ghostAI, blue, maze, [&] { blue.update(pac, red, maze, tileSize, scatterMode); });
+                }
+            }
+        }
+
+
+
+        // -------------------- FRIGHTENED MODE --------------------
+        if (pac.energizer_timer > 0)
+        {
+            ScopedZone zone(PZ_FRIGHTENED);
+
+            // Decrease energizer timer each frame
+            pac.energizer_timer--;
+
+            // Call frightened function
+            frightened(
+                pac,
+                red, pink, orange, blue,
+                frightenedTimer,        // this will increment inside frightened()
+                tileSize,
+                redRelease, pinkRelease, orangeRelease, blueRelease,
+                maze,
+                globalFrames
+            );
+        }
+        else
+        {
+            // Energizer finished ? reset frightened mode if needed
+            if (frightenedTimer > 0)
+            {
+                frightenedTimer = 0;
+                red.frightened_mode = pink.frightened_mode = orange.frightened_mode = blue.frightened_mode = 0;
+
+            }
+        }
+
+
+
+        if (!world.crowd.empty()) {
+            ScopedZone zone(PZ_CROWD);
+            UpdateCrowd(world);
+        }
+
+        // Collision detection
+        {
+            ScopedZone zone(PZ_COLLISION);
+            checkPacmanGhostCollision(
+                pac, red, pink, orange, blue,
+                tileSize, redRelease, blueRelease, pinkRelease, orangeRelease,
+                maze, globalFrames
+            );
+        }
+
+        // Scatter/Chase waves
+        waveTimer++;
+        if (scatterMode && waveTimer > level.scatterFrames) { scatterMode = false; waveTimer = 0; }
+        else if (!scatterMode && waveTimer > level.chaseFrames) { scatterMode = true; waveTimer = 0; }
+
+        // Update ghosts (timed in the same zones as above)
+        if (world.twoPhaseGhosts) {
+            GhostStep steps[4] = { GS_UPDATE,
+                pinkRelease.state == R_ACTIVE ? GS_UPDATE : GS_NONE,
+                orangeRelease.state == R_ACTIVE ? GS_UPDATE : GS_NONE,
+                blueRelease.state == R_ACTIVE ? GS_UPDATE : GS_NONE };
+            TickGhostsTwoPhase(world, steps);
+        }
+        else {
+            GhostScheduler& ai = world.ghostAI;
+            { ScopedZone zone(PZ_GHOST_RED); ScheduleGhost(ai, red, maze, [&] { red.update(pac, maze, tileSize, scatterMode); }); }
+            if (pinkRelease.state == R_ACTIVE)   { ScopedZone zone(PZ_GHOST_PINK); ScheduleGhost(ai, pink, maze, [&] { pink.update(pac, maze, tileSize, scatterMode); }); }
+            if (orangeRelease.state == R_ACTIVE) { ScopedZone zone(PZ_GHOST_ORANGE); ScheduleGhost(ai, orange, maze, [&] { orange.update(pac, maze, tileSize, scatterMode); }); }
+            if (blueRelease.state == R_ACTIVE)   { ScopedZone zone(PZ_GHOST_BLUE); ScheduleGhost(ai, blue, maze, [&] { blue.update(pac, red, maze, tileSize, scatterMode); }); }
+        }
+    }
+
+    UpdateStateHash(world);
+}
+
+// -------------------- Headless Runner --------------------
+static const int HEADLESS_TURN_FRAMES = 30;     // Pacman picks a new direction this often
+static const int HEADLESS_HASH_CHECK_FRAMES = 60;   // the incremental state hash is checked this often
+
+static string HashText(uint64_t hash) {
+    ostringstream out;
+    out << "0x" << hex << setw(16) << setfill('0') << hash;
+    return out.str();
+}
+
+int RunHeadless(const LevelInfo& level, int frames, uint32_t seed, int allocBudget, const GhostLodConfig& ghostLod,
+    JobSystem* ghostJobs) {
+    unique_ptr<Map> map = BuildLevelMap(level, TILE_SIZE);
+    if (!map) {
+        cout << "Level '" << level.name << "' failed to load\n";
+        return 1;
+    }
+    GameWorld world(move(*map), Texture2D(), TILE_SIZE);
+    world.ghostAI.config = ghostLod;
+    world.twoPhaseGhosts = ghostJobs != nullptr;
+    world.ghostJobs = ghostJobs;
+    ResetGameWorld(world, level);
+
+    mt19937 rng(seed);
+    int games = 1;
+    double totalMs = 0.0, worstMs = 0.0;
+
+    profiler.clear();
+    if (allocBudget >= 0) AllocTrackingEnable(true);
+    for (int f = 0; f < frames; f++) {
+        if (f % HEADLESS_TURN_FRAMES == 0) world.pac.desiredDirection = (Pacman::Direction)(rng() % 4);
+
+        auto start = chrono::steady_clock::now();
+        UpdateGameplay(world, level);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        totalMs += ms;
+        worstMs = max(worstMs, ms);
+
+        if (f % HEADLESS_HASH_CHECK_FRAMES == 0 && GameStateHash(world) != ComputeStateHash(world)) {
+            cout << "FAIL: state hash " << HashText(GameStateHash(world)) << " drifted from "
+                << HashText(ComputeStateHash(world)) << " at frame " << f << "\n";
+            AllocTrackingEnable(false);
+            return 1;
+        }
+
+        // Game over or level cleared: start again, as the menu would
+        if (world.pac.lives <= 0 || world.maze.pelletsLeft <= 0) {
+            ResetGameWorld(world, level);
+            games++;
+        }
+
+        profiler.frameBegin();
+        AllocFrameBegin();
+    }
+    AllocTrackingEnable(false);
+
+    cout << "Headless: " << frames << " frames of '" << level.name << "' (seed " << seed << ", " << games << " games), "
+        << (frames ? totalMs / frames : 0.0) << " ms per frame, worst " << worstMs << " ms\n";
+    cout << "State hash " << HashText(GameStateHash(world)) << " (compare runs of the same frames and seed)\n";
+    if (ghostLod.enabled) {
+        const GhostLodStats& s = world.ghostAI.total;
+        cout << "Ghost LOD: " << s.decided << " decided (" << s.forced << " forced), " << s.deferred << " deferred, "
+            << s.dropped << " dropped, " << s.ms << " ms deciding\n";
+    }
+    cout << "Zones over the last " << profiler.frames() << " frames:\n" << fixed << setprecision(4);
+    for (int z = 0; z < PZ_COUNT; z++) {
+        ProfileStats s = profiler.stats(z);
+        if (s.avgMs > 0.0) cout << "  " << ProfileZoneName(z) << ": avg " << s.avgMs << " ms, p99 " << s.p99Ms << " ms\n";
+    }
+    cout.unsetf(ios::floatfield);
+    if (allocBudget < 0) return 0;
+
+    PrintAllocReport();
+    if (AllocWorstFrame().count > allocBudget) {
+        cout << "FAIL: frame " << AllocWorstFrameIndex() << " made " << AllocWorstFrame().count
+            << " allocations, budget is " << allocBudget << "\n";
+        return 1;
+    }
+    cout << "OK: no frame made more than " << allocBudget << " allocations\n";
+    return 0;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#ifndef GAME_H
+#define GAME_H
+
+#include "GameConstants.h"
+#include "Map.h"
+#include "Pacman.h"
+#include "Ghost.h"
+#include "Level.h"
+#include "GhostAI.h"
+#include "JobSystem.h"
+#include "Crowd.h"
+#include <memory>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Two-Phase Ghost Tick --------------------
+// With twoPhaseGhosts set on the world, each ghost pass runs in two phases:
+// every ghost due a full update runs it on its own scratch copy, in
+// parallel, reading only the world as it was before the pass (Blue reads
+// Red's position from before Red moved); then the copies are written back
+// and the other ghosts replay their plans, in a fixed order. Phase 1 runs
+// on the world's job system, or inline without one. The result is the same
+// for any thread count, one included, though not the same as the serial
+// tick, where each ghost sees the ones updated before it.
+struct GhostTickScratch {
+    RedGhost red{ 0, 0, 0, Texture2D(), TILE_SIZE };
+    PinkGhost pink{ 0, 0, 1, Texture2D(), TILE_SIZE };
+    OrangeGhost orange{ 0, 0, 3, Texture2D(), TILE_SIZE };
+    BlueGhost blue{ 0, 0, 2, Texture2D(), TILE_SIZE };
+};
+
+// -------------------- Game World --------------------
+// Everything one game simulates: the maze, Pacman, the ghosts and the
+// release / frightened / wave timers. The window loop and the headless
+// runner step it through the same UpdateGameplay().
+struct GameWorld {
+    Map maze;
+    Pacman pac;
+    RedGhost red;
+    PinkGhost pink;
+    OrangeGhost orange;
+    BlueGhost blue;
+
+    ReleaseInfo redRelease, pinkRelease, orangeRelease, blueRelease;
+
+    int globalFrames = 0;
+    int waveTimer = 0;
+    bool scatterMode = true;
+    int frightenedTimer = 0;
+
+    vector<pair<int, int>> startPowerUps;   // the map's power-ups before any were eaten
+
+    GhostScheduler ghostAI;                 // level of detail for ghost updates; off by default
+    bool twoPhaseGhosts = false;            // see GhostTickScratch
+    JobSystem* ghostJobs = nullptr;         // runs phase 1 of the two-phase tick; null = inline
+    GhostTickScratch ghostScratch;          // kept so eyes paths keep their buffers
+    GhostCrowd crowd;                       // party mode (Crowd.h); empty otherwise. Not in snapshots or the state hash
+
+    // Incremental state hash (see StateHash.h): the single-value features and
+    // power-ups, last seen by UpdateStateHash(); pellets live in maze.eatenHash
+    uint64_t valueHash = 0;
+    int64_t hashedValues[SF_VALUES] = {};
+    vector<pair<int, int>> hashedPowerUps;
+
+    // Puts everyone at the map's spawn points; call StartLevel() for the level's speeds
+    GameWorld(Map&& map, Texture2D ghostTexture, int tileSize);
+};
+
+// Back to the start of a fresh game of this level: pellets, power-ups, score,
+// lives, actors and every timer. Unlike the menu's resetGame(), eaten
+// power-ups come back too.
+void ResetGameWorld(GameWorld& world, const LevelInfo& level);
+
+// Difficulty as the level-select screen applies it: speeds, the map's
+// pellets, and a single life on hard
+void SetGameDifficulty(GameWorld& world, bool hard);
+
+// One gameplay frame: power-ups, death animation, release, Pacman, ghosts,
+// frightened mode, collisions and scatter/chase waves. No drawing.
+void UpdateGameplay(GameWorld& world, const LevelInfo& level);
+
+// -------------------- State Hash --------------------
+// 64-bit hash of the whole game state, kept up to date as it plays:
+// UpdateGameplay(), ResetGameWorld() and RestoreGame() call UpdateStateHash(),
+// which only XORs in the features that changed, and the maze updates its
+// part as pellets and energizers are eaten. Use it to spot replay desyncs,
+// as a transposition table key, or to compare runs across code changes.
+inline uint64_t GameStateHash(const GameWorld& world) { return world.valueHash ^ world.maze.eatenHash; }
+
+// Call after changing the world outside those functions
+void UpdateStateHash(GameWorld& world);
+
+// The same hash built from nothing, to check the incremental one
+uint64_t ComputeStateHash(GameWorld& world);
+
+// -------------------- Snapshots --------------------
+// The changing part of a GameWorld: actors, timers, pellets, energizers and
+// power-ups. Restoring a snapshot into a world of the same maze (e.g. one
+// from CloneGameWorld) clones the game, which is what search AIs do to play
+// ahead and come back. Captures reuse the snapshot's buffers, and restores
+// only rebuild the coin lists of chunks whose pellets differ.
+static_assert(CHUNK_TILES * CHUNK_TILES <= 64, "one 64-bit pellet mask per chunk");
+
+struct GameSnapshot {
+    Pacman pac{ 0, 0, TILE_SIZE };
+    RedGhost red{ 0, 0, 0, Texture2D(), TILE_SIZE };
+    PinkGhost pink{ 0, 0, 1, Texture2D(), TILE_SIZE };
+    OrangeGhost orange{ 0, 0, 3, Texture2D(), TILE_SIZE };
+    BlueGhost blue{ 0, 0, 2, Texture2D(), TILE_SIZE };
+    ReleaseInfo redRelease, pinkRelease, orangeRelease, blueRelease;
+    int globalFrames = 0;
+    int waveTimer = 0;
+    bool scatterMode = true;
+    int frightenedTimer = 0;
+    int ghostFrame = 0;                     // GhostScheduler frame the ghosts' last decisions count from
+
+    int pelletsLeft = 0;
+    uint64_t eatenHash = 0;
+    vector<uint64_t> coinMasks;             // per chunk: bit (y - y0) * CHUNK_TILES + (x - x0)
+    vector<uint64_t> energizerMasks;        // per chunk, same bits: 'O' tiles not eaten yet
+    vector<pair<int, int>> powerUps;
+};
+
+// Loads every chunk of a .pmap-backed maze the first time
+void CaptureGame(GameWorld& world, GameSnapshot& out);
+void RestoreGame(GameWorld& world, const GameSnapshot& snapshot);
+
+// A second world on the same maze in the same state, ticking its ghosts the
+// same way (but on the calling thread). The copy reads the source's
+// navigation tables, so the source's map must outlive it.
+unique_ptr<GameWorld> CloneGameWorld(GameWorld& source);
+
+// -------------------- Headless Runner --------------------
+// Plays the first level without a window: Pacman picks a new random
+// direction every so often, and lost games restart. Prints frame times
+// (and allocations when tracking is on, ghost LOD counts when it is enabled)
+// and returns the process exit code: 1 if a frame allocated more than
+// allocBudget (< 0 = no budget). With ghostJobs the ghosts use the
+// two-phase tick on it.
+int RunHeadless(const LevelInfo& level, int frames, uint32_t seed, int allocBudget,
+    const GhostLodConfig& ghostLod = GhostLodConfig(), JobSystem* ghostJobs = nullptr);
+
+#endif // GAME_H
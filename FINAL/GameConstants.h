@@ -16,13 +16,23 @@ namespace GameConstants {
 
     // Frightened mode constants
     const int FRIGHTENED_TOTAL_FRAMES = 60 * 7;
-    const int FRIGHTENED_FLASH_START = FRIGHTENED_TOTAL_FRAMES - (60 * 2);
+    const int FRIGHTENED_FLASH_FRAMES = 60 * 2;     // flashing at the end of frightened mode
+    const int FRIGHTENED_FLASH_START = FRIGHTENED_TOTAL_FRAMES - FRIGHTENED_FLASH_FRAMES;
     const int FRIGHTENED_FLASH_INTERVAL = 15;
 
     // Other constants (e.g., collision, tile size)
     const float PACMAN_GHOST_COLLISION_DIST = 20.0f;
     const int TILE_SIZE = 45;
 
+    // Chunked rendering: the maze is drawn in CHUNK_TILES x CHUNK_TILES blocks
+    const int CHUNK_TILES = 8;
+    const int VIEW_MAX_COLS = 28;       // window never grows past this many tiles
+    const int VIEW_MAX_ROWS = 21;
+    const int MAX_BAKED_CHUNKS = 64;    // chunk textures kept alive on the GPU
+
+    // Loading screen stays up until assets are loaded, and at least this long
+    const int LOADING_MIN_FRAMES = 60;
+
     // Enums
     typedef enum { MENU_PLAY, MENU_HOW_TO, MENU_HIGHSCORE, MENU_EXIT } MenuOption;
     typedef enum { STATE_MENU, STATE_LOADING, STATE_LEVEL_SELECT,STATE_ENTER_NAME, STATE_PLAYING, STATE_HIGHSCORE, STATE_HOW_TO, STATE_EXIT } GameState;
@@ -1,6 +1,8 @@
 #include "Ghost.h"
 #include "Map.h"
 #include "Pacman.h"
+#include "Audio.h"
+#include "AllocTrack.h"
 
 // -------------------- Ghost Base Class --------------------
 Ghost::Ghost(int gx, int gy, int i_id, Texture2D tex, int tileSize)
@@ -15,11 +17,24 @@ Ghost::Ghost(int gx, int gy, int i_id, Texture2D tex, int tileSize)
     eyesTargetY = gateY;
     isHard = false;
     speed = NORMAL_SPEED;
+    baseSpeed = NORMAL_SPEED;
 }
 
 void Ghost::setHardMode(bool hard) {
     isHard = hard;
-    speed = isHard ? HARD_SPEED : NORMAL_SPEED;
+    speed = isHard ? baseSpeed + (HARD_SPEED - NORMAL_SPEED) : baseSpeed;
+}
+
+void Ghost::setCage(int gx, int gy, int tileSize) {
+    position = { (float)gx * tileSize, (float)gy * tileSize };
+    cageX = gx;
+    cageY = gy;
+    gateX = gx;
+    gateY = gy - 1;
+    eyesTargetX = gateX;
+    eyesTargetY = gateY;
+    frightened_mode = 0;
+    planX = planY = planFromX = planFromY = -1;
 }
 
 void Ghost::moveToGate(Map& map, int tileSize) {
@@ -303,7 +318,39 @@ void BlueGhost::draw(bool debug, int tileSize) {
 // -------------------- Functions --------------------
 // Implement navigateToTile, backtrackToGate, fleeFromPacman, chasePacmanToTarget, etc.
 
+// Smooth movement toward the centre of a (row, col) cell
+static void moveTowardCell(Ghost& g, int tileSize, pair<int, int> cell, float speed) {
+    float targetX = cell.second * tileSize + tileSize / 2.0f;
+    float targetY = cell.first * tileSize + tileSize / 2.0f;
+    float dx = targetX - (g.position.x + tileSize / 2.0f);
+    float dy = targetY - (g.position.y + tileSize / 2.0f);
+    float len = sqrtf(dx * dx + dy * dy);
+
+    if (len > 0.0001f) {
+        dx = dx / len * speed;
+        dy = dy / len * speed;
+        g.position.x += dx;
+        g.position.y += dy;
+    }
+}
+
+void Ghost::followPlan(int tileSize) {
+    if (planX >= 0) moveTowardCell(*this, tileSize, { planY, planX }, planSpeed);
+}
+
+// Remember the step for the AI scheduler, then take it
+static void stepToward(Ghost& g, int tileSize, int gx, int gy, pair<int, int> cell, float speed) {
+    g.planFromX = gx;
+    g.planFromY = gy;
+    g.planX = cell.second;
+    g.planY = cell.first;
+    g.planSpeed = speed;
+    moveTowardCell(g, tileSize, cell, speed);
+}
+
 void navigateToTile(Ghost& g, Map& map, int tileSize, int tx, int ty, float speed) {
+    ScopedAllocSite allocSite("navigateToTile");
+
     // current ghost tile
     int gx = (int)((g.position.x + tileSize / 2) / tileSize);
     int gy = (int)((g.position.y + tileSize / 2) / tileSize);
@@ -312,6 +359,13 @@ void navigateToTile(Ghost& g, Map& map, int tileSize, int tx, int ty, float spee
     if (tx < 0) tx = 0; if (tx >= map.cols) tx = map.cols - 1;
     if (ty < 0) ty = 0; if (ty >= map.rows) ty = map.rows - 1;
 
+    // Precomputed next hop (same answer the BFS below would give)
+    int hop = map.nav.hopToward(gx, gy, tx, ty);
+    if (hop >= 0) {
+        stepToward(g, tileSize, gx, gy, { gy + NAV_DY[hop], gx + NAV_DX[hop] }, speed);
+        return;
+    }
+
     // BFS setup
     vector<vector<bool>> visited(map.rows, vector<bool>(map.cols, false));
     vector<vector<pair<int, int>>> parent(map.rows, vector<pair<int, int>>(map.cols, { -1,-1 }));
@@ -393,27 +447,14 @@ void navigateToTile(Ghost& g, Map& map, int tileSize, int tx, int ty, float spee
     }
 
     // Smooth movement toward nextCell
-    float targetX = nextCell.second * tileSize + tileSize / 2.0f;
-    float targetY = nextCell.first * tileSize + tileSize / 2.0f;
-    float dx = targetX - (g.position.x + tileSize / 2.0f);
-    float dy = targetY - (g.position.y + tileSize / 2.0f);
-    float len = sqrtf(dx * dx + dy * dy);
-
-    if (len > 0.0001f) {
-        dx = dx / len * speed;
-        dy = dy / len * speed;
-        g.position.x += dx;
-        g.position.y += dy;
-    }
+    stepToward(g, tileSize, gx, gy, nextCell, speed);
 }
 
 void backtrackToGate(Ghost& g, Map& map, int tileSize, float speed) {
+    ScopedAllocSite allocSite("backtrackToGate");
     using Tile = pair<int, int>;
-    uintptr_t key = (uintptr_t)(&g);
 
-    // Static caches keyed by ghost pointer address
-    static unordered_map<uintptr_t, vector<Tile>> pathCache;    // tiles from ghost -> ... -> gate
-    static unordered_map<uintptr_t, size_t> pathIndex;         // next tile index to move to (start at 1)
+    // The path is cached on the ghost (g.eyesPath), so separate games never share it
 
     // Gate tile (use eyesTarget if present, otherwise use gateX/gateY)
     int gateX = g.eyesTargetX;
@@ -428,16 +469,16 @@ void backtrackToGate(Ghost& g, Map& map, int tileSize, float speed) {
         // ensure full body and start exit process
         g.frightened_mode = 0;
         g.releaseState = R_EXITING_GATE;
-        pathCache.erase(key);
-        pathIndex.erase(key);
+        g.eyesPath.clear();
+        g.eyesPathIndex = 0;
         return;
     }
 
     // If there's no cached path or the cached path's start doesn't match current tile, recompute
     bool needCompute = false;
-    if (pathCache.find(key) == pathCache.end()) needCompute = true;
+    if (g.eyesPath.empty()) needCompute = true;
     else {
-        auto& cached = pathCache[key];
+        auto& cached = g.eyesPath;
         if (cached.empty()) needCompute = true;
         else {
             // cached[0] should be the ghost tile at time of computation; if ghost moved off that tile,
@@ -446,6 +487,23 @@ void backtrackToGate(Ghost& g, Map& map, int tileSize, float speed) {
         }
     }
 
+    // The map's gate table already holds this BFS tree when the target is its gate
+    if (needCompute && map.nav.gateHop && gateX == map.nav.gateX && gateY == map.nav.gateY &&
+        map.nav.walkable(gx, gy) && map.nav.gateHop[gy * map.cols + gx] != NAV_NONE) {
+        vector<Tile> path;
+        int x = gx, y = gy;
+        path.push_back({ y, x });
+        while (!(x == gateX && y == gateY)) {
+            int d = map.nav.gateHop[y * map.cols + x];
+            x += NAV_DX[d];
+            y += NAV_DY[d];
+            path.push_back({ y, x });
+        }
+        g.eyesPath = move(path);
+        g.eyesPathIndex = 1;
+        needCompute = false;
+    }
+
     if (needCompute) {
         // BFS from gate -> to ghost tile (so parent pointers allow path reconstruction from ghost -> gate)
         int rows = map.rows;
@@ -502,19 +560,19 @@ void backtrackToGate(Ghost& g, Map& map, int tileSize, float speed) {
         }
 
         // Cache the path and reset index
-        pathCache[key] = move(path);
-        pathIndex[key] = 1; // next tile to move to (index 1 means move from tile 0 -> tile 1)
+        g.eyesPath = move(path);
+        g.eyesPathIndex = 1; // next tile to move to (index 1 means move from tile 0 -> tile 1)
     }
 
     // Move toward next tile in cached path
-    auto& pathRef = pathCache[key];
-    size_t& idx = pathIndex[key];
+    auto& pathRef = g.eyesPath;
+    size_t& idx = g.eyesPathIndex;
 
     // If path too short or index out of range -> recompute next frame
     if (pathRef.size() < 2 || idx >= pathRef.size()) {
         // fallback: clear and recompute next frame
-        pathCache.erase(key);
-        pathIndex.erase(key);
+        g.eyesPath.clear();
+        g.eyesPathIndex = 0;
         return;
     }
 
@@ -538,8 +596,8 @@ void backtrackToGate(Ghost& g, Map& map, int tileSize, float speed) {
         idx++;
         // If we reached gate tile, finish
         if (idx >= pathRef.size()) {
-            pathCache.erase(key);
-            pathIndex.erase(key);
+            g.eyesPath.clear();
+            g.eyesPathIndex = 0;
             g.frightened_mode = 0;           // show full body
             g.releaseState = R_EXITING_GATE; // resume normal exit
         }
@@ -629,7 +687,7 @@ void releaseGhost(
     int framesSinceStart,
     ReleaseInfo& info   // external per-ghost state you must supply
 ) {
-    const int GATE_EXIT_Y = 7;       // gate row as in your code
+    const int GATE_EXIT_Y = map.gateY - 1;   // row just above the gate
     const float exitSpeed = 2.0f;    // speed when exiting gate
 
     // delays measured from the moment RED leaves the gate (frames @ 60 FPS)
@@ -637,8 +695,8 @@ void releaseGhost(
     const int DELAY_ORANGE_FRAMES = 13 * 60;   // Orange: 13s after Red left (5s after Pink)
     const int DELAY_BLUE_FRAMES = 16 * 60;   // Blue: 16s after Red left (8s after Pink)
 
-    // static stores when RED first left the cage (set once)
-    static int redLeftFrame = -1;
+    // when RED first left the cage (set once, kept on red)
+    int& redLeftFrame = red.leftCageFrame;
     // detect red leaving gate (first time)
     if (redLeftFrame == -1) {
         if ((int)(red.position.y / tileSize) < GATE_EXIT_Y) {
@@ -706,12 +764,13 @@ void frightened(
     int& framesSinceStart
 )
 {
+    ScopedAllocSite allocSite("frightened");
     vector<Ghost*> ghosts = { &red, &pink, &orange, &blue };
 
     // Increment frightened timer
     frightenedTimer++;
 
-    bool flashing = (frightenedTimer >= FRIGHTENED_FLASH_START) && (frightenedTimer % 30 < 15);
+    bool flashing = (frightenedTimer >= pac.energizerFrames - FRIGHTENED_FLASH_FRAMES) && (frightenedTimer % 30 < 15);
 
 
     // On first frame of frightened mode, reverse all ghost directions
@@ -749,6 +808,7 @@ void frightened(
         {
             // Send ghost to cage
             g->frightened_mode = 2; // eyes
+            PlaySfx(SFX_GHOST_EATEN);
             backtrackToGate(*g, map, tileSize);
             // score logic
             pac.score += 200;
@@ -766,8 +826,8 @@ void frightened(
         }
     }
 
-    // End frightened mode after 7 seconds
-    if (frightenedTimer >= FRIGHTENED_TOTAL_FRAMES) {
+    // End frightened mode after the level's energizer time (7 seconds on the classic level)
+    if (frightenedTimer >= pac.energizerFrames) {
         frightenedTimer = 0;
         for (Ghost* g : ghosts) {
             if (g->frightened_mode != 2) {
@@ -792,8 +852,7 @@ void checkPacmanGhostCollision(
     int& framesSinceStart
 )
 {
-    // Local static to reset releaseGhost timing after a death
-    static int redLeftFrame_global = -1;
+    ScopedAllocSite allocSite("checkPacmanGhostCollision");
 
     std::vector<Ghost*> ghosts = { &red, &pink, &orange, &blue };
 
@@ -820,6 +879,7 @@ void checkPacmanGhostCollision(
             if (g->frightened_mode == 1) // ghost is edible
             {
                 g->frightened_mode = 2; // eyes mode
+                PlaySfx(SFX_GHOST_EATEN);
                 g->position.x = (float)g->cageX * tileSize;
                 g->position.y = (float)g->cageY * tileSize;
                 //THESE 2 LINES SEND GHOST BACK TO GATE
@@ -839,6 +899,7 @@ void checkPacmanGhostCollision(
             pac.dying = true;
             pac.death_timer = 0;
             pac.lives--;
+            PlaySfx(SFX_DEATH);
 
             // Reset Pac-Man position
             pac.x = pac.startXPos;
@@ -870,7 +931,6 @@ void checkPacmanGhostCollision(
             blueInfo.state = R_IN_CAGE; blueInfo.timer = 0; blueInfo.justEnteredScatter = false;
 
             framesSinceStart = 0;
-            redLeftFrame_global = -1;
 
             // Restart release cycle
             releaseGhost(pink, red, map, tileSize, framesSinceStart, pinkInfo);
@@ -34,12 +34,28 @@ public:
 
     ReleaseState releaseState = R_IN_CAGE;
     float speed;
+    float baseSpeed;              // easy-mode speed for the current level
 
 
     int cageX, cageY;             // cage center
     int gateX, gateY;             // door tile
     int eyesTargetX, eyesTargetY; // tile to move toward when eaten
 
+    // Per-ghost state that used to be function statics, so games running
+    // side by side (or cloned) don't share it
+    std::vector<std::pair<int, int>> eyesPath;  // backtrackToGate: (row, col) tiles to the gate
+    size_t eyesPathIndex = 0;                   // next tile in eyesPath
+    int leftCageFrame = -1;                     // red only: frame it first left the cage (releaseGhost)
+
+    // The last step navigateToTile chose: from tile planFrom toward the centre
+    // of tile plan at planSpeed. The AI scheduler (GhostAI.h) replays it on
+    // frames where the ghost doesn't re-decide.
+    int planX = -1, planY = -1;
+    int planFromX = -1, planFromY = -1;
+    float planSpeed = 0.0f;
+    int planMode = -1;                          // scheduler: frightened_mode * 2 + scatter at the last decision
+    int lastDecisionFrame = INT_MIN / 2;        // scheduler: frame of the last full update
+
     Ghost(int gx, int gy, int i_id, Texture2D tex, int tileSize);
 
     void moveToGate(Map& map, int tileSize);
@@ -47,6 +63,10 @@ public:
     void updateReleaseState(Map& map, float tileSize);
     // toggles hard mode for this ghost at runtime
     void setHardMode(bool hard);
+    // moves the cage (and gate/eyes target) for a new level and puts the ghost in it
+    void setCage(int gx, int gy, int tileSize);
+    // one step toward the planned tile without re-deciding
+    void followPlan(int tileSize);
 
 };
 
@@ -0,0 +1,89 @@
+#include "GhostAI.h"
+#include <cstdlib>
+
+using namespace std;
+
+// -------------------- GhostScheduler --------------------
+void GhostScheduler::beginFrame(Map& maze, const Pacman& pac, bool scatterMode) {
+    frameIndex++;
+    frame = GhostLodStats();
+    pacTileX = (int)((pac.x + maze.tileSize / 2) / maze.tileSize);
+    pacTileY = (int)((pac.y + maze.tileSize / 2) / maze.tileSize);
+    scatter = scatterMode;
+}
+
+// True when the plan can't simply be replayed. On the tile the plan leads
+// to, a corridor extends it by one tile; a junction or dead end needs a
+// real decision. A plan to stay put (a caged or boxed-in ghost) is kept
+// until the ghost's next scheduled decision.
+bool GhostScheduler::atDecisionPoint(Ghost& g, Map& maze, int gx, int gy) {
+    const MapNav& nav = maze.nav;
+    bool onPlan = gx == g.planX && gy == g.planY;
+    bool onFrom = gx == g.planFromX && gy == g.planFromY;
+    if (!onPlan) return !onFrom;                // off the plan: released, reset, eaten
+    if (onFrom) return false;
+    if (!nav.walkable(gx, gy)) return true;
+
+    int back = -1;
+    for (int d = 0; d < 4; d++)
+        if (gx + NAV_DX[d] == g.planFromX && gy + NAV_DY[d] == g.planFromY) back = d;
+    if (back < 0) return true;
+
+    unsigned char ahead = nav.walkMask[gy * nav.cols + gx] & ~(1 << back);
+    if (ahead == 0 || (ahead & (ahead - 1))) return true;
+    int d = 0;
+    while (!(ahead >> d & 1)) d++;
+    g.planFromX = gx;
+    g.planFromY = gy;
+    g.planX = gx + NAV_DX[d];
+    g.planY = gy + NAV_DY[d];
+    return false;
+}
+
+bool GhostScheduler::beginDecision(Ghost& g, Map& maze) {
+    if (!config.enabled) return true;
+
+    int tileSize = maze.tileSize;
+    int gx = (int)((g.position.x + tileSize / 2) / tileSize);
+    int gy = (int)((g.position.y + tileSize / 2) / tileSize);
+    int mode = g.frightened_mode * 2 + (scatter ? 1 : 0);
+
+    if (g.planX < 0 || g.planMode != mode || atDecisionPoint(g, maze, gx, gy)) {
+        frame.forced++;
+        total.forced++;
+        decisionStart = chrono::steady_clock::now();
+        return true;
+    }
+
+    int dist = abs(gx - pacTileX) + abs(gy - pacTileY);
+    bool visible = maze.isVisible(g.position.x + tileSize / 2.0f, g.position.y + tileSize / 2.0f);
+    int interval = (visible && dist <= config.nearTiles) ? 1
+        : (visible || dist <= config.farTiles) ? config.midInterval : config.farInterval;
+    if (interval > 1 && frameIndex - g.lastDecisionFrame < interval) {
+        frame.deferred++;
+        total.deferred++;
+        return false;
+    }
+    if (config.budgetMs > 0.0f && frame.ms >= config.budgetMs) {
+        frame.dropped++;
+        total.dropped++;
+        return false;
+    }
+    decisionStart = chrono::steady_clock::now();
+    return true;
+}
+
+void GhostScheduler::endDecision(Ghost& g) {
+    if (!config.enabled) return;
+    recordDecision(g, chrono::duration<double, milli>(chrono::steady_clock::now() - decisionStart).count());
+}
+
+void GhostScheduler::recordDecision(Ghost& g, double ms) {
+    if (!config.enabled) return;
+    frame.decided++;
+    total.decided++;
+    frame.ms += ms;
+    total.ms += ms;
+    g.lastDecisionFrame = frameIndex;
+    g.planMode = g.frightened_mode * 2 + (scatter ? 1 : 0);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef GHOST_AI_H
+#define GHOST_AI_H
+
+#include "Ghost.h"
+#include "Map.h"
+#include "Pacman.h"
+#include <chrono>
+
+using namespace std;
+
+// -------------------- Ghost AI Level of Detail --------------------
+// Decides which ghost updates run in full (targeting plus navigation, the
+// per-ghost update() methods) and which only replay the ghost's last step
+// (Ghost::followPlan). Ghosts on screen near Pacman decide every update,
+// ghosts that are on screen or fairly near every few frames, the rest rarely.
+//
+// A ghost always decides when it reaches a junction or a dead end, when its
+// mode (chase, scatter, frightened) changed, or when its plan no longer
+// starts from where it is. In a corridor the plan just follows the corridor.
+// Optional decisions stop once the frame's budget is spent: those are
+// dropped and the ghost keeps going until a later frame has time.
+//
+// Off by default, in which case every update runs as before. The budget
+// reads the clock, so with budgetMs > 0 two runs can differ; 0 keeps it
+// deterministic.
+struct GhostLodConfig {
+    bool enabled = false;
+    int nearTiles = 6;          // on screen and this close: every update
+    int farTiles = 14;          // on screen or this close: every midInterval frames
+    int midInterval = 4;
+    int farInterval = 15;       // everything else
+    float budgetMs = 0.25f;     // per frame for optional decisions; 0 = no budget
+};
+
+struct GhostLodStats {
+    int decided = 0;            // full updates (forced ones included)
+    int forced = 0;             // junctions, mode changes, stale plans
+    int deferred = 0;           // not due: replayed the plan
+    int dropped = 0;            // due, but over the budget
+    double ms = 0.0;            // spent in full updates
+};
+
+class GhostScheduler {
+public:
+    GhostLodConfig config;
+    GhostLodStats frame;        // the current (or last) frame
+    GhostLodStats total;
+
+    // Once per gameplay frame, before any ghost updates
+    void beginFrame(Map& maze, const Pacman& pac, bool scatterMode);
+
+    // True when g should run its full update, followed by endDecision(g);
+    // false when it should call g.followPlan() instead
+    bool beginDecision(Ghost& g, Map& maze);
+    void endDecision(Ghost& g);
+    // For updates timed elsewhere (the two-phase tick runs them on other threads)
+    void recordDecision(Ghost& g, double ms);
+
+    void resetStats() { frame = total = GhostLodStats(); }
+
+    // Ghosts remember the frame of their last decision, so a copy of the
+    // ghosts needs the frame counter they were counted against
+    int frameNumber() const { return frameIndex; }
+    void setFrameNumber(int index) { frameIndex = index; }
+
+private:
+    int frameIndex = 0;
+    int pacTileX = 0, pacTileY = 0;
+    bool scatter = false;
+    chrono::steady_clock::time_point decisionStart;
+
+    bool atDecisionPoint(Ghost& g, Map& maze, int gx, int gy);
+};
+
+#endif // GHOST_AI_H
@@ -1,45 +1,36 @@
 #include "Highscore.h"
+#include "FileIO.h"
+#include "ParallelSort.h"
 
 #include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <ctime>
+#include <cstring>
+#include <cstddef>
+#include <queue>
+#include <cstdio>
 
 using namespace std;
 
 // -------------------- Merge Sort --------------------
-void Merge(vector<HighscoreEntry>& hs, int left, int mid, int right) {
-    int n1 = mid - left + 1;
-    int n2 = right - mid;
-
-    vector<HighscoreEntry> L(n1), R(n2);
-
-    for (int i = 0; i < n1; i++) L[i] = hs[left + i];
-    for (int i = 0; i < n2; i++) R[i] = hs[mid + 1 + i];
-
-    int i = 0, j = 0, k = left;
-
-    while (i < n1 && j < n2) {
-        if (L[i].score >= R[j].score) { // Descending
-            hs[k++] = L[i++];
-        }
-        else {
-            hs[k++] = R[j++];
-        }
-    }
-    while (i < n1) hs[k++] = L[i++];
-    while (j < n2) hs[k++] = R[j++];
+// Descending by score, stable
+static bool ScoreBefore(const HighscoreEntry& a, const HighscoreEntry& b) {
+    return a.score > b.score;
 }
 
+// Sorts hs[left..right] (inclusive) on this thread, one merge buffer for the whole sort
 void MergeSortHighscores(vector<HighscoreEntry>& hs, int left, int right) {
     if (left >= right) return;
-    int mid = left + (right - left) / 2;
-    MergeSortHighscores(hs, left, mid);
-    MergeSortHighscores(hs, mid + 1, right);
-    Merge(hs, left, mid, right);
+    vector<HighscoreEntry> buffer(hs.size());
+    auto before = ScoreBefore;
+    MergeSortRange(hs.data(), buffer.data(), (size_t)left, (size_t)right + 1, before, 0);
 }
 
-void SortHighscores(vector<HighscoreEntry>& hs) {
-    if (hs.empty()) return;
-    MergeSortHighscores(hs, 0, hs.size() - 1);
+void SortHighscores(vector<HighscoreEntry>& hs, int threads) {
+    ParallelMergeSort(hs, ScoreBefore, threads);
 }
 
 // -------------------- Load / Save --------------------
@@ -62,57 +53,730 @@ void LoadHighscores(vector<HighscoreEntry>& highscores) {
 }
 
 void SaveHighscores(const vector<HighscoreEntry>& highscores) {
-    ofstream file("highscores.txt", ios::trunc);
+    // Write the whole table beside the old one, then swap it in
+    ofstream file("highscores.txt.tmp", ios::trunc);
     for (const auto& h : highscores) {
         file << h.name << " " << h.score << "\n";
     }
     file.close();
+    if (!file || !ReplaceFileAtomic("highscores.txt.tmp", "highscores.txt"))
+        cout << "Could not save highscores\n";
 }
 
-// -------------------- Draw Highscores --------------------
-void DrawHighscoreScreen(int winW, int winH, Font font,
-    vector<HighscoreEntry>& highscores,
-    const string& currentPlayer)
+// -------------------- HighscoreLog --------------------
+HighscoreLog::~HighscoreLog() {
+    writer.stop();
+}
+
+bool HighscoreLog::indexEntry(const HighscoreEntry& e, int row) {
+    PlayerStats& p = players[e.name];
+    if (e.score > 0) {
+        p.games++;
+        p.total += e.score;
+    }
+    p.lastPlayed = max(p.lastPlayed, e.playedAt);
+
+    if (p.bestRow >= 0 && e.score <= p.best) return false;
+    p.best = e.score;
+    p.bestRow = row;
+    return true;
+}
+
+void HighscoreLog::rebuildIndex() {
+    players.clear();
+    for (int i = 0; i < (int)entries.size(); i++) indexEntry(entries[i], i);
+    board.build(entries);
+
+    // Players in the order they set their best, so ties rank as in the full board
+    vector<pair<int, const string*>> bests;
+    bests.reserve(players.size());
+    for (const auto& p : players) bests.push_back({ p.second.bestRow, &p.first });
+    sort(bests.begin(), bests.end());
+
+    vector<HighscoreEntry> playerBests;
+    playerBests.reserve(bests.size());
+    for (const auto& b : bests) playerBests.push_back(entries[b.first]);
+    playerBoard.build(playerBests);
+
+    vector<NameMatch> named;
+    named.reserve(players.size());
+    for (const auto& p : players) named.push_back({ p.first, p.second.best });
+    names.build(move(named));
+}
+
+static HighscoreRecord ToRecord(const HighscoreEntry& e) {
+    HighscoreRecord r;
+    memset(&r, 0, sizeof(r));
+    memcpy(r.name, e.name.data(), min(e.name.size(), (size_t)HIGHSCORE_NAME_BYTES - 1));
+    r.score = e.score;
+    r.playedAt = e.playedAt;
+    return r;
+}
+
+static HighscoreFileHeader MakeHighscoreHeader() {
+    HighscoreFileHeader h;
+    memcpy(h.magic, HIGHSCORE_MAGIC, 4);
+    h.version = HIGHSCORE_VERSION;
+    h.recordSize = sizeof(HighscoreRecord);
+    h.headerCrc = Crc32(&h, offsetof(HighscoreFileHeader, headerCrc));
+    return h;
+}
+
+static HighscoreBlockHeader MakeBlockHeader(const HighscoreRecord* records, size_t count) {
+    HighscoreBlockHeader block;
+    memcpy(block.magic, HIGHSCORE_BLOCK_MAGIC, 4);
+    block.count = (uint32_t)count;
+    block.crc = Crc32(records, count * sizeof(HighscoreRecord));
+    block.headerCrc = Crc32(&block, offsetof(HighscoreBlockHeader, headerCrc));
+    return block;
+}
+
+// Appends records to buffer as blocks of up to HIGHSCORE_BLOCK_RECORDS
+static void AppendBlocks(vector<unsigned char>& buffer, const vector<HighscoreRecord>& records) {
+    for (size_t first = 0; first < records.size(); first += HIGHSCORE_BLOCK_RECORDS) {
+        size_t count = min(records.size() - first, (size_t)HIGHSCORE_BLOCK_RECORDS);
+        size_t bytes = count * sizeof(HighscoreRecord);
+        HighscoreBlockHeader block = MakeBlockHeader(&records[first], count);
+        buffer.insert(buffer.end(), (const unsigned char*)&block, (const unsigned char*)&block + sizeof(block));
+        buffer.insert(buffer.end(), (const unsigned char*)&records[first], (const unsigned char*)&records[first] + bytes);
+    }
+}
+
+// Calls visit(records, count) for every block after the file header that
+// checks out. In a version 2 file a block that doesn't (a torn append, a
+// damaged header or records) is skipped by scanning ahead byte by byte for
+// the next valid block header, so scores appended after a failed write
+// survive. Version 1 blocks have no magic to scan for, so reading stops at
+// a torn one. Returns false if anything was skipped.
+template <typename Visit>
+static bool ReadHighscoreBlocks(const unsigned char* base, size_t size, uint32_t version,
+    const string& path, Visit visit)
 {
+    bool clean = true;
+    size_t at = sizeof(HighscoreFileHeader);
+
+    if (version < 2) {
+        while (at < size) {
+            HighscoreBlockHeaderV1 block;
+            if (size - at < sizeof(block)) return false;
+            memcpy(&block, base + at, sizeof(block));
+            at += sizeof(block);
+            size_t bytes = (size_t)block.count * sizeof(HighscoreRecord);
+            if (size - at < bytes) return false;    // torn append
+            if (Crc32(base + at, bytes) == block.crc) visit(base + at, block.count);
+            else {
+                cout << path << ": skipped a damaged block of " << block.count << " scores\n";
+                clean = false;
+            }
+            at += bytes;
+        }
+        return clean;
+    }
+
+    size_t badFrom = 0;
+    bool skipping = false;
+    while (at < size) {
+        HighscoreBlockHeader block;
+        bool ok = size - at >= sizeof(block);
+        size_t bytes = 0;
+        if (ok) {
+            memcpy(&block, base + at, sizeof(block));
+            bytes = (size_t)block.count * sizeof(HighscoreRecord);
+            ok = memcmp(block.magic, HIGHSCORE_BLOCK_MAGIC, 4) == 0
+                && block.headerCrc == Crc32(&block, offsetof(HighscoreBlockHeader, headerCrc))
+                && block.count >= 1 && block.count <= (uint32_t)HIGHSCORE_BLOCK_RECORDS
+                && size - at - sizeof(block) >= bytes
+                && Crc32(base + at + sizeof(block), bytes) == block.crc;
+        }
+        if (!ok) {
+            if (!skipping) badFrom = at;
+            skipping = true;
+            clean = false;
+            // The next magic, if any, is where the next block might start
+            const void* next = at + 1 < size ? memchr(base + at + 1, HIGHSCORE_BLOCK_MAGIC[0], size - at - 1) : nullptr;
+            at = next ? (size_t)((const unsigned char*)next - base) : size;
+            continue;
+        }
+        if (skipping) {
+            cout << path << ": skipped " << at - badFrom << " damaged bytes at offset " << badFrom << "\n";
+            skipping = false;
+        }
+        visit(base + at + sizeof(block), block.count);
+        at += sizeof(block) + bytes;
+    }
+    if (skipping) cout << path << ": skipped " << size - badFrom << " damaged bytes at offset " << badFrom << "\n";
+    return clean;
+}
+
+// -------------------- HighscoreWriter --------------------
+// Drops 0-score rows (written at name entry) of names that have a real
+// score, keeping the rest in order; the same rule as HighscoreLog::compact()
+static void DropNameEntryRecords(vector<HighscoreRecord>& records) {
+    unordered_map<string, int> best;
+    for (const HighscoreRecord& r : records) {
+        int& b = best[r.name];     // rows from ToRecord are NUL-terminated
+        b = max(b, (int)r.score);
+    }
+    records.erase(remove_if(records.begin(), records.end(), [&](const HighscoreRecord& r) {
+        return r.score == 0 && best[r.name] > 0;
+    }), records.end());
+}
+
+HighscoreWriter::~HighscoreWriter() {
+    stop();
+}
+
+void HighscoreWriter::start(const string& filePath, vector<HighscoreRecord> fileRows) {
+    stop();
+    path = filePath;
+    rows = move(fileRows);
+    stopping = false;
+    worker = thread([this]() { run(); });
+}
+
+void HighscoreWriter::stop() {
+    if (!worker.joinable()) return;
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_one();
+    ScopedIoTimer io;   // whatever is still queued is written before the join returns
+    worker.join();
+    out.close();
+}
+
+void HighscoreWriter::append(const HighscoreRecord& record) {
+    unique_lock<mutex> guard(lock);
+    if (queued.size() >= HIGHSCORE_QUEUE_LIMIT) {
+        // Only when storage can't keep up at all; a frame hitch beats losing scores
+        ScopedIoTimer io;
+        progress.wait(guard, [this]() { return queued.size() < HIGHSCORE_QUEUE_LIMIT; });
+    }
+    queued.push_back(record);
+    guard.unlock();
+    wake.notify_one();
+}
+
+void HighscoreWriter::compact() {
+    {
+        lock_guard<mutex> guard(lock);
+        compactQueued = true;
+    }
+    wake.notify_one();
+}
+
+void HighscoreWriter::flush() {
+    if (!worker.joinable()) return;
+    ScopedIoTimer io;
+    unique_lock<mutex> guard(lock);
+    progress.wait(guard, [this]() { return queued.empty() && !compactQueued && !busy; });
+}
+
+size_t HighscoreWriter::pending() {
+    lock_guard<mutex> guard(lock);
+    return queued.size() + (compactQueued ? 1 : 0);
+}
+
+void HighscoreWriter::run() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        wake.wait(guard, [this]() { return stopping || compactQueued || !queued.empty(); });
+        if (!compactQueued && queued.empty()) break;    // stopping with nothing left
+
+        // Take everything queued so far; add() keeps queueing meanwhile
+        bool doCompact = compactQueued;
+        vector<HighscoreRecord> batch;
+        batch.swap(queued);
+        compactQueued = false;
+        busy = true;
+        guard.unlock();
+        progress.notify_all();
+
+        // A compaction writes the batch along with everything else
+        rows.insert(rows.end(), batch.begin(), batch.end());
+        bool ok = true;
+        if (doCompact) {
+            DropNameEntryRecords(rows);
+            ok = writeAll(rows);
+        }
+        else if (!batch.empty()) ok = writeAppend(batch);
+        if (!ok) failed++;
+
+        guard.lock();
+        busy = false;
+        progress.notify_all();
+    }
+}
+
+bool HighscoreWriter::writeAppend(const vector<HighscoreRecord>& records) {
+    if (!out.isOpen() && !out.open(path)) {
+        cout << "Could not open " << path << " for writing\n";
+        return false;
+    }
+    vector<unsigned char> buffer;
+    AppendBlocks(buffer, records);
+    if (out.append(buffer.data(), buffer.size())) return true;
+    cout << "Could not save " << records.size() << " score(s) to " << path << "\n";
+    return false;
+}
+
+bool HighscoreWriter::writeAll(const vector<HighscoreRecord>& records) {
+    out.close();    // reopened by the next append; Windows can't replace an open file
+
+    HighscoreFileHeader h = MakeHighscoreHeader();
+    vector<unsigned char> buffer((unsigned char*)&h, (unsigned char*)&h + sizeof(h));
+    buffer.reserve(sizeof(h) + records.size() * sizeof(HighscoreRecord)
+        + (records.size() / HIGHSCORE_BLOCK_RECORDS + 1) * sizeof(HighscoreBlockHeader));
+    AppendBlocks(buffer, records);
+
+    if (WriteFileAtomic(path, buffer.data(), buffer.size())) return true;
+    cout << "Could not compact " << path << "\n";
+    return false;
+}
+
+// Old text format, one "name score [time]" line per row. A line is only
+// trusted once its newline made it to disk.
+static bool ReadTextHighscores(const string& path, vector<HighscoreEntry>& out) {
+    ifstream file(path, ios::binary);
+    if (!file.is_open()) return false;
+
+    stringstream buffer;
+    buffer << file.rdbuf();
+    string data = buffer.str();
+
+    size_t start = 0;
+    while (start < data.size()) {
+        size_t end = data.find('\n', start);
+        if (end == string::npos) break;
+
+        string line = data.substr(start, end - start);
+        start = end + 1;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        istringstream in(line);
+        HighscoreEntry e;
+        bool ok = (bool)(in >> e.name >> e.score);
+        if (ok && !(in >> ws).eof()) ok = (in >> e.playedAt) && (in >> ws).eof();
+        if (ok) out.push_back(e);
+    }
+    return true;
+}
+
+// Decodes every block straight from the mapping. damaged is set for a bad
+// CRC, a torn block or an old version so the caller can rewrite the file.
+bool HighscoreLog::readBinary(const MappedFile& file, bool& damaged) {
+    const unsigned char* base = file.bytes();
+    size_t size = file.size();
+    damaged = false;
+
+    HighscoreFileHeader h;
+    if (size < sizeof(h)) { damaged = true; return false; }
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, HIGHSCORE_MAGIC, 4) != 0 ||
+        h.headerCrc != Crc32(&h, offsetof(HighscoreFileHeader, headerCrc))) {
+        cout << path << " is not a highscore file\n";
+        damaged = true;
+        return false;
+    }
+    if (h.version > HIGHSCORE_VERSION || h.recordSize != sizeof(HighscoreRecord)) {
+        cout << path << " was written by a newer version; scores won't be saved\n";
+        writable = false;
+        return false;
+    }
+
+    bool clean = ReadHighscoreBlocks(base, size, h.version, path, [&](const unsigned char* records, uint32_t count) {
+        for (uint32_t i = 0; i < count; i++) {
+            HighscoreRecord r;
+            memcpy(&r, records + i * sizeof(HighscoreRecord), sizeof(r));
+            r.name[HIGHSCORE_NAME_BYTES - 1] = '\0';
+            if (r.name[0] == '\0') continue;
+            entries.push_back({ string(r.name), r.score, r.playedAt });
+        }
+    });
+    // Older versions are rewritten in the current format
+    damaged = !clean || h.version < HIGHSCORE_VERSION;
+    return true;
+}
+
+bool HighscoreLog::load(const string& filePath, const string& textPath) {
+    ScopedIoTimer io;
+    writer.stop();
+    path = filePath;
+    entries.clear();
+    writable = true;
+    appendsSinceCompact = 0;
+
+    bool damaged = false;
+    {
+        MappedFile file;
+        if (file.open(path)) {
+            readBinary(file, damaged);
+        }
+        else if (ReadTextHighscores(textPath, entries)) {
+            cout << "Importing " << textPath << " into " << path << "\n";
+            damaged = true;
+        }
+        else {
+            entries.push_back({ "AAA", 3000 });
+            entries.push_back({ "BBB", 1500 });
+            entries.push_back({ "CCC", 900 });
+            damaged = true;
+        }
+    }   // unmapped here: the file can't be replaced while mapped on Windows
+
+    rebuildIndex();
+    if (readOnly) {
+        writable = false;
+        return true;
+    }
+    if (!writable) return false;
+
+    // Loading is off the frame already, so memory is cleaned here too
+    if (garbageRows() > (int)entries.size() / 2) damaged = dropNameEntryRows() || damaged;
+
+    vector<HighscoreRecord> records;
+    records.reserve(entries.size());
+    for (const auto& e : entries) records.push_back(ToRecord(e));
+    writer.start(path, move(records));
+
+    // Rewrite now so the next append doesn't land after a torn block
+    if (damaged) return compact();
+    return true;
+}
+
+bool HighscoreLog::add(const string& name, int score) {
+    HighscoreEntry e{ name, score, (long long)time(nullptr) };
+    entries.push_back(e);
+    board.insert(name, score);
+    if (indexEntry(e, (int)entries.size() - 1)) {
+        playerBoard.eraseBest(name);
+        playerBoard.insert(name, score);
+        names.update(name, score);
+    }
+    if (!writable) return false;
+
+    // Rewrites grow with the table, so space them out as it grows: O(1) amortised
+    int interval = max(HIGHSCORE_COMPACT_EVERY, (int)entries.size() / 2);
+    if (++appendsSinceCompact >= interval) return compact();
+
+    writer.append(ToRecord(e));
+    return true;
+}
+
+int HighscoreLog::garbageRows() const {
+    int garbage = 0;
+    for (const auto& e : entries)
+        if (e.score == 0 && bestScore(e.name) > 0) garbage++;
+    return garbage;
+}
+
+// O(1) here: the writer filters its own copy of the rows and rewrites the
+// file. Memory keeps the dropped rows until the next load.
+bool HighscoreLog::compact() {
+    if (!writable) return false;
+    writer.compact();
+    appendsSinceCompact = 0;
+    return true;
+}
+
+bool HighscoreLog::dropNameEntryRows() {
+    vector<HighscoreEntry> live;
+    live.reserve(entries.size());
+    for (const auto& e : entries)
+        if (e.score != 0 || bestScore(e.name) <= 0) live.push_back(e);
+    if (live.size() == entries.size()) return false;
+
+    // Row numbers shift when rows are dropped
+    entries.swap(live);
+    rebuildIndex();
+    return true;
+}
+
+// -------------------- External Sort --------------------
+static bool RecordBefore(const HighscoreRecord& a, const HighscoreRecord& b) {
+    return a.score > b.score;
+}
+
+// Reads one sorted run back in slices so memory stays bounded during the merge
+struct HighscoreRun {
+    ifstream file;
+    vector<HighscoreRecord> slice;
+    size_t next = 0;
+
+    bool refill() {
+        slice.resize(4096);
+        file.read((char*)slice.data(), slice.size() * sizeof(HighscoreRecord));
+        slice.resize((size_t)file.gcount() / sizeof(HighscoreRecord));
+        next = 0;
+        return !slice.empty();
+    }
+    bool empty() { return next >= slice.size() && !refill(); }
+    const HighscoreRecord& front() const { return slice[next]; }
+};
+
+bool SortHighscoreFilesExternal(const vector<string>& inPaths, const string& outPath, size_t runRecords, int threads) {
+    // Phase 1: sorted runs from every input. Each input is mapped, so only
+    // the current run is resident.
+    runRecords = max(runRecords, (size_t)HIGHSCORE_BLOCK_RECORDS);
+    vector<string> runPaths;
+    vector<HighscoreRecord> run;
+    run.reserve(runRecords);
+    size_t total = 0;
+
+    // Every write is checked: a full disk must fail the sort, not truncate it
+    auto flushRun = [&]() {
+        if (run.empty()) return true;
+        ParallelMergeSort(run, RecordBefore, threads);
+        string runPath = outPath + ".run" + to_string(runPaths.size());
+        runPaths.push_back(runPath);
+        ofstream out(runPath, ios::binary | ios::trunc);
+        out.write((const char*)run.data(), run.size() * sizeof(HighscoreRecord));
+        out.close();
+        total += run.size();
+        run.clear();
+        if (!out.fail()) return true;
+        cout << "Could not write " << runPath << "\n";
+        return false;
+    };
+
+    bool ok = true;
+    for (size_t f = 0; f < inPaths.size() && ok; f++) {
+        const string& inPath = inPaths[f];
+        MappedFile in;
+        HighscoreFileHeader h;
+        if (!in.open(inPath) || in.size() < sizeof(h)) {
+            cout << "Could not open " << inPath << "\n";
+            ok = false;
+            break;
+        }
+        memcpy(&h, in.bytes(), sizeof(h));
+        if (memcmp(h.magic, HIGHSCORE_MAGIC, 4) != 0 ||
+            h.headerCrc != Crc32(&h, offsetof(HighscoreFileHeader, headerCrc))) {
+            cout << inPath << " is not a highscore file\n";
+            ok = false;
+            break;
+        }
+        // Same rules as HighscoreLog::load, so the output loads back to the same rows
+        if (h.version > HIGHSCORE_VERSION || h.recordSize != sizeof(HighscoreRecord)) {
+            cout << inPath << " was written by a newer version, skipped\n";
+            continue;
+        }
+        ReadHighscoreBlocks(in.bytes(), in.size(), h.version, inPath, [&](const unsigned char* records, uint32_t count) {
+            for (uint32_t i = 0; i < count && ok; i++) {
+                HighscoreRecord r;
+                memcpy(&r, records + i * sizeof(r), sizeof(r));
+                r.name[HIGHSCORE_NAME_BYTES - 1] = '\0';
+                if (r.name[0] == '\0') continue;
+                run.push_back(r);
+                if (run.size() == runRecords) ok = flushRun();
+            }
+        });
+    }
+    ok = ok && flushRun();
+
+    // Phase 2: one k-way merge over the runs of every input. Ties go to the
+    // earlier run (earlier input, earlier in it), keeping the sort stable.
+    vector<HighscoreRun> runs(runPaths.size());
+    for (size_t i = 0; i < runs.size() && ok; i++) {
+        runs[i].file.open(runPaths[i], ios::binary);
+        ok = runs[i].file.is_open();
+    }
+
+    auto later = [&](int a, int b) {
+        const HighscoreRecord& ra = runs[a].front();
+        const HighscoreRecord& rb = runs[b].front();
+        if (ra.score != rb.score) return ra.score < rb.score;
+        return a > b;
+    };
+    priority_queue<int, vector<int>, decltype(later)> heap(later);
+    for (int i = 0; i < (int)runs.size() && ok; i++)
+        if (!runs[i].empty()) heap.push(i);
+
+    string tmpPath = outPath + ".tmp";
+    ofstream out;
+    if (ok) {
+        out.open(tmpPath, ios::binary | ios::trunc);
+        HighscoreFileHeader outHeader = MakeHighscoreHeader();
+        out.write((const char*)&outHeader, sizeof(outHeader));
+        ok = !out.fail();
+    }
+
+    vector<HighscoreRecord> block;
+    block.reserve(HIGHSCORE_BLOCK_RECORDS);
+    auto writeBlock = [&]() {
+        if (block.empty()) return true;
+        HighscoreBlockHeader bh = MakeBlockHeader(block.data(), block.size());
+        out.write((const char*)&bh, sizeof(bh));
+        out.write((const char*)block.data(), block.size() * sizeof(HighscoreRecord));
+        block.clear();
+        return !out.fail();
+    };
+
+    size_t written = 0;
+    while (ok && !heap.empty()) {
+        int r = heap.top();
+        heap.pop();
+        block.push_back(runs[r].front());
+        runs[r].next++;
+        if (!runs[r].empty()) heap.push(r);
+        if ((int)block.size() == HIGHSCORE_BLOCK_RECORDS) ok = writeBlock();
+        written++;
+    }
+    ok = ok && writeBlock();
+    if (out.is_open()) out.close();
+    ok = ok && !out.fail();
+
+    // A run that couldn't be read back in full would silently shorten the output
+    for (auto& r : runs) {
+        ok = ok && !r.file.bad();
+        r.file.close();
+    }
+    ok = ok && written == total;
+    for (const auto& p : runPaths) remove(p.c_str());
+
+    ok = ok && ReplaceFileAtomic(tmpPath, outPath);
+    if (ok) cout << "Sorted " << written << " scores from " << inPaths.size() << " file(s), "
+        << runPaths.size() << " runs, into " << outPath << "\n";
+    else {
+        remove(tmpPath.c_str());
+        cout << "Could not sort into " << outPath << "\n";
+    }
+    return ok;
+}
+
+int HighscoreLog::bestScore(const string& name) const {
+    auto it = players.find(name);
+    return it == players.end() ? -1 : it->second.best;
+}
+
+const PlayerStats* HighscoreLog::statsFor(const string& name) const {
+    auto it = players.find(name);
+    return it == players.end() ? nullptr : &it->second;
+}
+
+// -------------------- Draw Highscores --------------------
+HighscoreView MakeHighscoreView(const HighscoreLog& log, const string& player) {
+    HighscoreView view;
+    view.player = player;
+    const Leaderboard* boards[2] = { &log.board, &log.playerBoard };
+    for (int b = 0; b < 2; b++) {
+        view.top[b] = boards[b]->top(HIGHSCORE_SCREEN_ROWS);
+        view.rank[b] = boards[b]->rankOfPlayer(player);
+        if (view.rank[b] >= 0) view.rankScore[b] = boards[b]->at(view.rank[b]).score;
+    }
+    const PlayerStats* stats = log.statsFor(player);
+    if (stats) view.stats = *stats;
+    return view;
+}
+
+void DrawHighscoreScreen(int winW, int winH, Font font, const HighscoreView& view, bool byPlayer) {
     ClearBackground(BLACK);
+    int b = byPlayer ? 1 : 0;
 
-    const char* title = "HIGHSCORES";
+    const char* title = byPlayer ? "BEST PER PLAYER" : "HIGHSCORES";
     int titleFontSize = 40;
     Vector2 titleSize = MeasureTextEx(font, title, (float)titleFontSize, 4.0f);
     Vector2 titlePos = { (winW - titleSize.x) / 2.0f, 100.0f };
     DrawTextEx(font, title, titlePos, (float)titleFontSize, 4.0f, YELLOW);
 
-    if (!highscores.empty())
-        MergeSortHighscores(highscores, 0, highscores.size() - 1);
+    // Already in rank order: no sorting per frame
+    const vector<HighscoreEntry>& highscores = view.top[b];
 
     int scoreFontSize = 25;
     float startY = 200.0f;
     float lineHeight = 50.0f;
 
-    for (int i = 0; i < 3 && i < highscores.size(); i++) {
+    for (int i = 0; i < HIGHSCORE_SCREEN_ROWS && i < (int)highscores.size(); i++) {
         string line = to_string(i + 1) + ". " + highscores[i].name + " - " + to_string(highscores[i].score);
         Vector2 lineSize = MeasureTextEx(font, line.c_str(), (float)scoreFontSize, 2.0f);
         Vector2 linePos = { (winW - lineSize.x) / 2.0f, startY + i * lineHeight };
         DrawTextEx(font, line.c_str(), linePos, (float)scoreFontSize, 2.0f, WHITE);
     }
 
-    int playerRank = -1;
-    for (int i = 0; i < highscores.size(); i++) {
-        if (highscores[i].name == currentPlayer) {
-            playerRank = i + 1;
-            break;
-        }
-    }
+    int playerRank = view.rank[b] + 1;
 
-    if (playerRank != -1) {
-        string youLine = "You: " + to_string(playerRank) + " " + highscores[playerRank - 1].name + " - " + to_string(highscores[playerRank - 1].score);
+    if (playerRank > 0) {
+        string youLine = "You: " + to_string(playerRank) + " " + view.player + " - " + to_string(view.rankScore[b]);
         Vector2 youSize = MeasureTextEx(font, youLine.c_str(), (float)scoreFontSize, 2.0f);
         Vector2 youPos = { (winW - youSize.x) / 2.0f, startY + 3 * lineHeight + 20 };
         DrawTextEx(font, youLine.c_str(), youPos, (float)scoreFontSize, 2.0f, GREEN);
     }
 
-    const char* prompt = "Press ENTER or ESCAPE to return";
+    const PlayerStats* stats = &view.stats;
+    if (stats->games > 0) {
+        string statLine = "Games " + to_string(stats->games) + "   Best " + to_string(stats->best)
+            + "   Avg " + to_string((int)(stats->mean() + 0.5));
+        Vector2 statSize = MeasureTextEx(font, statLine.c_str(), 18, 2.0f);
+        Vector2 statPos = { (winW - statSize.x) / 2.0f, startY + 4 * lineHeight + 20 };
+        DrawTextEx(font, statLine.c_str(), statPos, 18, 2.0f, LIGHTGRAY);
+    }
+
+    const char* prompt = byPlayer ? "TAB: all scores   ENTER or ESCAPE to return"
+                                  : "TAB: best per player   ENTER or ESCAPE to return";
     Vector2 promptSize = MeasureTextEx(font, prompt, 15, 2.0f);
     Vector2 promptPos = { (winW - promptSize.x) / 2.0f, winH - 60.0f };
     DrawTextEx(font, prompt, promptPos, 15, 2.0f, LIGHTGRAY);
 }
+
+// -------------------- Benchmark --------------------
+void BenchmarkLeaderboard(int n) {
+    mt19937 rng(1234);
+    uniform_int_distribution<int> scoreDist(0, 100000);
+    int players = max(1, n / 10);
+    vector<string> names(players);
+    for (int i = 0; i < players; i++) names[i] = "P" + to_string(i);
+
+    using Clock = chrono::steady_clock;
+    auto ms = [](Clock::time_point a, Clock::time_point b) { return chrono::duration<double, milli>(b - a).count(); };
+
+    Leaderboard board;
+    board.reserve(n);
+    vector<HighscoreEntry> list;
+    list.reserve(n);
+
+    auto t0 = Clock::now();
+    for (int i = 0; i < n; i++) {
+        int score = scoreDist(rng);
+        const string& name = names[rng() % players];
+        board.insert(name, score);
+        list.push_back({ name, score });
+    }
+    auto tInsert = Clock::now();
+
+    // Loading a saved table builds in bulk
+    Leaderboard bulk;
+    bulk.build(list);
+    auto tBuild = Clock::now();
+
+    const int queries = 100000;
+    long long checksum = 0;
+    auto t1 = Clock::now();
+    for (int i = 0; i < queries; i++) {
+        checksum += board.rankOfPlayer(names[rng() % players]);
+        checksum += board.top(3)[0].score;
+    }
+    auto t2 = Clock::now();
+
+    // What the highscore screen used to do every frame, then the parallel version
+    vector<HighscoreEntry> copy = list;
+    auto t2b = Clock::now();
+    MergeSortHighscores(list, 0, (int)list.size() - 1);
+    auto t3 = Clock::now();
+    SortHighscores(copy);
+    auto t4 = Clock::now();
+
+    bool same = true;
+    for (int i = 0; i < 10 && i < n; i++)
+        same = same && board.at(i).score == list[i].score && board.at(i).name == list[i].name
+            && bulk.at(i).score == list[i].score && bulk.at(i).name == list[i].name
+            && copy[i].name == list[i].name;
+
+    cout << "Leaderboard, " << n << " entries:\n"
+        << "  insert one by one   " << ms(t0, tInsert) << " ms (" << ms(t0, tInsert) * 1e6 / n << " ns each)\n"
+        << "  bulk build (load)   " << ms(tInsert, tBuild) << " ms\n"
+        << "  rank + top 3 query  " << ms(t1, t2) * 1e6 / queries << " ns\n"
+        << "  one merge sort      " << ms(t2b, t3) << " ms\n"
+        << "  parallel merge sort " << ms(t3, t4) << " ms (" << thread::hardware_concurrency() << " threads)\n"
+        << "  top 10 matches sort " << (same ? "yes" : "NO") << " (" << checksum % 10 << ")\n";
+}
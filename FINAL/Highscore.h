@@ -5,31 +5,216 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <unordered_map>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "raylib.h"
+#include "Leaderboard.h"
+#include "NameIndex.h"
+#include "FileIO.h"
 #include<string>
 #include <vector>
 
 using namespace std;
 
-struct HighscoreEntry {
-    string name;
-    int score;
-};
-
-
-void Merge(vector<HighscoreEntry>& hs, int left, int mid, int right);
 void MergeSortHighscores(vector<HighscoreEntry>& hs, int left, int right);
 
 // File I/O
 void LoadHighscores(vector<HighscoreEntry>& highscores);
-void SaveHighscores(const vector<HighscoreEntry>& highscores);
+void SaveHighscores(const vector<HighscoreEntry>& highscores);   // full rewrite, temp file + rename
+
+// -------------------- Binary Highscore File --------------------
+// highscores.bin: a header, then blocks of fixed-size records, each block
+// with its own CRC. The whole file is mapped once on load and decoded block
+// by block; a block that fails its CRC loses only its own records.
+//
+//   HighscoreFileHeader
+//   { HighscoreBlockHeader, HighscoreRecord[count] } ...
+//
+// Block headers start with a magic and carry a CRC of their own, so after a
+// torn or damaged block the reader scans ahead for the next block that checks
+// out instead of giving up on the rest of the file. Version 1 files (8-byte
+// block headers, no magic) are still read and are rewritten as version 2.
+//
+// A newer version than HIGHSCORE_VERSION is left untouched (scores are kept
+// in memory only). An old highscores.txt ("name score [time]" lines) is
+// imported when there is no .bin yet.
+const char HIGHSCORE_MAGIC[4] = { 'P', 'H', 'S', 'C' };
+const char HIGHSCORE_BLOCK_MAGIC[4] = { 'H', 'S', 'B', 'K' };
+const uint32_t HIGHSCORE_VERSION = 2;
+const int HIGHSCORE_NAME_BYTES = 20;        // NUL padded, longer names are cut
+const int HIGHSCORE_BLOCK_RECORDS = 1024;   // most records in one block
+
+struct HighscoreFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t headerCrc;                     // of the bytes before it
+};
+
+struct HighscoreBlockHeader {
+    char magic[4];                          // HIGHSCORE_BLOCK_MAGIC
+    uint32_t count;                         // records that follow, 1..HIGHSCORE_BLOCK_RECORDS
+    uint32_t crc;                           // of those records
+    uint32_t headerCrc;                     // of the bytes before it
+};
+
+struct HighscoreBlockHeaderV1 {
+    uint32_t count;
+    uint32_t crc;
+};
+
+struct HighscoreRecord {
+    char name[HIGHSCORE_NAME_BYTES];
+    int32_t score;
+    int64_t playedAt;                       // unix time, 0 if unknown
+};
+
+static_assert(sizeof(HighscoreFileHeader) == 16, "header layout is part of the file format");
+static_assert(sizeof(HighscoreBlockHeader) == 16, "block layout is part of the file format");
+static_assert(sizeof(HighscoreBlockHeaderV1) == 8, "block layout is part of the file format");
+static_assert(sizeof(HighscoreRecord) == 32, "record layout is part of the file format");
+
+// -------------------- Append-only Log --------------------
+// Saving a score appends a block with a single synced write instead of
+// rewriting the file, so a crash loses at most the scores in that block; a
+// torn block is skipped on load, along with nothing after it. The file is rewritten (compacted: temp file,
+// sync, rename) on the writer thread after HIGHSCORE_COMPACT_EVERY appends,
+// or half the table size for big tables, dropping the 0-score rows written
+// at name entry once that name has a real score.
+const int HIGHSCORE_COMPACT_EVERY = 64;
+
+// -------------------- Background Writer --------------------
+// Does a HighscoreLog's disk I/O on its own thread so no frame waits on
+// storage. Records wait in a bounded queue; each time the thread wakes it
+// writes everything queued as one append and one sync. The thread keeps its
+// own copy of the file's rows, so compact() only sets a flag: filtering and
+// rewriting the table costs the caller nothing however big it is.
+// Errors are reported on cout from the writer thread.
+const size_t HIGHSCORE_QUEUE_LIMIT = 1024;  // append() waits while this many records are queued
+
+class HighscoreWriter {
+public:
+    ~HighscoreWriter();
+
+    void start(const string& filePath, vector<HighscoreRecord> fileRows);
+    void stop();                                // writes everything queued first
+
+    void append(const HighscoreRecord& record);
+    void compact();                             // rewrite without the name-entry rows
+    void flush();                               // waits until everything queued is on disk
+
+    size_t pending();                           // records not yet written
+    int failures() const { return failed.load(); }
+
+private:
+    string path;
+    thread worker;
+    mutex lock;
+    condition_variable wake;                    // work queued or stopping
+    condition_variable progress;                // a batch finished or room freed
+    vector<HighscoreRecord> queued;
+    bool compactQueued = false;
+    bool busy = false;
+    bool stopping = false;
+    atomic<int> failed{ 0 };
+
+    AppendFile out;                             // writer thread only
+    vector<HighscoreRecord> rows;               // writer thread only: what the file holds
+
+    void run();
+    bool writeAppend(const vector<HighscoreRecord>& records);
+    bool writeAll(const vector<HighscoreRecord>& records);
+};
+
+// -------------------- Player Stats --------------------
+// Aggregated per name and kept current as scores come in, so per-player
+// queries never scan the log. 0-score rows (name entry) only register the
+// name; they don't count as games.
+struct PlayerStats {
+    int best = 0;
+    int games = 0;
+    long long total = 0;
+    long long lastPlayed = 0;   // unix time, 0 if only old rows without a time
+    int bestRow = -1;           // log row that set best; earlier row wins ties
+
+    double mean() const { return games ? (double)total / games : 0.0; }
+};
+
+class HighscoreLog {
+public:
+    // Set before load() when another process (a leaderboard server) owns the
+    // file: it is read but never written, and add() only updates memory
+    bool readOnly = false;
+
+    vector<HighscoreEntry> entries;             // every row, in log order; name-entry rows
+                                                // that compaction dropped go at the next load
+    unordered_map<string, PlayerStats> players; // name -> stats, rebuilt on load
+    Leaderboard board;                          // entries in rank order, rebuilt on load
+    Leaderboard playerBoard;                    // one entry per player: their best
+    NameIndex names;                            // player names for prefix search
+
+    ~HighscoreLog();
+
+    bool load(const string& filePath = "highscores.bin", const string& textPath = "highscores.txt");
+    bool add(const string& name, int score);    // queues the write; returns at once
+    bool compact();
+    void flush() { writer.flush(); }            // blocks until every score is on disk
+    size_t pendingWrites() { return writer.pending(); }
+
+    int bestScore(const string& name) const;   // -1 if unknown
+    const PlayerStats* statsFor(const string& name) const;
+    vector<HighscoreEntry> topPlayers(int k) const { return playerBoard.top(k); }
+    int playerRank(const string& name) const { return playerBoard.rankOfPlayer(name); }
+    int garbageRows() const;                   // rows compaction would drop
+
+private:
+    string path;
+    HighscoreWriter writer;
+    bool writable = true;                   // false for a file from a newer version
+    int appendsSinceCompact = 0;
+
+    bool readBinary(const MappedFile& file, bool& damaged);
+    bool dropNameEntryRows();               // in memory; true if any went
+
+    bool indexEntry(const HighscoreEntry& e, int row);   // true if it is a new best
+    void rebuildIndex();
+};
+
+// Sorting: parallel merge sort, highest first (threads = 0: one per core)
+void SortHighscores(vector<HighscoreEntry>& hs, int threads = 0);
+
+// Merges highscore files too big for memory (e.g. many kiosks' archives)
+// into one in rank order: each input is cut into sorted runs of runRecords
+// records in temporary files, then one k-way merge over all the runs writes
+// outPath (same format). Rows are kept or skipped as HighscoreLog::load
+// would. Memory use stays around runRecords records.
+bool SortHighscoreFilesExternal(const vector<string>& inPaths, const string& outPath,
+    size_t runRecords = 1 << 20, int threads = 0);
+
+// -------------------- Highscore Screen --------------------
+// What the highscore screen shows, for both boards: [0] every score, [1]
+// each player's best. Taken from the local log, or sent by a leaderboard
+// server when one owns the file.
+const int HIGHSCORE_SCREEN_ROWS = 3;
+
+struct HighscoreView {
+    string player;
+    vector<HighscoreEntry> top[2];
+    int rank[2] = { -1, -1 };                   // player's 0-based rank, -1 if not on the board
+    int rankScore[2] = { 0, 0 };                // score at that rank
+    PlayerStats stats;
+};
+
+HighscoreView MakeHighscoreView(const HighscoreLog& log, const string& player);
 
-// Sorting
-void SortHighscores(vector<HighscoreEntry>& hs);
+// Draw: every score, or each player's best when byPlayer is set
+void DrawHighscoreScreen(int winW, int winH, Font font, const HighscoreView& view, bool byPlayer);
 
-// Draw
-void DrawHighscoreScreen(int winW, int winH, Font font,
-    vector<HighscoreEntry>& highscores,
-    const std::string& currentPlayer);
+// Times the leaderboard against re-sorting with n random entries
+void BenchmarkLeaderboard(int n);
 
 #endif // HIGHSCORE_H
@@ -0,0 +1,95 @@
+#include "JobSystem.h"
+#include <algorithm>
+
+using namespace std;
+
+// Set while a thread runs a job, so nested parallelFor() calls run inline
+static thread_local bool insideJob = false;
+
+// -------------------- JobSystem --------------------
+JobSystem::JobSystem(int threads) {
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+    threads = max(1, threads);
+    for (int i = 0; i < threads; i++) queues.emplace_back(new Queue());
+    for (int i = 1; i < threads; i++) workers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        lock_guard<mutex> lock(sleepLock);
+        quitting = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) t.join();
+}
+
+void JobSystem::parallelFor(int count, const function<void(int)>& job, int grain) {
+    if (count <= 0) return;
+    grain = max(1, grain);
+    if (workers.empty() || insideJob || count <= grain) {
+        for (int i = 0; i < count; i++) job(i);
+        return;
+    }
+
+    int jobs = (count + grain - 1) / grain;
+    pending = jobs;
+    for (int j = 0; j < jobs; j++) {
+        Queue& q = *queues[j % queues.size()];
+        lock_guard<mutex> lock(q.lock);
+        q.jobs.push_back({ &job, j * grain, min(count, (j + 1) * grain) });
+    }
+    {
+        lock_guard<mutex> lock(sleepLock);
+        queued += jobs;
+    }
+    wake.notify_all();
+
+    // Work until every job is done, including ones other threads are still running
+    Job next;
+    while (pending > 0) {
+        if (take(0, next)) run(next);
+        else this_thread::yield();
+    }
+}
+
+// Own queue from the back, then the others' from the front
+bool JobSystem::take(int self, Job& out) {
+    int n = (int)queues.size();
+    for (int k = 0; k < n; k++) {
+        Queue& q = *queues[(self + k) % n];
+        lock_guard<mutex> lock(q.lock);
+        if (q.jobs.empty()) continue;
+        if (k == 0) {
+            out = q.jobs.back();
+            q.jobs.pop_back();
+        }
+        else {
+            out = q.jobs.front();
+            q.jobs.pop_front();
+            stolenJobs++;
+        }
+        queued--;
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::run(const Job& job) {
+    insideJob = true;
+    for (int i = job.begin; i < job.end; i++) (*job.fn)(i);
+    insideJob = false;
+    pending--;
+}
+
+void JobSystem::workerLoop(int self) {
+    Job next;
+    for (;;) {
+        if (take(self, next)) {
+            run(next);
+            continue;
+        }
+        unique_lock<mutex> lock(sleepLock);
+        wake.wait(lock, [this]() { return quitting || queued > 0; });
+        if (quitting) return;
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+using namespace std;
+
+// -------------------- Job System --------------------
+// A small work-stealing pool. parallelFor() cuts a range into jobs and deals
+// them round-robin onto one queue per thread (the calling thread has queue
+// 0 and works too). Each thread takes from the back of its own queue and,
+// once that is empty, steals from the front of the others', so an uneven
+// range still finishes together. parallelFor() returns when every job has
+// run; a parallelFor() from inside a job runs inline. Only one thread (e.g.
+// the game loop) hands out work at a time.
+//
+// Jobs must not depend on which thread runs them or in what order: callers
+// that need the same result for any thread count give each index its own
+// output and combine them afterwards, in index order.
+class JobSystem {
+public:
+    explicit JobSystem(int threads = 0);            // 0 = one per core
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    int threadCount() const { return (int)queues.size(); }
+
+    // job(i) for every i in [0, count), in jobs of up to grain indices
+    void parallelFor(int count, const function<void(int)>& job, int grain = 1);
+
+    long long stolen() const { return stolenJobs; } // jobs run by a thread other than the one dealt them
+
+private:
+    struct Job {
+        const function<void(int)>* fn;
+        int begin, end;
+    };
+    struct Queue {
+        mutex lock;
+        deque<Job> jobs;
+    };
+
+    vector<unique_ptr<Queue>> queues;
+    vector<thread> workers;
+    mutex sleepLock;
+    condition_variable wake;
+    atomic<int> queued{ 0 };            // jobs in the queues
+    atomic<int> pending{ 0 };           // jobs of the current parallelFor not finished
+    atomic<long long> stolenJobs{ 0 };
+    bool quitting = false;
+
+    bool take(int self, Job& out);
+    void run(const Job& job);
+    void workerLoop(int self);
+};
+
+#endif // JOB_SYSTEM_H
@@ -0,0 +1,205 @@
+#include "Leaderboard.h"
+#include "ParallelSort.h"
+#include <algorithm>
+
+using namespace std;
+
+// -------------------- Leaderboard --------------------
+void Leaderboard::clear() {
+    nodes.clear();
+    names.clear();
+    nameIds.clear();
+    bestNode.clear();
+    root = -1;
+}
+
+void Leaderboard::reserve(size_t n) {
+    nodes.reserve(n);
+}
+
+int Leaderboard::internName(const string& name) {
+    auto it = nameIds.find(name);
+    if (it != nameIds.end()) return it->second;
+    int nameId = (int)names.size();
+    nameIds[name] = nameId;
+    names.push_back(name);
+    bestNode.push_back(-1);
+    return nameId;
+}
+
+// xorshift32: cheap heap priorities
+uint32_t Leaderboard::nextPriority() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+
+void Leaderboard::insert(const string& name, int score) {
+    int nameId = internName(name);
+
+    Node node;
+    node.score = score;
+    node.nameId = nameId;
+    node.priority = nextPriority();
+    nodes.push_back(node);
+    int n = (int)nodes.size() - 1;
+    root = insertAt(root, n);
+
+    // A tie never beats the earlier entry, matching the rank order
+    if (bestNode[nameId] < 0 || score > nodes[bestNode[nameId]].score) bestNode[nameId] = n;
+}
+
+void Leaderboard::build(const vector<HighscoreEntry>& entries) {
+    clear();
+    nodes.resize(entries.size());
+    for (int i = 0; i < (int)entries.size(); i++) {
+        Node& node = nodes[i];
+        node.score = entries[i].score;
+        node.nameId = internName(entries[i].name);
+        node.priority = nextPriority();
+        int& best = bestNode[node.nameId];
+        if (best < 0 || node.score > nodes[best].score) best = i;
+    }
+
+    vector<int> order(nodes.size());
+    for (int i = 0; i < (int)order.size(); i++) order[i] = i;
+    ParallelMergeSort(order, [this](int a, int b) { return before(a, b); });
+
+    // Cartesian tree over the ranked order: the stack holds the right spine,
+    // so each node is pushed and popped once
+    vector<int> spine;
+    for (int n : order) {
+        int last = -1;
+        while (!spine.empty() && nodes[spine.back()].priority < nodes[n].priority) {
+            last = spine.back();
+            spine.pop_back();
+        }
+        nodes[n].left = last;
+        if (!spine.empty()) nodes[spine.back()].right = n;
+        spine.push_back(n);
+    }
+    root = spine.empty() ? -1 : spine[0];
+
+    // Subtree sizes, children before parents
+    vector<int> post, stack;
+    if (root >= 0) stack.push_back(root);
+    while (!stack.empty()) {
+        int n = stack.back();
+        stack.pop_back();
+        post.push_back(n);
+        if (nodes[n].left >= 0) stack.push_back(nodes[n].left);
+        if (nodes[n].right >= 0) stack.push_back(nodes[n].right);
+    }
+    for (int i = (int)post.size() - 1; i >= 0; i--) update(post[i]);
+}
+
+// Binary-search-tree insert, rotating the new node up while its priority wins
+int Leaderboard::insertAt(int at, int n) {
+    if (at < 0) return n;
+    if (before(n, at)) {
+        nodes[at].left = insertAt(nodes[at].left, n);
+        if (nodes[nodes[at].left].priority > nodes[at].priority) {
+            int l = nodes[at].left;
+            nodes[at].left = nodes[l].right;
+            nodes[l].right = at;
+            update(at);
+            update(l);
+            return l;
+        }
+    }
+    else {
+        nodes[at].right = insertAt(nodes[at].right, n);
+        if (nodes[nodes[at].right].priority > nodes[at].priority) {
+            int r = nodes[at].right;
+            nodes[at].right = nodes[r].left;
+            nodes[r].left = at;
+            update(at);
+            update(r);
+            return r;
+        }
+    }
+    update(at);
+    return at;
+}
+
+bool Leaderboard::eraseBest(const string& name) {
+    auto it = nameIds.find(name);
+    if (it == nameIds.end() || bestNode[it->second] < 0) return false;
+    root = eraseAt(root, bestNode[it->second]);
+    bestNode[it->second] = -1;
+    return true;
+}
+
+int Leaderboard::eraseAt(int at, int n) {
+    if (at < 0) return -1;
+    if (at == n) return mergeNodes(nodes[at].left, nodes[at].right);
+    if (before(n, at)) nodes[at].left = eraseAt(nodes[at].left, n);
+    else nodes[at].right = eraseAt(nodes[at].right, n);
+    update(at);
+    return at;
+}
+
+// Joins two subtrees where every node of a ranks ahead of every node of b
+int Leaderboard::mergeNodes(int a, int b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (nodes[a].priority > nodes[b].priority) {
+        nodes[a].right = mergeNodes(nodes[a].right, b);
+        update(a);
+        return a;
+    }
+    nodes[b].left = mergeNodes(a, nodes[b].left);
+    update(b);
+    return b;
+}
+
+HighscoreEntry Leaderboard::at(int rank) const {
+    int n = root;
+    while (n >= 0) {
+        int leftCount = countOf(nodes[n].left);
+        if (rank < leftCount) n = nodes[n].left;
+        else if (rank == leftCount) return { names[nodes[n].nameId], nodes[n].score };
+        else { rank -= leftCount + 1; n = nodes[n].right; }
+    }
+    return { "", 0 };
+}
+
+// In-order walk that stops after k entries
+vector<HighscoreEntry> Leaderboard::top(int k) const {
+    vector<HighscoreEntry> out;
+    vector<int> stack;
+    int n = root;
+    while ((n >= 0 || !stack.empty()) && (int)out.size() < k) {
+        while (n >= 0) { stack.push_back(n); n = nodes[n].left; }
+        n = stack.back();
+        stack.pop_back();
+        out.push_back({ names[nodes[n].nameId], nodes[n].score });
+        n = nodes[n].right;
+    }
+    return out;
+}
+
+int Leaderboard::rankOfNode(int target) const {
+    int rank = 0, n = root;
+    while (n >= 0 && n != target) {
+        if (before(target, n)) n = nodes[n].left;
+        else { rank += countOf(nodes[n].left) + 1; n = nodes[n].right; }
+    }
+    return n < 0 ? -1 : rank + countOf(nodes[n].left);
+}
+
+int Leaderboard::rankOfPlayer(const string& name) const {
+    auto it = nameIds.find(name);
+    if (it == nameIds.end()) return -1;
+    return rankOfNode(bestNode[it->second]);
+}
+
+int Leaderboard::rankOfScore(int score) const {
+    int rank = 0, n = root;
+    while (n >= 0) {
+        if (nodes[n].score >= score) { rank += countOf(nodes[n].left) + 1; n = nodes[n].right; }
+        else n = nodes[n].left;
+    }
+    return rank;
+}
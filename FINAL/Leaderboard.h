@@ -0,0 +1,76 @@
+#pragma once
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+using namespace std;
+
+struct HighscoreEntry {
+    string name;
+    int score;
+    long long playedAt = 0;     // unix time, 0 for rows saved before it was logged
+};
+
+// -------------------- Leaderboard --------------------
+// Scores kept in rank order as they arrive (a treap with subtree sizes), so
+// the highscore screen never sorts: inserting, the entry at a rank and a
+// player's rank are O(log n), the top k is O(log n + k).
+// Order matches the merge sort it replaces: higher score first, earlier
+// entry first among equal scores.
+class Leaderboard {
+public:
+    void clear();
+    void reserve(size_t n);
+    void insert(const string& name, int score);
+    // Replaces the contents with a whole log at once: one sort and an O(n)
+    // build instead of n separate inserts
+    void build(const vector<HighscoreEntry>& entries);
+
+    // Removes the player's best entry; meant for boards holding one entry
+    // per player, where updating a score is erase + insert
+    bool eraseBest(const string& name);
+
+    int size() const { return countOf(root); }
+    HighscoreEntry at(int rank) const;              // 0-based
+    vector<HighscoreEntry> top(int k) const;
+
+    // 0-based rank of the player's best entry, -1 if the name never scored
+    int rankOfPlayer(const string& name) const;
+    // How many entries rank ahead of a new entry with this score
+    int rankOfScore(int score) const;
+
+private:
+    // Node index doubles as the insertion sequence number
+    struct Node {
+        int score;
+        int nameId;
+        int left = -1, right = -1;
+        int count = 1;          // nodes in this subtree
+        uint32_t priority;
+    };
+
+    vector<Node> nodes;
+    vector<string> names;                       // interned, one per player
+    unordered_map<string, int> nameIds;
+    vector<int> bestNode;                       // per name id: its best entry
+    int root = -1;
+    uint32_t rngState = 0x9E3779B9u;
+
+    bool before(int a, int b) const {
+        return nodes[a].score > nodes[b].score || (nodes[a].score == nodes[b].score && a < b);
+    }
+    int countOf(int n) const { return n < 0 ? 0 : nodes[n].count; }
+    void update(int n) { nodes[n].count = 1 + countOf(nodes[n].left) + countOf(nodes[n].right); }
+    int internName(const string& name);
+    uint32_t nextPriority();
+    int insertAt(int at, int n);
+    int eraseAt(int at, int n);
+    int mergeNodes(int a, int b);
+    int rankOfNode(int n) const;
+};
+
+#endif // LEADERBOARD_H
@@ -0,0 +1,492 @@
+#include "LeaderboardServer.h"
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+
+using namespace std;
+
+// -------------------- Encoding --------------------
+static void PutU8(vector<uint8_t>& b, uint8_t v) { b.push_back(v); }
+static void PutU16(vector<uint8_t>& b, uint16_t v) { b.push_back((uint8_t)v); b.push_back((uint8_t)(v >> 8)); }
+static void PutI32(vector<uint8_t>& b, int32_t v) {
+    uint32_t u = (uint32_t)v;
+    for (int i = 0; i < 4; i++) b.push_back((uint8_t)(u >> (8 * i)));
+}
+static void PutI64(vector<uint8_t>& b, int64_t v) {
+    uint64_t u = (uint64_t)v;
+    for (int i = 0; i < 8; i++) b.push_back((uint8_t)(u >> (8 * i)));
+}
+static void PutName(vector<uint8_t>& b, const string& name) {
+    size_t len = min(name.size(), (size_t)255);
+    PutU8(b, (uint8_t)len);
+    b.insert(b.end(), name.begin(), name.begin() + len);
+}
+
+// Not empty and no control characters; spaces are allowed
+static bool ValidName(const string& name) {
+    if (name.empty()) return false;
+    for (char c : name) {
+        if ((unsigned char)c < 32 || c == 127) return false;
+    }
+    return true;
+}
+
+// Bounds-checked reader; any overrun marks the message bad
+struct ByteReader {
+    const vector<uint8_t>& b;
+    size_t at = 0;
+    bool ok = true;
+
+    explicit ByteReader(const vector<uint8_t>& bytes, size_t start = 0) : b(bytes), at(start) {}
+
+    bool need(size_t n) { ok = ok && at <= b.size() && b.size() - at >= n; return ok; }
+    uint8_t u8() { return need(1) ? b[at++] : 0; }
+    uint16_t u16() {
+        if (!need(2)) return 0;
+        uint16_t v = (uint16_t)(b[at] | (b[at + 1] << 8));
+        at += 2;
+        return v;
+    }
+    int32_t i32() {
+        if (!need(4)) return 0;
+        uint32_t v = 0;
+        for (int i = 0; i < 4; i++) v |= (uint32_t)b[at + i] << (8 * i);
+        at += 4;
+        return (int32_t)v;
+    }
+    int64_t i64() {
+        if (!need(8)) return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < 8; i++) v |= (uint64_t)b[at + i] << (8 * i);
+        at += 8;
+        return (int64_t)v;
+    }
+    string name() {
+        uint8_t len = u8();
+        if (!need(len)) return "";
+        string s((const char*)&b[at], len);
+        at += len;
+        return s;
+    }
+    bool finished() const { return ok && at == b.size(); }
+};
+
+static bool SendMessage(NetSocket& s, const vector<uint8_t>& body) {
+    if (body.size() > 0xFFFF) return false;
+    uint8_t len[2] = { (uint8_t)body.size(), (uint8_t)(body.size() >> 8) };
+    return s.sendAll(len, 2) && (body.empty() || s.sendAll(body.data(), body.size()));
+}
+
+static bool RecvMessage(NetSocket& s, vector<uint8_t>& body) {
+    uint8_t len[2];
+    if (!s.recvAll(len, 2)) return false;
+    body.resize((size_t)len[0] | ((size_t)len[1] << 8));
+    return body.empty() || s.recvAll(body.data(), body.size());
+}
+
+// -------------------- LeaderboardServer --------------------
+LeaderboardServer::~LeaderboardServer() {
+    stop();
+}
+
+bool LeaderboardServer::start(HighscoreLog& scoreLog, int port) {
+    stop();
+    log = &scoreLog;
+    if (!listener.listen(port)) {
+        cout << "Leaderboard server could not listen on 127.0.0.1:" << port << "\n";
+        return false;
+    }
+    publishTop();
+    running = true;
+    acceptThread = thread([this]() { acceptLoop(); });
+    return true;
+}
+
+void LeaderboardServer::stop() {
+    if (!running.exchange(false)) return;
+    listener.shutdown();                // wakes accept()
+    if (acceptThread.joinable()) acceptThread.join();
+    listener.close();
+    reapClients(true);
+}
+
+void LeaderboardServer::acceptLoop() {
+    while (running) {
+        NetSocket socket = listener.accept();
+        if (!socket.isOpen()) {
+            if (!running) break;
+            continue;
+        }
+
+        reapClients(false);
+        unique_ptr<Client> client(new Client());
+        client->socket = move(socket);
+        Client* c = client.get();
+        client->worker = thread([this, c]() { serve(c); });
+
+        lock_guard<mutex> guard(clientsMutex);
+        clients.push_back(move(client));
+    }
+}
+
+// Joins finished connection threads; all = also hang up on live ones. The
+// socket is only shut down (which wakes a blocked recv) while its thread
+// runs, and closed when the Client is erased, after the join.
+void LeaderboardServer::reapClients(bool all) {
+    lock_guard<mutex> guard(clientsMutex);
+    for (size_t i = 0; i < clients.size();) {
+        Client* c = clients[i].get();
+        if (all) c->socket.shutdown();
+        if (all || c->done) {
+            if (c->worker.joinable()) c->worker.join();
+            clients.erase(clients.begin() + i);
+        }
+        else i++;
+    }
+}
+
+// Never closes the socket: reapClients() does, once this thread has ended
+void LeaderboardServer::serve(Client* client) {
+    vector<uint8_t> request, response;
+    while (running && RecvMessage(client->socket, request)) {
+        response.clear();
+        if (!handle(request, response)) {
+            response.clear();
+            PutU8(response, LB_BAD_REQUEST);
+        }
+        if (!SendMessage(client->socket, response)) break;
+    }
+    client->done = true;
+}
+
+bool LeaderboardServer::handle(const vector<uint8_t>& request, vector<uint8_t>& response) {
+    ByteReader in(request);
+    uint8_t op = in.u8();
+
+    if (op == LB_SUBMIT) {
+        string name = in.name();
+        int32_t score = in.i32();
+        if (!in.finished() || !ValidName(name)) return false;
+
+        int rank;
+        {
+            unique_lock<shared_mutex> lock(logLock);
+            log->add(name, score);
+            rank = log->board.rankOfScore(score) - 1;   // the new entry is last among equal scores
+        }
+        publishTop();
+        PutU8(response, LB_OK);
+        PutI32(response, rank);
+        return true;
+    }
+
+    if (op == LB_TOP) {
+        int k = min((int)in.u16(), LEADERBOARD_MAX_TOP);
+        if (!in.finished()) return false;
+
+        // Lock-free: the snapshot is immutable once published
+        shared_ptr<const vector<HighscoreEntry>> top = atomic_load(&topSnapshot);
+        int n = top ? min(k, (int)top->size()) : 0;
+        PutU8(response, LB_OK);
+        PutU16(response, (uint16_t)n);
+        for (int i = 0; i < n; i++) {
+            PutName(response, (*top)[i].name);
+            PutI32(response, (*top)[i].score);
+        }
+        return true;
+    }
+
+    if (op == LB_VIEW) {
+        string name = in.name();
+        if (!in.finished()) return false;
+
+        HighscoreView view;
+        {
+            shared_lock<shared_mutex> lock(logLock);
+            view = MakeHighscoreView(*log, name);
+        }
+        PutU8(response, LB_OK);
+        for (int b = 0; b < 2; b++) {
+            PutU16(response, (uint16_t)view.top[b].size());
+            for (const HighscoreEntry& e : view.top[b]) {
+                PutName(response, e.name);
+                PutI32(response, e.score);
+            }
+            PutI32(response, view.rank[b]);
+            PutI32(response, view.rankScore[b]);
+        }
+        PutI32(response, view.stats.games);
+        PutI32(response, view.stats.best);
+        PutI64(response, view.stats.total);
+        return true;
+    }
+
+    if (op == LB_RANK) {
+        string name = in.name();
+        if (!in.finished()) return false;
+
+        int rank, best;
+        {
+            shared_lock<shared_mutex> lock(logLock);
+            rank = log->board.rankOfPlayer(name);
+            best = log->bestScore(name);
+        }
+        PutU8(response, LB_OK);
+        PutI32(response, rank);
+        PutI32(response, best);
+        return true;
+    }
+    return false;
+}
+
+void LeaderboardServer::publishTop() {
+    shared_ptr<const vector<HighscoreEntry>> top;
+    {
+        shared_lock<shared_mutex> lock(logLock);
+        top = make_shared<const vector<HighscoreEntry>>(log->board.top(LEADERBOARD_MAX_TOP));
+    }
+    atomic_store(&topSnapshot, top);
+}
+
+// -------------------- LeaderboardClient --------------------
+bool LeaderboardClient::connect(int port) {
+    refused = false;
+    return socket.connect(port);
+}
+
+bool LeaderboardClient::call(const vector<uint8_t>& request, vector<uint8_t>& response) {
+    refused = false;
+    if (!socket.isOpen()) return false;
+    if (!SendMessage(socket, request) || !RecvMessage(socket, response)) {
+        socket.close();     // connection lost
+        return false;
+    }
+    refused = response.empty() || response[0] != LB_OK;
+    return !refused;
+}
+
+bool LeaderboardClient::submit(const string& name, int score, int& rank) {
+    vector<uint8_t> request, response;
+    PutU8(request, LB_SUBMIT);
+    PutName(request, name);
+    PutI32(request, score);
+    if (!call(request, response)) return false;
+
+    ByteReader in(response, 1);
+    rank = in.i32();
+    return in.finished();
+}
+
+bool LeaderboardClient::top(int k, vector<HighscoreEntry>& out) {
+    vector<uint8_t> request, response;
+    PutU8(request, LB_TOP);
+    PutU16(request, (uint16_t)max(0, min(k, 0xFFFF)));
+    if (!call(request, response)) return false;
+
+    ByteReader in(response, 1);
+    int n = in.u16();
+    out.clear();
+    for (int i = 0; i < n && in.ok; i++) {
+        HighscoreEntry e;
+        e.name = in.name();
+        e.score = in.i32();
+        out.push_back(e);
+    }
+    return in.finished();
+}
+
+bool LeaderboardClient::rank(const string& name, int& rank, int& best) {
+    vector<uint8_t> request, response;
+    PutU8(request, LB_RANK);
+    PutName(request, name);
+    if (!call(request, response)) return false;
+
+    ByteReader in(response, 1);
+    rank = in.i32();
+    best = in.i32();
+    return in.finished();
+}
+
+bool LeaderboardClient::view(const string& name, HighscoreView& out) {
+    vector<uint8_t> request, response;
+    PutU8(request, LB_VIEW);
+    PutName(request, name);
+    if (!call(request, response)) return false;
+
+    ByteReader in(response, 1);
+    out = HighscoreView();
+    out.player = name;
+    for (int b = 0; b < 2; b++) {
+        int n = in.u16();
+        for (int i = 0; i < n && in.ok; i++) {
+            HighscoreEntry e;
+            e.name = in.name();
+            e.score = in.i32();
+            out.top[b].push_back(e);
+        }
+        out.rank[b] = in.i32();
+        out.rankScore[b] = in.i32();
+    }
+    out.stats.games = in.i32();
+    out.stats.best = in.i32();
+    out.stats.total = in.i64();
+    return in.finished();
+}
+
+// -------------------- LeaderboardLink --------------------
+LeaderboardLink::~LeaderboardLink() {
+    stop();
+}
+
+bool LeaderboardLink::start(int serverPort) {
+    stop();
+    port = serverPort;
+    if (!client.connect(port)) return false;
+    stopping = false;
+    worker = thread([this]() { run(); });
+    return true;
+}
+
+vector<HighscoreEntry> LeaderboardLink::stop() {
+    if (worker.joinable()) {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        client.disconnect();
+    }
+    lock_guard<mutex> guard(lock);
+    vector<HighscoreEntry> unsent;
+    unsent.swap(queued);
+    return unsent;
+}
+
+void LeaderboardLink::submit(const string& name, int score) {
+    {
+        lock_guard<mutex> guard(lock);
+        queued.push_back({ name, score, (long long)time(nullptr) });
+    }
+    wake.notify_one();
+}
+
+void LeaderboardLink::requestView(const string& player) {
+    {
+        lock_guard<mutex> guard(lock);
+        viewPlayer = player;
+        viewWanted = true;
+    }
+    wake.notify_one();
+}
+
+bool LeaderboardLink::view(HighscoreView& out) {
+    lock_guard<mutex> guard(lock);
+    if (!hasView || latest.player != viewPlayer) return false;
+    out = latest;
+    return true;
+}
+
+// Sends the queue front to back; a score leaves the queue once the server
+// has taken it or refused it
+bool LeaderboardLink::sendQueued() {
+    for (;;) {
+        HighscoreEntry next;
+        {
+            lock_guard<mutex> guard(lock);
+            if (queued.empty()) return true;
+            next = queued.front();
+        }
+        int rank;
+        if (!client.isConnected() && !client.connect(port)) return false;
+        if (!client.submit(next.name, next.score, rank)) {
+            if (!client.rejected()) {
+                client.disconnect();
+                return false;
+            }
+            cout << "Leaderboard server refused the score " << next.score << " for '" << next.name << "', dropped\n";
+        }
+        lock_guard<mutex> guard(lock);
+        queued.erase(queued.begin());
+    }
+}
+
+void LeaderboardLink::run() {
+    unique_lock<mutex> guard(lock);
+    bool retrying = false;
+    while (true) {
+        auto due = [this]() { return stopping || !queued.empty() || viewWanted; };
+        if (retrying) wake.wait_for(guard, chrono::milliseconds(LEADERBOARD_RETRY_MS), [this]() { return stopping; });
+        else wake.wait(guard, due);
+        bool last = stopping;
+        bool refresh = viewWanted || (!queued.empty() && !viewPlayer.empty());
+        string player = viewPlayer;
+        viewWanted = false;
+        guard.unlock();
+
+        HighscoreView fresh;
+        bool ok = sendQueued();
+        bool gotView = false;
+        if (ok && refresh) {
+            gotView = (client.isConnected() || client.connect(port)) && client.view(player, fresh);
+            ok = gotView || client.rejected();  // a refused view isn't retried
+        }
+        retrying = !ok;
+
+        guard.lock();
+        if (gotView) {
+            latest = fresh;
+            hasView = true;
+        }
+        else if (refresh && !ok) viewWanted = true;     // try again with the next retry
+        if (last) return;
+    }
+}
+
+// -------------------- Command Line --------------------
+int RunLeaderboardTool(const string& command, const vector<string>& args) {
+    auto portArg = [&](size_t index) { return args.size() > index ? atoi(args[index].c_str()) : LEADERBOARD_PORT; };
+
+    if (command == "--leaderboard-server") {
+        HighscoreLog scoreLog;
+        scoreLog.load("highscores.bin", "highscores.txt");
+        LeaderboardServer server;
+        int port = portArg(0);
+        if (!server.start(scoreLog, port)) return 1;
+        cout << "Leaderboard server on 127.0.0.1:" << port << " (" << scoreLog.entries.size()
+            << " scores). Press Enter to stop.\n";
+        cin.get();
+        server.stop();
+        return 0;
+    }
+
+    LeaderboardClient client;
+    size_t portIndex = command == "--lb-submit" ? 2 : 1;
+    if (!client.connect(portArg(portIndex))) {
+        cout << "No leaderboard server on port " << portArg(portIndex) << "\n";
+        return 1;
+    }
+
+    if (command == "--lb-submit" && args.size() >= 2) {
+        int rank;
+        if (!client.submit(args[0], atoi(args[1].c_str()), rank)) return 1;
+        cout << "Rank " << rank + 1 << "\n";
+        return 0;
+    }
+    if (command == "--lb-top") {
+        vector<HighscoreEntry> top;
+        if (!client.top(args.empty() ? 10 : atoi(args[0].c_str()), top)) return 1;
+        for (size_t i = 0; i < top.size(); i++) cout << i + 1 << ". " << top[i].name << " " << top[i].score << "\n";
+        return 0;
+    }
+    if (command == "--lb-rank" && !args.empty()) {
+        int rank, best;
+        if (!client.rank(args[0], rank, best)) return 1;
+        if (rank < 0) cout << args[0] << " has no scores\n";
+        else cout << args[0] << ": rank " << rank + 1 << ", best " << best << "\n";
+        return 0;
+    }
+    cout << "Unknown leaderboard command " << command << "\n";
+    return 1;
+}
@@ -0,0 +1,152 @@
+#pragma once
+#ifndef LEADERBOARD_SERVER_H
+#define LEADERBOARD_SERVER_H
+
+#include "Highscore.h"
+#include "Net.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Leaderboard Protocol --------------------
+// Loopback TCP, little-endian. Every message is a u16 body length followed
+// by the body, so one connection can carry any number of requests.
+//
+//   request  : u8 op, payload
+//     LB_SUBMIT  u8 nameLen, name, i32 score        -> i32 rank of the new entry
+//     LB_TOP     u16 k                              -> u16 n, n x (u8 nameLen, name, i32 score)
+//     LB_RANK    u8 nameLen, name                   -> i32 rank (-1 if unknown), i32 best
+//     LB_VIEW    u8 nameLen, name                   -> the highscore screen for that player: for
+//                the all-scores board, then the best-per-player board, u16 n, n x (u8 nameLen,
+//                name, i32 score), i32 rank, i32 score at rank; then i32 games, i32 best, i64 total
+//   response : u8 status, payload (only when status is LB_OK)
+//
+// Names are any bytes but control characters (spaces are fine, as on the
+// name-entry screen); a request the server can't parse or accept gets
+// LB_BAD_REQUEST, and sending it again won't change that.
+//
+// Ranks are 0-based positions in the all-scores board, as on the highscore screen.
+const int LEADERBOARD_PORT = 47123;
+const int LEADERBOARD_MAX_TOP = 100;        // top-k requests are capped to this
+
+enum LeaderboardOp : uint8_t { LB_SUBMIT = 1, LB_TOP = 2, LB_RANK = 3, LB_VIEW = 4 };
+enum LeaderboardStatus : uint8_t { LB_OK = 0, LB_BAD_REQUEST = 1, LB_FAILED = 2 };
+
+// -------------------- Server --------------------
+// Serves one HighscoreLog to local clients, one thread per connection.
+// Submits take the log's lock exclusively and rank queries share it; top-k
+// reads don't lock at all: they copy an immutable snapshot that each submit
+// republishes. Each connection's socket belongs to the server's list: its
+// thread only reads and writes it, and the socket is closed after that
+// thread has been joined.
+class LeaderboardServer {
+public:
+    ~LeaderboardServer();
+
+    bool start(HighscoreLog& log, int port = LEADERBOARD_PORT);
+    void stop();
+    bool isRunning() const { return running.load(); }
+
+private:
+    struct Client {
+        NetSocket socket;
+        thread worker;
+        atomic<bool> done{ false };
+    };
+
+    HighscoreLog* log = nullptr;
+    NetSocket listener;
+    thread acceptThread;
+    atomic<bool> running{ false };
+
+    mutex clientsMutex;
+    vector<unique_ptr<Client>> clients;
+
+    shared_mutex logLock;
+    shared_ptr<const vector<HighscoreEntry>> topSnapshot;   // atomic_load / atomic_store only
+
+    void acceptLoop();
+    void serve(Client* client);
+    bool handle(const vector<uint8_t>& request, vector<uint8_t>& response);
+    void publishTop();
+    void reapClients(bool all);
+};
+
+// -------------------- Client --------------------
+class LeaderboardClient {
+public:
+    bool connect(int port = LEADERBOARD_PORT);
+    bool isConnected() const { return socket.isOpen(); }
+    void disconnect() { socket.close(); }
+
+    bool submit(const string& name, int score, int& rank);
+    bool top(int k, vector<HighscoreEntry>& out);
+    bool rank(const string& name, int& rank, int& best);
+    bool view(const string& name, HighscoreView& out);
+
+    // True when the last call reached the server and it answered with an
+    // error, as opposed to the connection failing
+    bool rejected() const { return refused; }
+
+private:
+    NetSocket socket;
+    bool refused = false;
+    bool call(const vector<uint8_t>& request, vector<uint8_t>& response);
+};
+
+// -------------------- Game Link --------------------
+// The game's side of a leaderboard server, on its own thread so no frame
+// waits on a socket. While the game is linked the server is the only
+// writer of highscores.bin: scores are queued here and sent in order, and
+// the highscore screen shows the view the server sends back. A score the
+// server can't reach yet stays queued and is retried every
+// LEADERBOARD_RETRY_MS; one the server refuses is logged and dropped, since
+// resending it would block the queue behind it. Whatever is still unsent at
+// stop() could not reach the server and is handed back so the caller can
+// save it locally.
+const int LEADERBOARD_RETRY_MS = 2000;
+
+class LeaderboardLink {
+public:
+    ~LeaderboardLink();
+
+    bool start(int port);                       // false if no server answers on port
+    vector<HighscoreEntry> stop();              // last try at the queue; returns what was not sent
+    bool isLinked() const { return worker.joinable(); }
+
+    void submit(const string& name, int score);
+    void requestView(const string& player);     // fetched in the background, then after every submit
+    bool view(HighscoreView& out);              // latest view; false until one arrived
+
+private:
+    int port = 0;
+    LeaderboardClient client;                   // worker thread only once started
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    vector<HighscoreEntry> queued;
+    string viewPlayer;
+    bool viewWanted = false;
+    HighscoreView latest;
+    bool hasView = false;
+    bool stopping = false;
+
+    void run();
+    bool sendQueued();                          // worker thread; false if the server is gone
+};
+
+// -------------------- Command Line --------------------
+// --leaderboard-server [port]        serve highscores.bin until Enter is pressed
+// --lb-submit <name> <score> [port]  --lb-top [k] [port]  --lb-rank <name> [port]
+// Returns the process exit code.
+int RunLeaderboardTool(const string& command, const vector<string>& args);
+
+#endif // LEADERBOARD_SERVER_H
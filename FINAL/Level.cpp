@@ -0,0 +1,218 @@
+#include "Level.h"
+#include "MazeGenerator.h"
+#include "DefaultMaze.h"
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+// -------------------- Level Pack --------------------
+bool LoadLevelPack(const string& path, vector<LevelInfo>& levels) {
+    ifstream file(path);
+    if (!file.is_open()) return false;
+
+    levels.clear();
+    LevelInfo cur;
+    bool inLevel = false, inMap = false;
+    string line;
+    int lineNo = 0;
+
+    while (getline(file, line)) {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+
+        // Maze rows are taken verbatim, leading spaces included
+        if (inMap) {
+            if (line == "end") {
+                inMap = false; inLevel = false;
+                // Pad rows an editor trimmed, as LoadTextMap does, so every row has the same width
+                size_t width = 0;
+                for (auto& row : cur.layout) width = max(width, row.size());
+                for (auto& row : cur.layout) row.resize(width, ' ');
+                levels.push_back(cur);
+            }
+            else cur.layout.push_back(line);
+            continue;
+        }
+
+        if (line.empty() || line[0] == '#') continue;
+        istringstream in(line);
+        string key;
+        in >> key;
+
+        if (key == "level") {
+            cur = LevelInfo();
+            getline(in >> ws, cur.name);
+            inLevel = true;
+        }
+        else if (!inLevel) {
+            cout << path << ":" << lineNo << ": '" << key << "' outside a level\n";
+        }
+        else if (key == "pacSpeed") in >> cur.pacSpeed;
+        else if (key == "ghostSpeed") in >> cur.ghostSpeed;
+        else if (key == "frightened") in >> cur.frightenedFrames;
+        else if (key == "scatter") in >> cur.scatterFrames;
+        else if (key == "chase") in >> cur.chaseFrames;
+        else if (key == "powerups") {
+            string tile;
+            while (in >> tile) {
+                int x, y;
+                char comma;
+                istringstream t(tile);
+                if (t >> x >> comma >> y) cur.powerUps.push_back({ x, y });
+            }
+        }
+        else if (key == "mapfile") { in >> cur.mapPath; }
+        else if (key == "generate") { in >> cur.genCols >> cur.genRows; in >> cur.genSeed; }
+        else if (key == "map") inMap = true;
+        else if (key == "end") { inLevel = false; levels.push_back(cur); }
+        else cout << path << ":" << lineNo << ": unknown setting '" << key << "'\n";
+    }
+    if (inMap) cout << path << ":" << lineNo << ": file ends inside the map of level '" << cur.name << "', skipped\n";
+    else if (inLevel) cout << path << ":" << lineNo << ": file ends inside level '" << cur.name << "', skipped\n";
+
+    // Drop levels with no maze rather than crash on them later
+    vector<LevelInfo> valid;
+    for (auto& l : levels) {
+        if (l.layout.empty() && l.mapPath.empty() && l.genCols <= 0) cout << "Level '" << l.name << "' has no map, skipped\n";
+        else valid.push_back(l);
+    }
+    levels = valid;
+    return !levels.empty();
+}
+
+unique_ptr<Map> BuildLevelMap(const LevelInfo& info, int tileSize) {
+    unique_ptr<Map> maze;
+    bool isPmap = info.mapPath.size() > 5 && info.mapPath.substr(info.mapPath.size() - 5) == ".pmap";
+
+    if (!info.layout.empty()) {
+        // The classic maze's tables and metadata are compile-time constants
+        bool isDefault = DefaultMaze::HasStaticAllPairs() && DefaultMaze::Matches(info.layout);
+#ifndef NDEBUG
+        if (isDefault) {
+            static const bool checked = DefaultMaze::SameAsRuntimeNav();
+            assert(checked && "DefaultMaze tables differ from BuildMapNav");
+        }
+#endif
+        MapPrebuilt builtIn = DefaultMaze::Prebuilt();
+        maze.reset(new Map(info.layout, tileSize, isDefault ? &builtIn : nullptr));
+    }
+    else if (info.genCols > 0) {
+        MazeGenOptions opts;
+        opts.cols = info.genCols;
+        opts.rows = info.genRows;
+        opts.seed = info.genSeed ? info.genSeed : random_device()();
+        vector<string> layout = GenerateMaze(opts);
+        if (layout.empty()) {
+            cout << "No valid maze generated for level '" << info.name << "'\n";
+            return nullptr;
+        }
+        maze.reset(new Map(layout, tileSize));
+    }
+    else if (isPmap) {
+        // Placeholder layout, replaced wholesale by the mapped file
+        maze.reset(new Map(vector<string>{ "#" }, tileSize));
+        if (!maze->loadBinary(info.mapPath)) return nullptr;
+    }
+    else {
+        vector<string> layout;
+        if (!LoadTextMap(info.mapPath, layout)) {
+            cout << "Could not read map " << info.mapPath << "\n";
+            return nullptr;
+        }
+        maze.reset(new Map(layout, tileSize));
+    }
+
+    if (!info.powerUps.empty()) maze->mysteryPowerUps = info.powerUps;
+
+    // Default power-up spots only fit the classic maze
+    vector<pair<int, int>> onFloor;
+    for (auto& p : maze->mysteryPowerUps)
+        if (!maze->isWall(p.first, p.second)) onFloor.push_back(p);
+    maze->mysteryPowerUps = onFloor;
+
+    return maze;
+}
+
+void StartLevel(const LevelInfo& info, Map& maze, Pacman& pac,
+    RedGhost& red, PinkGhost& pink, OrangeGhost& orange, BlueGhost& blue, int tileSize)
+{
+    pac.startXPos = (float)(maze.pacStartX * tileSize);
+    pac.startYPos = (float)(maze.pacStartY * tileSize);
+    pac.resetPosition();
+    pac.dying = false;
+    pac.death_timer = 0;
+    pac.energizer_timer = 0;
+    pac.energizerFrames = info.frightenedFrames;
+    pac.baseSpeed = info.pacSpeed;
+    pac.setHardMode(pac.isHard);
+
+    // Red waits on the gate, the others in the row below it
+    red.setCage(maze.gateX, maze.gateY, tileSize);
+    pink.setCage(maze.gateX - 1, maze.gateY + 1, tileSize);
+    orange.setCage(maze.gateX, maze.gateY + 1, tileSize);
+    blue.setCage(maze.gateX + 1, maze.gateY + 1, tileSize);
+
+    Ghost* ghosts[4] = { &red, &pink, &orange, &blue };
+    for (Ghost* g : ghosts) {
+        g->baseSpeed = info.ghostSpeed;
+        g->setHardMode(g->isHard);
+    }
+}
+
+// -------------------- LevelLoader --------------------
+LevelLoader::~LevelLoader() {
+    {
+        lock_guard<mutex> guard(lock);
+        quitting = true;
+    }
+    wake.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void LevelLoader::request(const LevelInfo& info, int index, int tileSize) {
+    {
+        lock_guard<mutex> guard(lock);
+        queued = true;
+        queuedInfo = info;
+        queuedTileSize = tileSize;
+        requested++;
+        result.reset();
+        done = false;
+        loadingIndex = index;
+    }
+    if (!worker.joinable()) worker = thread([this]() { workerLoop(); });
+    wake.notify_all();
+}
+
+unique_ptr<Map> LevelLoader::take() {
+    lock_guard<mutex> guard(lock);
+    done = false;
+    return move(result);
+}
+
+void LevelLoader::workerLoop() {
+    unique_lock<mutex> guard(lock);
+    for (;;) {
+        wake.wait(guard, [this]() { return quitting || queued; });
+        if (quitting) return;
+
+        LevelInfo info = queuedInfo;
+        int tileSize = queuedTileSize;
+        int ticket = requested;
+        queued = false;
+
+        guard.unlock();
+        unique_ptr<Map> built = BuildLevelMap(info, tileSize);
+        guard.lock();
+
+        if (ticket == requested) {
+            result = move(built);
+            done = true;    // publishes result to the main thread
+        }
+    }
+}
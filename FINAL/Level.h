@@ -0,0 +1,76 @@
+#pragma once
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include "GameConstants.h"
+#include "Map.h"
+#include "Pacman.h"
+#include "Ghost.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Level Settings --------------------
+struct LevelInfo {
+    string name;
+    vector<string> layout;              // inline maze, or
+    string mapPath;                     // .pmap / text maze file, or
+    int genCols = 0, genRows = 0;       // procedurally generated maze
+    uint32_t genSeed = 0;               // 0 = new maze every session
+    vector<pair<int, int>> powerUps;    // empty = map defaults
+    float pacSpeed = Pacman::NORMAL_SPEED;
+    float ghostSpeed = Ghost::NORMAL_SPEED;
+    int frightenedFrames = GameConstants::FRIGHTENED_TOTAL_FRAMES;
+    int scatterFrames = 7 * 60;
+    int chaseFrames = 20 * 60;
+};
+
+// Reads a level pack (see levels.txt for the format)
+bool LoadLevelPack(const string& path, vector<LevelInfo>& levels);
+
+// Builds the map for a level: layout, coins and nav tables. CPU only, so it
+// can run off the main thread; chunk textures are baked later.
+unique_ptr<Map> BuildLevelMap(const LevelInfo& info, int tileSize);
+
+// Puts Pacman and the ghosts at the level's spawn points with its speeds
+void StartLevel(const LevelInfo& info, Map& maze, Pacman& pac,
+    RedGhost& red, PinkGhost& pink, OrangeGhost& orange, BlueGhost& blue, int tileSize);
+
+// -------------------- Background Loader --------------------
+// Builds level maps on a worker thread while the current level is played.
+// request() only queues and never waits: a newer request replaces one that
+// has not started, and a build that is overtaken by a newer request is
+// thrown away when it finishes.
+class LevelLoader {
+public:
+    ~LevelLoader();
+
+    void request(const LevelInfo& info, int index, int tileSize);
+    bool ready() const { return done.load(); }
+    int index() const { return loadingIndex; }
+    unique_ptr<Map> take();             // only once ready()
+
+private:
+    thread worker;
+    mutex lock;
+    condition_variable wake;
+    atomic<bool> done{ false };
+    bool quitting = false;
+    bool queued = false;
+    LevelInfo queuedInfo;
+    int queuedTileSize = 0;
+    int requested = 0;                  // requests so far; a build only counts if it is the latest
+    unique_ptr<Map> result;
+    int loadingIndex = -1;
+
+    void workerLoop();
+};
+
+#endif // LEVEL_H
@@ -1,6 +1,9 @@
 #include "map.h"
 #include <algorithm>
+#include <cmath>
+#include <iostream>
 using namespace std;
+using namespace GameConstants;
 
 // -------------------- CoinList Methods --------------------
 void CoinList::addCoin(int x, int y) {
@@ -36,34 +39,135 @@ bool CoinList::eatCoinAt(int gridX, int gridY) {
     return false;
 }
 
+void CoinList::clear() {
+    while (head) {
+        CoinNode* next = head->next;
+        delete head;
+        head = next;
+    }
+}
+
 // -------------------- Map Methods --------------------
-Map::Map(vector<string> mapLayout, int tSize)
-    : layout(mapLayout), tileSize(tSize)
+Map::Map(vector<string> mapLayout, int tSize, const MapPrebuilt* prebuilt)
+    : layout(mapLayout), tileSize(tSize), originalLayout(mapLayout)
 {
     isHard = false;    // default
+    fileBacked = false;
     rows = layout.size();
     cols = layout[0].size();
-
-
-    // Add coins
-    for (int y = 0; y < rows; y++) {
-        for (int x = 0; x < cols; x++) {
-            if (layout[y][x] == '.')
-                coins.addCoin(x, y);
-        }
+    drawFrame = 0;
+
+    if (prebuilt) {
+        pacStartX = prebuilt->pacStartX;
+        pacStartY = prebuilt->pacStartY;
+        gateX = prebuilt->gateX;
+        gateY = prebuilt->gateY;
+        houseMinX = prebuilt->houseMinX;
+        houseMinY = prebuilt->houseMinY;
+        houseMaxX = prebuilt->houseMaxX;
+        houseMaxY = prebuilt->houseMaxY;
+        startPellets = prebuilt->pelletCount;
     }
-
-    if (isHard) {
-       for (int y = 0; y < rows; y++)
-           for (int x = 0; x < cols; x++)
-               if (layout[y][x] == 'O')
-                   coins.addCoin(x, y); // Replace large pellets with normal floor
+    else {
+        findMetadata();
+        startPellets = 0;
+        for (auto& row : layout) startPellets += (int)count(row.begin(), row.end(), '.');
     }
+    buildChunks();
+
+    // Add coins
+    reset();
 
     // Mystery Power-Ups (manually)
     mysteryPowerUps = { {16,1}, {3,5}, {4,19}, {15,13}, {10,15}, {6,13} };
 
+    // Prebuilt maps skip the adjacency list, as .pmap maps do
+    if (prebuilt) {
+        nav = prebuilt->nav;
+        return;
+    }
     buildAdjList();
+    BuildMapNav(layout, gateX, gateY - 1, navStorage);
+    nav = navStorage.view(cols, rows, gateX, gateY - 1);
+}
+
+MapPrebuilt Map::prebuilt() const {
+    MapPrebuilt p;
+    p.nav = nav;
+    p.pacStartX = pacStartX;
+    p.pacStartY = pacStartY;
+    p.gateX = gateX;
+    p.gateY = gateY;
+    p.houseMinX = houseMinX;
+    p.houseMinY = houseMinY;
+    p.houseMaxX = houseMaxX;
+    p.houseMaxY = houseMaxY;
+    p.pelletCount = startPellets;
+    return p;
+}
+
+// Replace this map with a .pmap file. Nothing is parsed: metadata and nav
+// tables come straight from the mapping and chunk tiles are copied on first use.
+bool Map::loadBinary(const string& path) {
+    unloadChunks();
+    if (!file.open(path)) {
+        cout << "Could not open map file " << path << "\n";
+        return false;
+    }
+
+    const MapFileHeader& h = file.header();
+    if ((int)h.chunkTiles != CHUNK_TILES) {
+        cout << "Map file " << path << " uses " << h.chunkTiles << "-tile chunks, expected " << CHUNK_TILES << "\n";
+        file.close();
+        return false;
+    }
+
+    fileBacked = true;
+    cols = (int)h.cols;
+    rows = (int)h.rows;
+    pacStartX = h.pacStartX;
+    pacStartY = h.pacStartY;
+    gateX = h.gateX;
+    gateY = h.gateY;
+    houseMinX = h.houseMinX;
+    houseMinY = h.houseMinY;
+    houseMaxX = h.houseMaxX;
+    houseMaxY = h.houseMaxY;
+    mysteryPowerUps = file.powerUps();
+    startPellets = (int)h.pelletCount;
+
+    layout.assign(rows, string(cols, '#'));
+    originalLayout.clear();
+    adjList.clear();
+    navStorage = MapNavStorage();
+    nav = file.nav();
+
+    buildChunks();
+    reset();
+    return true;
+}
+
+// Pacman start, ghost house bounds and gate from the text layout
+void Map::findMetadata() {
+    pacStartX = -1; pacStartY = -1;
+    houseMinX = cols; houseMaxX = -1; houseMinY = rows; houseMaxY = -1;
+
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            char c = layout[y][x];
+            if (c == 'P' && pacStartX == -1) { pacStartX = x; pacStartY = y; }
+            if (c == 'G') {
+                houseMinX = min(houseMinX, x);
+                houseMaxX = max(houseMaxX, x);
+                houseMinY = min(houseMinY, y);
+                houseMaxY = max(houseMaxY, y);
+            }
+        }
+    }
+    if (pacStartX == -1) { pacStartX = cols / 2; pacStartY = rows - 2; }
+
+    gateX = (houseMaxX >= houseMinX) ? (houseMinX + houseMaxX) / 2 : cols / 2;
+    gateY = (houseMaxY >= houseMinY) ? houseMinY : rows / 2;
 }
 
 // Build adjacency list for BFS / ghost pathfinding
@@ -88,88 +192,337 @@ void Map::buildAdjList() {
     }
 }
 
-// Draw the map
-void Map::Draw() {
+// -------------------- Chunks --------------------
+void Map::buildChunks() {
+    chunkCols = (cols + CHUNK_TILES - 1) / CHUNK_TILES;
+    chunkRows = (rows + CHUNK_TILES - 1) / CHUNK_TILES;
+
+    chunks.clear();
+    chunks.resize(chunkCols * chunkRows);
+    for (int cy = 0; cy < chunkRows; cy++) {
+        for (int cx = 0; cx < chunkCols; cx++) {
+            MapChunk& c = chunks[cy * chunkCols + cx];
+            c.cx = cx;
+            c.cy = cy;
+            c.x0 = cx * CHUNK_TILES;
+            c.y0 = cy * CHUNK_TILES;
+            c.x1 = min(cols, c.x0 + CHUNK_TILES);
+            c.y1 = min(rows, c.y0 + CHUNK_TILES);
+        }
+    }
+
+    // Whole map visible until the first updateView()
+    visMinCX = 0; visMinCY = 0;
+    visMaxCX = chunkCols - 1; visMaxCY = chunkRows - 1;
+}
+
+// Restore the starting pellets. Text maps reload at once; .pmap chunks
+// are dropped and come back from the mapping when next touched.
+void Map::reset() {
+    if (!fileBacked) layout = originalLayout;
+
+    pelletsLeft = startPellets;
+    eatenHash = 0;
+
+    for (auto& c : chunks) {
+        c.coins.clear();
+        c.loaded = false;
+    }
+    if (!fileBacked)
+        for (auto& c : chunks) loadChunk(c);
+}
+
+MapChunk& Map::chunkAt(int gx, int gy) {
+    return chunks[(gy / CHUNK_TILES) * chunkCols + (gx / CHUNK_TILES)];
+}
+
+void Map::loadChunk(MapChunk& c) {
+    if (fileBacked) {
+        const char* tiles = file.chunkTiles(c.cx, c.cy);
+        int w = c.x1 - c.x0;
+        for (int y = c.y0; y < c.y1; y++) {
+            // A corrupt chunk stays solid wall rather than taking the game down
+            if (tiles) layout[y].replace(c.x0, w, tiles + (y - c.y0) * w, w);
+            else layout[y].replace(c.x0, w, w, '#');
+        }
+    }
+
+    // Add coins
+    for (int y = c.y0; y < c.y1; y++) {
+        for (int x = c.x0; x < c.x1; x++) {
+            if (layout[y][x] == '.')
+                c.coins.addCoin(x, y);
+            if (isHard && layout[y][x] == 'O')
+                c.coins.addCoin(x, y); // Replace large pellets with normal floor
+        }
+    }
+    c.loaded = true;
+}
+
+char Map::tile(int gx, int gy) {
+    if (fileBacked) {
+        MapChunk& c = chunkAt(gx, gy);
+        if (!c.loaded) loadChunk(c);
+    }
+    return layout[gy][gx];
+}
+
+// Only the chunk under the tile is searched, not every coin on the map
+bool Map::eatCoinAt(int gx, int gy) {
+    if (gx < 0 || gx >= cols || gy < 0 || gy >= rows) return false;
+    MapChunk& c = chunkAt(gx, gy);
+    if (!c.loaded) loadChunk(c);
+    if (!c.coins.eatCoinAt(gx, gy)) return false;
+    if (layout[gy][gx] == '.') pelletsLeft--;
+    eatenHash ^= StateKey(SF_PELLET, (int64_t)gy * cols + gx);
+    return true;
+}
+
+// A chunk that was never loaded is untouched; in a loaded one, every coin
+// tile of the original layout that has no coin now was eaten
+uint64_t Map::computeEatenHash() {
+    uint64_t hash = 0;
+    for (MapChunk& c : chunks) {
+        if (!c.loaded) continue;
+        const char* tiles = fileBacked ? file.chunkTiles(c.cx, c.cy) : nullptr;
+        int w = c.x1 - c.x0;
+        for (int y = c.y0; y < c.y1; y++)
+            for (int x = c.x0; x < c.x1; x++) {
+                char original = fileBacked ? (tiles ? tiles[(y - c.y0) * w + (x - c.x0)] : '#') : originalLayout[y][x];
+                bool coin = original == '.' || (isHard && original == 'O');
+                if (coin) {
+                    bool left = false;
+                    for (CoinNode* n = c.coins.head; n && !left; n = n->next) left = n->x == x && n->y == y;
+                    if (!left) hash ^= StateKey(SF_PELLET, (int64_t)y * cols + x);
+                }
+                if (original == 'O' && layout[y][x] != 'O') hash ^= StateKey(SF_ENERGIZER, (int64_t)y * cols + x);
+            }
+    }
+    return hash;
+}
+
+// Keep the camera centred on the focus point without showing past the map edge
+Rectangle Map::followCamera(Camera2D& cam, float focusX, float focusY, int screenW, int screenH) {
+    float mapW = (float)(cols * tileSize);
+    float mapH = (float)(rows * tileSize);
+
+    float left = focusX - screenW / 2.0f;
+    float top = focusY - screenH / 2.0f;
+    left = max(0.0f, min(left, mapW - screenW));
+    top = max(0.0f, min(top, mapH - screenH));
+    if (mapW <= screenW) left = 0;
+    if (mapH <= screenH) top = 0;
+
+    cam.offset = { 0.0f, 0.0f };
+    cam.target = { left, top };
+    cam.rotation = 0.0f;
+    cam.zoom = 1.0f;
+
+    return { left, top, (float)screenW, (float)screenH };
+}
+
+void Map::updateView(Rectangle view) {
+    drawFrame++;
+    int chunkPx = CHUNK_TILES * tileSize;
+
+    // Grow the view by one tile so actors straddling a chunk edge don't pop
+    float left = view.x - tileSize;
+    float top = view.y - tileSize;
+    float right = view.x + view.width + tileSize;
+    float bottom = view.y + view.height + tileSize;
+
+    visMinCX = max(0, (int)floor(left / chunkPx));
+    visMinCY = max(0, (int)floor(top / chunkPx));
+    visMaxCX = min(chunkCols - 1, (int)floor(right / chunkPx));
+    visMaxCY = min(chunkRows - 1, (int)floor(bottom / chunkPx));
+
+    int bakedCount = 0;
+    for (int cy = visMinCY; cy <= visMaxCY; cy++) {
+        for (int cx = visMinCX; cx <= visMaxCX; cx++) {
+            MapChunk& c = chunks[cy * chunkCols + cx];
+            if (!c.loaded) loadChunk(c);
+            if (!c.isBaked) bakeChunk(c);
+            c.lastDrawnFrame = drawFrame;
+        }
+    }
+
+    // Evict the least recently drawn off-screen textures past the budget
+    for (auto& c : chunks) if (c.isBaked) bakedCount++;
+    while (bakedCount > MAX_BAKED_CHUNKS) {
+        MapChunk* oldest = nullptr;
+        for (auto& c : chunks) {
+            if (!c.isBaked || c.lastDrawnFrame == drawFrame) continue;
+            if (!oldest || c.lastDrawnFrame < oldest->lastDrawnFrame) oldest = &c;
+        }
+        if (!oldest) break;
+        UnloadRenderTexture(oldest->baked);
+        oldest->isBaked = false;
+        bakedCount--;
+    }
+}
+
+bool Map::isVisible(float px, float py) {
+    int cx = (int)(px / (CHUNK_TILES * tileSize));
+    int cy = (int)(py / (CHUNK_TILES * tileSize));
+    return cx >= visMinCX && cx <= visMaxCX && cy >= visMinCY && cy <= visMaxCY;
+}
+
+void Map::unloadChunks() {
+    for (auto& c : chunks) {
+        if (c.isBaked) UnloadRenderTexture(c.baked);
+        c.isBaked = false;
+    }
+}
+
+void Map::replaceWith(Map&& next) {
+    unloadChunks();
+    for (auto& c : chunks) c.coins.clear();
+    *this = move(next);
+}
+
+// Bake up to `budget` chunks of the given view ahead of time. Used to warm a
+// map that isn't on screen yet; returns how many chunks there still are to bake.
+int Map::prebake(Rectangle view, int budget) {
+    int chunkPx = CHUNK_TILES * tileSize;
+    int minCX = max(0, (int)floor(view.x / chunkPx));
+    int minCY = max(0, (int)floor(view.y / chunkPx));
+    int maxCX = min(chunkCols - 1, (int)floor((view.x + view.width) / chunkPx));
+    int maxCY = min(chunkRows - 1, (int)floor((view.y + view.height) / chunkPx));
+
+    int remaining = 0;
+    for (int cy = minCY; cy <= maxCY; cy++) {
+        for (int cx = minCX; cx <= maxCX; cx++) {
+            MapChunk& c = chunks[cy * chunkCols + cx];
+            if (c.isBaked) continue;
+            if (budget > 0) {
+                if (!c.loaded) loadChunk(c);
+                bakeChunk(c);
+                budget--;
+            }
+            else remaining++;
+        }
+    }
+    return remaining;
+}
+
+void Map::setHardMode(bool h) {
+    if (isHard == h) return;
+    isHard = h;
+    unloadChunks(); // colours changed, rebake on next draw
+}
+
+void Map::bakeChunk(MapChunk& c) {
+    int w = (c.x1 - c.x0) * tileSize;
+    int h = (c.y1 - c.y0) * tileSize;
+    c.baked = LoadRenderTexture(w, h);
+
+    BeginTextureMode(c.baked);
+    ClearBackground(BLANK);
+    // One tile of margin so wall lines on the chunk border are drawn from both sides
+    drawStaticTiles(c.x0 - 1, c.y0 - 1, c.x1 + 1, c.y1 + 1,
+        (float)(c.x0 * tileSize), (float)(c.y0 * tileSize));
+    EndTextureMode();
+
+    c.isBaked = true;
+}
+
+// Floor, walls, ghost box and gate for tiles [x0,x1) x [y0,y1), shifted by (-ox, -oy)
+void Map::drawStaticTiles(int x0, int y0, int x1, int y1, float ox, float oy) {
     Color floorColor = isHard ? GetColor(0x001A26FF) : BLACK;
     Color wallColor = isHard ? GetColor(0x00C8FFFF) : DARKBLUE;
 
-   
-
     // Ghost home box
     Color ghostBoxColor = isHard ? Color{ 20,0,0,255 } : Color{ 15,15,15,255 };
 
+    x0 = max(x0, 0); y0 = max(y0, 0);
+    x1 = min(x1, cols); y1 = min(y1, rows);
+
+    // The margin reaches into neighbouring chunks
+    for (int y = y0; y < y1; y += CHUNK_TILES - (y % CHUNK_TILES))
+        for (int x = x0; x < x1; x += CHUNK_TILES - (x % CHUNK_TILES))
+            tile(x, y);
 
     // Walkable background
-    for (int y = 0; y < rows; y++) {
-        for (int x = 0; x < cols; x++) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
             if (layout[y][x] != '#') {
-                DrawRectangle(x * tileSize, y * tileSize, tileSize, tileSize, floorColor);
+                DrawRectangle((int)(x * tileSize - ox), (int)(y * tileSize - oy), tileSize, tileSize, floorColor);
             }
         }
     }
 
     // Walls Outline
-    for (int y = 0; y < rows; y++) {
-        for (int x = 0; x < cols; x++) {
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
             if (layout[y][x] == '#') {
-                int px = x * tileSize;
-                int py = y * tileSize;
+                float px = x * tileSize - ox;
+                float py = y * tileSize - oy;
 
-                if (y == 0 || layout[y - 1][x] != '#') DrawLineEx({ (float)px,(float)py }, { (float)(px + tileSize),(float)py }, 3, wallColor);
-                if (y == rows - 1 || layout[y + 1][x] != '#') DrawLineEx({ (float)px,(float)(py + tileSize) }, { (float)(px + tileSize),(float)(py + tileSize) }, 3, wallColor);
-                if (x == 0 || layout[y][x - 1] != '#') DrawLineEx({ (float)px,(float)py }, { (float)px,(float)(py + tileSize) }, 3, wallColor);
-                if (x == cols - 1 || layout[y][x + 1] != '#') DrawLineEx({ (float)(px + tileSize),(float)py }, { (float)(px + tileSize),(float)(py + tileSize) }, 3, wallColor);
+                if (y == 0 || layout[y - 1][x] != '#') DrawLineEx({ px,py }, { px + tileSize,py }, 3, wallColor);
+                if (y == rows - 1 || layout[y + 1][x] != '#') DrawLineEx({ px,py + tileSize }, { px + tileSize,py + tileSize }, 3, wallColor);
+                if (x == 0 || layout[y][x - 1] != '#') DrawLineEx({ px,py }, { px,py + tileSize }, 3, wallColor);
+                if (x == cols - 1 || layout[y][x + 1] != '#') DrawLineEx({ px + tileSize,py }, { px + tileSize,py + tileSize }, 3, wallColor);
             }
         }
     }
 
     // Ghost Home Box
-    int gxmin = cols, gxmax = -1, gymin = rows, gymax = -1;
-    for (int y = 0; y < rows; y++)
-        for (int x = 0; x < cols; x++)
-            if (layout[y][x] == 'G') {
-                gxmin = min(gxmin, x);
-                gxmax = max(gxmax, x);
-                gymin = min(gymin, y);
-                gymax = max(gymax, y);
-            }
-
-    if (gxmax >= gxmin && gymax >= gymin) {
-        int left = gxmin * tileSize;
-        int top = gymin * tileSize;
-        int w = (gxmax - gxmin + 1) * tileSize;
-        int h = (gymax - gymin + 1) * tileSize;
-
-        DrawRectangle(left, top, w, h, ghostBoxColor);
-        DrawRectangleLinesEx({ (float)left,(float)top,(float)w,(float)h }, 2, wallColor);
+    if (houseMaxX >= houseMinX && houseMaxY >= houseMinY &&
+        houseMaxX >= x0 && houseMinX < x1 && houseMaxY >= y0 && houseMinY < y1) {
+        float left = houseMinX * tileSize - ox;
+        float top = houseMinY * tileSize - oy;
+        int w = (houseMaxX - houseMinX + 1) * tileSize;
+        int h = (houseMaxY - houseMinY + 1) * tileSize;
+
+        DrawRectangle((int)left, (int)top, w, h, ghostBoxColor);
+        DrawRectangleLinesEx({ left,top,(float)w,(float)h }, 2, wallColor);
     }
 
-    // Coins
-    coins.drawCoins(tileSize);
-
-    // Large Pellets (skip in hard mode)
-
-    if (!isHard) {
-        for (int y = 0; y < rows; y++)
-            for (int x = 0; x < cols; x++)
-                if (layout[y][x] == 'O') {
-                    int cx = x * tileSize + tileSize / 2;
-                    int cy = y * tileSize + tileSize / 2;
-                    DrawCircle(cx, cy, tileSize * 0.3f, ORANGE);
-                }
+    // Gate
+    if (gateX >= x0 && gateX < x1 && gateY >= y0 && gateY < y1) {
+        float gx = gateX * tileSize - ox;
+        float gy = gateY * tileSize - oy;
+        DrawLineEx({ gx,gy }, { gx + tileSize,gy }, 3.5f, SKYBLUE);
     }
+}
 
-   
+// Draw the chunks picked by the last updateView()
+void Map::Draw() {
+    // Baked static tiles (render textures are stored upside down)
+    for (int cy = visMinCY; cy <= visMaxCY; cy++) {
+        for (int cx = visMinCX; cx <= visMaxCX; cx++) {
+            MapChunk& c = chunks[cy * chunkCols + cx];
+            if (!c.isBaked) continue; // updateView() bakes; never bake inside BeginMode2D
+            Rectangle src = { 0, 0, (float)c.baked.texture.width, -(float)c.baked.texture.height };
+            DrawTextureRec(c.baked.texture, src, { (float)(c.x0 * tileSize), (float)(c.y0 * tileSize) }, WHITE);
+        }
+    }
 
-    // Gate
-    int gateX = 10 * tileSize;
-    int gateY = 8 * tileSize;
-    DrawLineEx({ (float)gateX,(float)gateY }, { (float)(gateX + tileSize),(float)gateY }, 3.5f, SKYBLUE);
+    for (int cy = visMinCY; cy <= visMaxCY; cy++) {
+        for (int cx = visMinCX; cx <= visMaxCX; cx++) {
+            MapChunk& c = chunks[cy * chunkCols + cx];
+
+            // Coins
+            c.coins.drawCoins(tileSize);
+
+            // Large Pellets (skip in hard mode)
+            if (!isHard) {
+                for (int y = c.y0; y < c.y1; y++)
+                    for (int x = c.x0; x < c.x1; x++)
+                        if (layout[y][x] == 'O') {
+                            int px = x * tileSize + tileSize / 2;
+                            int py = y * tileSize + tileSize / 2;
+                            DrawCircle(px, py, tileSize * 0.3f, ORANGE);
+                        }
+            }
+        }
+    }
 
     // Mystery Power-Ups
     for (auto& tile : mysteryPowerUps) {
         int cx = tile.first * tileSize + tileSize / 2;
         int cy = tile.second * tileSize + tileSize / 2;
+        if (!isVisible((float)cx, (float)cy)) continue;
         DrawCircle(cx, cy, tileSize * 0.3f, PURPLE);
         int fontSize = tileSize / 2;
         DrawText("?", cx - fontSize / 4, cy - fontSize / 2, fontSize, WHITE);
@@ -179,11 +532,14 @@ void Map::Draw() {
 // Check if a tile is a wall
 bool Map::isWall(int gx, int gy) {
     if (gx < 0 || gx >= cols || gy < 0 || gy >= rows) return true;
-    char c = layout[gy][gx];
+    char c = tile(gx, gy);
     if (c == '#' || (gy == 9 && gx == 10) || c == 'G') return true;
     return false;
 }
 
 void Map::eatLargePelletAt(int gx, int gy) {
-    if (gx >= 0 && gx < cols && gy >= 0 && gy < rows && layout[gy][gx] == 'O') layout[gy][gx] = ' ';
+    if (gx >= 0 && gx < cols && gy >= 0 && gy < rows && tile(gx, gy) == 'O') {
+        layout[gy][gx] = ' ';
+        eatenHash ^= StateKey(SF_ENERGIZER, (int64_t)gy * cols + gx);
+    }
 }
@@ -3,6 +3,9 @@
  #define MAP_H
 #include "raylib.h"
 #include "GameConstants.h"
+#include "MapNav.h"
+#include "MapFile.h"
+#include "StateHash.h"
 #include <vector>
 #include <string>
 #include <unordered_map>
@@ -22,6 +25,21 @@ public:
     void addCoin(int x, int y);
     void drawCoins(int tileSize);
     bool eatCoinAt(int gridX, int gridY);
+    void clear();
+};
+
+// -------------------- Map Chunks --------------------
+// The maze is split into CHUNK_TILES x CHUNK_TILES blocks. Each chunk owns the
+// coins inside it and a lazily baked texture of its static tiles, so a frame
+// only pays for the chunks that intersect the camera view.
+struct MapChunk {
+    int cx, cy;                 // chunk coordinates
+    int x0, y0, x1, y1;         // tile range covered, [x0,x1) x [y0,y1)
+    CoinList coins;
+    RenderTexture2D baked;
+    bool isBaked = false;
+    int lastDrawnFrame = -1;
+    bool loaded = false;        // tiles copied into layout and coins built
 };
 
 // -------------------- Map Class --------------------
@@ -29,19 +47,76 @@ class Map {
 public:
     vector<string> layout;
     int rows, cols, tileSize;
-    CoinList coins;
 	vector<pair<int, int>> mysteryPowerUps;  //(col, row)
-    unordered_map<int, vector<int>> adjList;
+    unordered_map<int, vector<int>> adjList;   // text maps only; .pmap maps use nav.walkMask
     bool isHard;
 
-    Map(vector<string> mapLayout, int tSize);
+    int pacStartX, pacStartY;
+    int gateX, gateY;                          // gate tile, top centre of the ghost house
+
+    // Precomputed navigation; points into navStorage or the mapped .pmap
+    MapNav nav;
+    MapNavStorage navStorage;
+
+    // Set when loaded from a .pmap: chunk tiles are copied in on first touch
+    MapFile file;
+    bool fileBacked;
+    vector<string> originalLayout;
+
+    int pelletsLeft;                        // '.' coins not yet eaten; 0 clears the level
+    int startPellets;                       // '.' tiles in the starting layout
+    uint64_t eatenHash = 0;                 // StateKey of every pellet and energizer eaten since reset()
+
+    // Chunks, row-major, chunkCols x chunkRows
+    vector<MapChunk> chunks;
+    int chunkCols, chunkRows;
+    // Visible chunk range from the last updateView(), inclusive
+    int visMinCX, visMinCY, visMaxCX, visMaxCY;
+    int drawFrame;
+    int houseMinX, houseMinY, houseMaxX, houseMaxY;   // ghost house tile bounds
+
+    // prebuilt: nav tables and metadata computed ahead of time for this exact
+    // layout (see DefaultMaze.h); nothing is scanned or searched at load then
+    Map(vector<string> mapLayout, int tSize, const MapPrebuilt* prebuilt = nullptr);
+    Map(const Map&) = delete;               // nav points into this object
+    Map& operator=(const Map&) = delete;
+    Map(Map&&) = default;                   // vectors and mappings keep their buffers
+    Map& operator=(Map&&) = default;
+
+    // Swap in a map built elsewhere (e.g. the next level), releasing this one's textures and coins
+    void replaceWith(Map&& next);
+
+    // This map's nav tables and metadata, to build a copy without scanning (the copy shares the tables)
+    MapPrebuilt prebuilt() const;
+
+    bool loadBinary(const string& path);
+    void reset();                           // restore pellets and layout
 
     void buildAdjList();
+    void buildChunks();
+    MapChunk& chunkAt(int gx, int gy);
+    void loadChunk(MapChunk& c);
+    char tile(int gx, int gy);
+    bool eatCoinAt(int gx, int gy);
+    uint64_t computeEatenHash();            // eatenHash from scratch, for checking it
+
+    // Call before BeginMode2D: picks visible chunks and bakes missing textures
+    void updateView(Rectangle view);
+    Rectangle followCamera(Camera2D& cam, float focusX, float focusY, int screenW, int screenH);
+    bool isVisible(float px, float py);
     void Draw();
+    void unloadChunks();
+    int prebake(Rectangle view, int budget);
+
     bool isWall(int gx, int gy);
     void eatLargePelletAt(int gx, int gy);
 
-    //void setHardMode(bool h);  // <-- NEW
+    void setHardMode(bool h);
+
+private:
+    void findMetadata();
+    void bakeChunk(MapChunk& c);
+    void drawStaticTiles(int x0, int y0, int x1, int y1, float ox, float oy);
 };
 
 #endif // MAP_H
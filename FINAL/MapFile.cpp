@@ -0,0 +1,253 @@
+#include "MapFile.h"
+#include "Map.h"
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+
+using namespace std;
+using namespace GameConstants;
+
+// -------------------- Reading --------------------
+bool MapFile::open(const string& path) {
+    close();
+    if (!file.open(path)) return false;
+
+    size_t size = file.size();
+    const unsigned char* base = file.bytes();
+    if (size < sizeof(MapFileHeader)) { close(); return false; }
+
+    const MapFileHeader* h = (const MapFileHeader*)base;
+    if (memcmp(h->magic, MAPFILE_MAGIC, 4) != 0 || h->version != MAPFILE_VERSION ||
+        Crc32(h, offsetof(MapFileHeader, headerCrc)) != h->headerCrc) {
+        cout << "Map file " << path << " has a bad header\n";
+        close();
+        return false;
+    }
+
+    // The chunk grid must be the one the map derives from cols and rows,
+    // since Map indexes the chunk table with its own grid
+    uint32_t ct = h->chunkTiles;
+    bool sane = h->cols > 0 && h->rows > 0 && h->cols <= MAPFILE_MAX_SIDE && h->rows <= MAPFILE_MAX_SIDE
+        && ct > 0 && h->chunkCols == (h->cols + ct - 1) / ct && h->chunkRows == (h->rows + ct - 1) / ct
+        && h->walkableCount <= h->cols * h->rows
+        && ((h->nextHopOffset == 0 && h->distOffset == 0) || h->walkableCount <= (uint32_t)NAV_MAX_ALL_PAIRS);
+    if (!sane) {
+        cout << "Map file " << path << " has a bad size or chunk grid\n";
+        close();
+        return false;
+    }
+
+    // Map indexes its layout with these straight away. A map without a ghost
+    // house stores an empty range (min past max), as Map's own scan leaves it.
+    auto inside = [&](int32_t x, int32_t y) { return x >= 0 && y >= 0 && (uint32_t)x < h->cols && (uint32_t)y < h->rows; };
+    bool house = h->houseMinX <= h->houseMaxX && h->houseMinY <= h->houseMaxY;
+    bool placed = inside(h->pacStartX, h->pacStartY) && inside(h->gateX, h->gateY)
+        && (!house || (inside(h->houseMinX, h->houseMinY) && inside(h->houseMaxX, h->houseMaxY)))
+        && h->powerUpCount <= h->cols * h->rows;
+    if (!placed) {
+        cout << "Map file " << path << " has a start, gate or ghost house outside the maze\n";
+        close();
+        return false;
+    }
+
+    // Bounds-check every section once so later reads can't run off the mapping.
+    // With the sizes above no product can overflow.
+    uint64_t tiles = (uint64_t)h->cols * h->rows;
+    uint64_t chunks = (uint64_t)h->chunkCols * h->chunkRows;
+    uint64_t n = h->walkableCount;
+    auto fits = [&](uint64_t off, uint64_t bytes) {
+        return off == 0 || (off <= size && bytes <= size - off && off % 8 == 0);
+    };
+    bool ok = h->chunkTableOffset != 0 && fits(h->chunkTableOffset, chunks * sizeof(MapFileChunk))
+        && fits(h->powerUpOffset, h->powerUpCount * 8ull)
+        && h->walkMaskOffset != 0 && fits(h->walkMaskOffset, tiles) && fits(h->tileIndexOffset, tiles * 4)
+        && fits(h->indexTileOffset, n * 4) && fits(h->gateHopOffset, tiles)
+        && fits(h->gateDistOffset, tiles * 2)
+        && fits(h->nextHopOffset, n * n) && fits(h->distOffset, n * n * 2);
+    if (ok) {
+        chunkTable = (const MapFileChunk*)(base + h->chunkTableOffset);
+        for (uint64_t i = 0; i < chunks && ok; i++)
+            ok = chunkTable[i].offset <= size && chunkTable[i].size <= size - chunkTable[i].offset;
+    }
+    if (ok && h->powerUpOffset) {
+        const int32_t* p = (const int32_t*)(base + h->powerUpOffset);
+        for (uint32_t i = 0; i < h->powerUpCount && ok; i++) ok = inside(p[i * 2], p[i * 2 + 1]);
+    }
+    if (!ok) {
+        cout << "Map file " << path << " is truncated\n";
+        close();
+        return false;
+    }
+
+    // Unlike chunks, the nav tables can't be checked lazily: Map takes them
+    // all at load and they hold directions and indices used unchecked. This
+    // reads them once, about 8 bytes a tile plus up to 3 MB of all-pairs
+    // tables (NAV_MAX_ALL_PAIRS), so open() is linear in the nav size.
+    if (Crc32(chunkTable, (size_t)chunks * sizeof(MapFileChunk)) != h->chunkTableCrc ||
+        Crc32(base + h->walkMaskOffset, size - h->walkMaskOffset) != h->navCrc) {
+        cout << "Map file " << path << " failed its checksum\n";
+        close();
+        return false;
+    }
+
+    hdr = h;
+    chunkState.assign((size_t)chunks, 0);
+    return true;
+}
+
+void MapFile::close() {
+    file.close();
+    hdr = nullptr;
+    chunkTable = nullptr;
+    chunkState.clear();
+}
+
+int MapFile::chunkWidth(int cx) const {
+    return min((int)hdr->chunkTiles, (int)hdr->cols - cx * (int)hdr->chunkTiles);
+}
+
+int MapFile::chunkHeight(int cy) const {
+    return min((int)hdr->chunkTiles, (int)hdr->rows - cy * (int)hdr->chunkTiles);
+}
+
+const char* MapFile::chunkTiles(int cx, int cy) {
+    int idx = cy * (int)hdr->chunkCols + cx;
+    const MapFileChunk& c = chunkTable[idx];
+    const char* tiles = (const char*)(file.bytes() + c.offset);
+
+    if (chunkState[idx] == 0) {
+        bool ok = c.size == (uint32_t)(chunkWidth(cx) * chunkHeight(cy)) && Crc32(tiles, c.size) == c.crc;
+        chunkState[idx] = ok ? 1 : 2;
+        if (!ok) cout << "Map chunk (" << cx << "," << cy << ") failed its checksum\n";
+    }
+    return chunkState[idx] == 1 ? tiles : nullptr;
+}
+
+vector<pair<int, int>> MapFile::powerUps() const {
+    vector<pair<int, int>> out;
+    const int32_t* p = (const int32_t*)section(hdr->powerUpOffset);
+    for (uint32_t i = 0; p && i < hdr->powerUpCount; i++)
+        out.push_back({ p[i * 2], p[i * 2 + 1] });
+    return out;
+}
+
+MapNav MapFile::nav() const {
+    MapNav nav;
+    nav.cols = (int)hdr->cols;
+    nav.rows = (int)hdr->rows;
+    nav.walkableCount = (int)hdr->walkableCount;
+    nav.gateX = hdr->navGateX;
+    nav.gateY = hdr->navGateY;
+    nav.walkMask = (const unsigned char*)section(hdr->walkMaskOffset);
+    nav.tileIndex = (const int*)section(hdr->tileIndexOffset);
+    nav.indexTile = (const int*)section(hdr->indexTileOffset);
+    nav.gateHop = (const unsigned char*)section(hdr->gateHopOffset);
+    nav.gateDist = (const unsigned short*)section(hdr->gateDistOffset);
+    nav.nextHop = (const unsigned char*)section(hdr->nextHopOffset);
+    nav.dist = (const unsigned short*)section(hdr->distOffset);
+    return nav;
+}
+
+// -------------------- Text Layout --------------------
+bool LoadTextMap(const string& path, vector<string>& layout) {
+    ifstream in(path);
+    if (!in.is_open()) return false;
+
+    layout.clear();
+    string line;
+    size_t width = 0;
+    while (getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        width = max(width, line.size());
+        layout.push_back(line);
+    }
+    // Pad ragged rows with open floor so every row has the same width
+    for (auto& row : layout) row.resize(width, ' ');
+    return !layout.empty();
+}
+
+// -------------------- Writing --------------------
+static void padTo8(string& out) {
+    while (out.size() % 8) out.push_back('\0');
+}
+
+template <typename T>
+static uint64_t appendSection(string& out, const T* data, size_t count) {
+    if (!data || count == 0) return 0;
+    padTo8(out);
+    uint64_t offset = out.size();
+    out.append((const char*)data, count * sizeof(T));
+    return offset;
+}
+
+bool ConvertMapToBinary(Map& map, const string& outPath) {
+    MapFileHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MAPFILE_MAGIC, 4);
+    h.version = MAPFILE_VERSION;
+    h.cols = map.cols;
+    h.rows = map.rows;
+    h.chunkTiles = CHUNK_TILES;
+    h.chunkCols = map.chunkCols;
+    h.chunkRows = map.chunkRows;
+    h.pacStartX = map.pacStartX;
+    h.pacStartY = map.pacStartY;
+    h.gateX = map.gateX;
+    h.gateY = map.gateY;
+    h.houseMinX = map.houseMinX;
+    h.houseMinY = map.houseMinY;
+    h.houseMaxX = map.houseMaxX;
+    h.houseMaxY = map.houseMaxY;
+    h.navGateX = map.nav.gateX;
+    h.navGateY = map.nav.gateY;
+    h.powerUpCount = (uint32_t)map.mysteryPowerUps.size();
+    h.walkableCount = map.nav.walkableCount;
+
+    string out((const char*)&h, sizeof(h));
+
+    // Chunk table is filled in once the payload offsets are known
+    padTo8(out);
+    h.chunkTableOffset = out.size();
+    vector<MapFileChunk> table(map.chunks.size());
+    out.append(table.size() * sizeof(MapFileChunk), '\0');
+
+    for (size_t i = 0; i < map.chunks.size(); i++) {
+        MapChunk& c = map.chunks[i];
+        string tiles;
+        for (int y = c.y0; y < c.y1; y++)
+            for (int x = c.x0; x < c.x1; x++)
+                tiles.push_back(map.tile(x, y));
+
+        padTo8(out);
+        table[i].offset = out.size();
+        table[i].size = (uint32_t)tiles.size();
+        table[i].crc = Crc32(tiles.data(), tiles.size());
+        out += tiles;
+    }
+    memcpy(&out[h.chunkTableOffset], table.data(), table.size() * sizeof(MapFileChunk));
+    h.chunkTableCrc = Crc32(table.data(), table.size() * sizeof(MapFileChunk));
+
+    vector<int32_t> powerUps;
+    for (auto& p : map.mysteryPowerUps) { powerUps.push_back(p.first); powerUps.push_back(p.second); }
+    h.powerUpOffset = appendSection(out, powerUps.data(), powerUps.size());
+
+    size_t tiles = (size_t)map.cols * map.rows;
+    size_t n = map.nav.walkableCount;
+    h.walkMaskOffset = appendSection(out, map.nav.walkMask, tiles);
+    h.tileIndexOffset = appendSection(out, map.nav.tileIndex, tiles);
+    h.indexTileOffset = appendSection(out, map.nav.indexTile, n);
+    h.gateHopOffset = appendSection(out, map.nav.gateHop, tiles);
+    h.gateDistOffset = appendSection(out, map.nav.gateDist, tiles);
+    h.nextHopOffset = appendSection(out, map.nav.nextHop, map.nav.hasAllPairs() ? n * n : 0);
+    h.distOffset = appendSection(out, map.nav.dist, map.nav.hasAllPairs() ? n * n : 0);
+
+    h.pelletCount = (uint32_t)map.pelletsLeft;
+    h.navCrc = Crc32(out.data() + h.walkMaskOffset, out.size() - h.walkMaskOffset);
+    h.headerCrc = Crc32(&h, offsetof(MapFileHeader, headerCrc));
+    memcpy(&out[0], &h, sizeof(h));
+
+    return WriteFileAtomic(outPath, out.data(), out.size());
+}
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef MAP_FILE_H
+#define MAP_FILE_H
+
+#include "FileIO.h"
+#include "MapNav.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+class Map; // forward declaration
+
+// -------------------- .pmap Binary Map Format --------------------
+// Little-endian. Layout on disk:
+//   MapFileHeader
+//   chunk table      chunkCols * chunkRows MapFileChunk entries
+//   chunk payloads   tiles of each chunk, row-major inside the chunk
+//   power-ups        powerUpCount * (int32 col, int32 row)
+//   nav sections     walkMask u8, tileIndex i32, indexTile i32, gateHop u8,
+//                    gateDist u16, nextHop u8 and dist u16 (all-pairs, optional)
+// Every section starts on an 8-byte boundary so it can be used in place.
+// The nav sections come last and are checksummed as one range.
+const char MAPFILE_MAGIC[4] = { 'P', 'M', 'A', 'P' };
+const uint32_t MAPFILE_VERSION = 3;
+const uint32_t MAPFILE_MAX_SIDE = 1 << 15;     // tiles per row or column
+
+struct MapFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t cols, rows;
+    uint32_t chunkTiles, chunkCols, chunkRows;
+    int32_t pacStartX, pacStartY;
+    int32_t gateX, gateY;                       // gate tile (top centre of the ghost house)
+    int32_t houseMinX, houseMinY, houseMaxX, houseMaxY;
+    int32_t navGateX, navGateY;                 // tile the gate tables lead to
+    uint32_t powerUpCount;
+    uint32_t walkableCount;
+    uint64_t chunkTableOffset;
+    uint64_t powerUpOffset;
+    uint64_t walkMaskOffset, tileIndexOffset, indexTileOffset;
+    uint64_t gateHopOffset, gateDistOffset;
+    uint64_t nextHopOffset, distOffset;         // 0 when the maze is too big for all-pairs
+    uint32_t pelletCount;                       // '.' tiles, known without touching chunks
+    uint32_t chunkTableCrc;
+    uint32_t navCrc;                            // walkMaskOffset to the end of the file
+    uint32_t headerCrc;                         // CRC of everything above
+};
+
+static_assert(sizeof(MapFileHeader) == 168, "MapFileHeader layout must not depend on the compiler");
+
+struct MapFileChunk {
+    uint64_t offset;
+    uint32_t size;
+    uint32_t crc;
+};
+
+// Memory-mapped .pmap reader. open() checks the header, the start, gate,
+// house and power-up positions, the section bounds and the chunk table and
+// nav checksums; chunk checksums are verified the first time a chunk is
+// read. The nav checksum reads every nav page, so open() costs time linear
+// in the nav tables (not in the chunk payloads, which stay untouched).
+class MapFile {
+public:
+    bool open(const string& path);
+    void close();
+    bool isOpen() const { return hdr != nullptr; }
+
+    const MapFileHeader& header() const { return *hdr; }
+
+    // Tiles of one chunk, or nullptr if its checksum is bad
+    const char* chunkTiles(int cx, int cy);
+    int chunkWidth(int cx) const;
+    int chunkHeight(int cy) const;
+
+    vector<pair<int, int>> powerUps() const;
+    MapNav nav() const;
+
+private:
+    MappedFile file;
+    const MapFileHeader* hdr = nullptr;
+    const MapFileChunk* chunkTable = nullptr;
+    vector<unsigned char> chunkState;   // 0 = unchecked, 1 = ok, 2 = corrupt
+
+    const void* section(uint64_t offset) const { return offset ? file.bytes() + offset : nullptr; }
+};
+
+// Text layout (one maze row per line, same characters as main.cpp)
+bool LoadTextMap(const string& path, vector<string>& layout);
+
+// Write a fully loaded map as .pmap
+bool ConvertMapToBinary(Map& map, const string& outPath);
+
+#endif // MAP_FILE_H
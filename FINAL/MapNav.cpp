@@ -0,0 +1,121 @@
+#include "MapNav.h"
+#include <queue>
+
+// -------------------- MapNav --------------------
+bool MapNav::walkable(int x, int y) const {
+    if (x < 0 || y < 0 || x >= cols || y >= rows) return false;
+    return tileIndex[y * cols + x] >= 0;
+}
+
+int MapNav::hopToward(int fx, int fy, int tx, int ty) const {
+    if (!nextHop) return -1;
+    if (!walkable(fx, fy) || !walkable(tx, ty)) return -1;
+    int from = tileIndex[fy * cols + fx];
+    int to = tileIndex[ty * cols + tx];
+    if (from == to) return -1;
+    unsigned char d = nextHop[(size_t)from * walkableCount + to];
+    return d == NAV_NONE ? -1 : d;
+}
+
+int MapNav::distance(int fx, int fy, int tx, int ty) const {
+    if (!dist) return -1;
+    if (!walkable(fx, fy) || !walkable(tx, ty)) return -1;
+    unsigned short d = dist[(size_t)tileIndex[fy * cols + fx] * walkableCount + tileIndex[ty * cols + tx]];
+    return d == NAV_UNREACHABLE ? -1 : d;
+}
+
+// -------------------- MapNavStorage --------------------
+MapNav MapNavStorage::view(int cols, int rows, int gateX, int gateY) const {
+    MapNav nav;
+    nav.cols = cols;
+    nav.rows = rows;
+    nav.walkableCount = (int)indexTile.size();
+    nav.gateX = gateX;
+    nav.gateY = gateY;
+    nav.walkMask = walkMask.data();
+    nav.tileIndex = tileIndex.data();
+    nav.indexTile = indexTile.data();
+    nav.gateHop = gateHop.empty() ? nullptr : gateHop.data();
+    nav.gateDist = gateDist.empty() ? nullptr : gateDist.data();
+    nav.nextHop = nextHop.empty() ? nullptr : nextHop.data();
+    nav.dist = dist.empty() ? nullptr : dist.data();
+    return nav;
+}
+
+// -------------------- Building --------------------
+void BuildMapNav(const vector<string>& layout, int gateX, int gateY, MapNavStorage& out) {
+    int rows = (int)layout.size();
+    int cols = rows ? (int)layout[0].size() : 0;
+    int tiles = rows * cols;
+
+    auto walk = [&](int x, int y) {
+        return x >= 0 && y >= 0 && x < cols && y < rows && IsNavWalkable(layout[y][x]);
+    };
+
+    out.walkMask.assign(tiles, 0);
+    out.tileIndex.assign(tiles, -1);
+    out.indexTile.clear();
+
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            if (!walk(x, y)) continue;
+            out.tileIndex[y * cols + x] = (int)out.indexTile.size();
+            out.indexTile.push_back(y * cols + x);
+            unsigned char mask = 0;
+            for (int d = 0; d < 4; d++)
+                if (walk(x + NAV_DX[d], y + NAV_DY[d])) mask |= (unsigned char)(1 << d);
+            out.walkMask[y * cols + x] = mask;
+        }
+    }
+
+    // Gate tables: BFS outward from the gate, each tile stores the step back to its parent
+    out.gateHop.assign(tiles, NAV_NONE);
+    out.gateDist.assign(tiles, NAV_UNREACHABLE);
+    if (gateX >= 0 && gateY >= 0 && gateX < cols && gateY < rows) {
+        queue<int> q;
+        q.push(gateY * cols + gateX);
+        out.gateDist[gateY * cols + gateX] = 0;
+        while (!q.empty()) {
+            int cur = q.front(); q.pop();
+            int cx = cur % cols, cy = cur / cols;
+            for (int d : NAV_BFS_DIRS) {
+                int nx = cx + NAV_DX[d], ny = cy + NAV_DY[d];
+                if (!walk(nx, ny) || out.gateDist[ny * cols + nx] != NAV_UNREACHABLE) continue;
+                out.gateDist[ny * cols + nx] = (unsigned short)min(out.gateDist[cur] + 1, (int)NAV_UNREACHABLE - 1);
+                out.gateHop[ny * cols + nx] = (unsigned char)(d ^ 1); // reverse of the step taken
+                q.push(ny * cols + nx);
+            }
+        }
+    }
+
+    // All-pairs next hop: one BFS per source, remembering the first step on each path
+    int n = (int)out.indexTile.size();
+    out.nextHop.clear();
+    out.dist.clear();
+    if (n == 0 || n > NAV_MAX_ALL_PAIRS) return;
+
+    out.nextHop.assign((size_t)n * n, NAV_NONE);
+    out.dist.assign((size_t)n * n, NAV_UNREACHABLE);
+    vector<int> bfs(n);
+    for (int src = 0; src < n; src++) {
+        unsigned char* hop = &out.nextHop[(size_t)src * n];
+        unsigned short* dst = &out.dist[(size_t)src * n];
+        int head = 0, tail = 0;
+        bfs[tail++] = src;
+        dst[src] = 0;
+        while (head < tail) {
+            int cur = bfs[head++];
+            int tile = out.indexTile[cur];
+            int cx = tile % cols, cy = tile / cols;
+            for (int d : NAV_BFS_DIRS) {
+                int nx = cx + NAV_DX[d], ny = cy + NAV_DY[d];
+                if (!walk(nx, ny)) continue;
+                int nb = out.tileIndex[ny * cols + nx];
+                if (dst[nb] != NAV_UNREACHABLE) continue;
+                dst[nb] = dst[cur] + 1;
+                hop[nb] = (cur == src) ? (unsigned char)d : hop[cur];
+                bfs[tail++] = nb;
+            }
+        }
+    }
+}
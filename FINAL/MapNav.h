@@ -0,0 +1,79 @@
+#pragma once
+#ifndef MAP_NAV_H
+#define MAP_NAV_H
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+// -------------------- Navigation Tables --------------------
+// Direction order matches Pacman::Direction (LEFT, RIGHT, DOWN, UP)
+constexpr int NAV_DX[4] = { -1, 1, 0, 0 };
+constexpr int NAV_DY[4] = { 0, 0, 1, -1 };
+// Same neighbour order as the BFS in navigateToTile / backtrackToGate: up, down, left, right
+constexpr int NAV_BFS_DIRS[4] = { 3, 2, 0, 1 };
+const unsigned char NAV_NONE = 0xFF;
+const unsigned short NAV_UNREACHABLE = 0xFFFF;
+
+// All-pairs tables grow with walkable^2, so big mazes only get the per-tile ones
+const int NAV_MAX_ALL_PAIRS = 1024;
+
+// A tile is walkable for the AI when it is not a wall or part of the ghost house
+constexpr bool IsNavWalkable(char c) { return c != '#' && c != 'G'; }
+
+// Read-only view of a maze's precomputed navigation data. The arrays are not
+// owned: they point into a mapped .pmap file or a MapNavStorage.
+// Next hops follow the same BFS order as navigateToTile (up, down, left, right),
+// so a table lookup picks exactly the step the BFS would have picked.
+struct MapNav {
+    int cols = 0, rows = 0;
+    int walkableCount = 0;
+    int gateX = -1, gateY = -1;                 // tile the gate tables lead to
+
+    const unsigned char* walkMask = nullptr;    // per tile: bit d set if neighbour d is walkable
+    const int* tileIndex = nullptr;             // per tile: dense walkable index, -1 if not walkable
+    const int* indexTile = nullptr;             // dense index -> tile id (y * cols + x)
+    const unsigned char* gateHop = nullptr;     // per tile: direction toward the gate, NAV_NONE if none
+    const unsigned short* gateDist = nullptr;   // per tile: steps to the gate
+    const unsigned char* nextHop = nullptr;     // [from * walkableCount + to], optional
+    const unsigned short* dist = nullptr;       // [from * walkableCount + to], optional
+
+    bool hasAllPairs() const { return nextHop != nullptr; }
+    bool walkable(int x, int y) const;
+
+    // Direction of the first step from (fx,fy) to (tx,ty), or -1 when the
+    // tables can't answer (no all-pairs data, either tile not walkable,
+    // same tile, unreachable). Callers fall back to a BFS.
+    int hopToward(int fx, int fy, int tx, int ty) const;
+
+    // Shortest walk length between two tiles, or -1 when unknown
+    int distance(int fx, int fy, int tx, int ty) const;
+};
+
+// Owns the arrays for tables built at runtime from a text layout
+struct MapNavStorage {
+    vector<unsigned char> walkMask;
+    vector<int> tileIndex;
+    vector<int> indexTile;
+    vector<unsigned char> gateHop;
+    vector<unsigned short> gateDist;
+    vector<unsigned char> nextHop;
+    vector<unsigned short> dist;
+
+    MapNav view(int cols, int rows, int gateX, int gateY) const;
+};
+
+// Nav tables plus the metadata Map would otherwise scan a layout for,
+// computed ahead of time for one exact layout (see DefaultMaze.h)
+struct MapPrebuilt {
+    MapNav nav;
+    int pacStartX = 0, pacStartY = 0;
+    int gateX = 0, gateY = 0;                   // top centre of the ghost house
+    int houseMinX = 0, houseMinY = 0, houseMaxX = 0, houseMaxY = 0;
+    int pelletCount = 0;                        // '.' tiles
+};
+
+void BuildMapNav(const vector<string>& layout, int gateX, int gateY, MapNavStorage& out);
+
+#endif // MAP_NAV_H
@@ -0,0 +1,279 @@
+#include "MazeGenerator.h"
+#include "MapNav.h"
+#include "FileIO.h"
+#include <random>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <queue>
+#include <cmath>
+
+using namespace std;
+
+// -------------------- Generation --------------------
+// Cells sit on odd coordinates, walls between them on even ones. The left
+// half (x <= centre) is carved and mirrored, so the maze is symmetric and
+// never gets a 2x2 open block.
+vector<string> GenerateMazeCandidate(int cols, int rows, uint32_t seed, float loopChance) {
+    cols = max(15, cols | 1);
+    rows = max(15, rows | 1);
+    mt19937 rng(seed);
+
+    vector<string> m(rows, string(cols, '#'));
+    int cx = cols / 2;                          // centre column (even)
+    int cy = (rows / 2) | 1;                    // house centre row (odd)
+    if (cy + 4 > rows - 2) cy -= 2;
+
+    // Ring of empty floor around the ghost house
+    int ringL = cx - 3, ringR = cx + 3, ringT = cy - 2, ringB = cy + 2;
+    auto inRing = [&](int x, int y) { return x >= ringL && x <= ringR && y >= ringT && y <= ringB; };
+    auto isCell = [&](int x, int y) { return x > 0 && y > 0 && x < cols - 1 && y < rows - 1 && (x & 1) && (y & 1); };
+
+    // Left half cells, ring cells start visited
+    int halfCols = cx;                          // cells with x < cx
+    vector<char> visited(rows * cols, 0);
+    vector<pair<int, int>> stack;
+    for (int y = ringT; y <= ringB; y++)
+        for (int x = ringL; x <= cx; x++)
+            if (isCell(x, y) && (x == ringL || y == ringT || y == ringB)) {
+                visited[y * cols + x] = 1;
+                stack.push_back({ x, y });
+            }
+    shuffle(stack.begin(), stack.end(), rng);
+
+    auto open = [&](int x, int y) { m[y][x] = '.'; };
+
+    // Randomised DFS (recursive backtracker) over the left half
+    const int dx[4] = { -2, 2, 0, 0 }, dy[4] = { 0, 0, 2, -2 };
+    while (!stack.empty()) {
+        auto cur = stack.back();
+        int order[4] = { 0, 1, 2, 3 };
+        shuffle(order, order + 4, rng);
+        bool moved = false;
+        for (int d : order) {
+            int nx = cur.first + dx[d], ny = cur.second + dy[d];
+            if (!isCell(nx, ny) || nx >= halfCols || inRing(nx, ny) || visited[ny * cols + nx]) continue;
+            visited[ny * cols + nx] = 1;
+            open(cur.first, cur.second);
+            open(cur.first + dx[d] / 2, cur.second + dy[d] / 2);
+            open(nx, ny);
+            stack.push_back({ nx, ny });
+            moved = true;
+            break;
+        }
+        if (!moved) stack.pop_back();
+    }
+
+    // Links across the centre column; always one on Pacman's row
+    int pacY = cy + 4;
+    for (int y = 1; y < rows - 1; y += 2) {
+        if (inRing(cx, y)) continue;
+        if (y == pacY || uniform_real_distribution<float>(0, 1)(rng) < 0.3f) {
+            open(cx - 1, y);
+            open(cx, y);
+        }
+    }
+
+    auto cellDegree = [&](int x, int y) {
+        int deg = 0;
+        for (int d = 0; d < 4; d++) {
+            int wx = x + dx[d] / 2, wy = y + dy[d] / 2;
+            if (wx == cx) { if (m[wy][wx] != '#') deg++; continue; }
+            if (wy > 0 && wy < rows - 1 && wx > 0 && m[wy][wx] != '#') deg++;
+        }
+        return deg;
+    };
+
+    // Braid: every dead end gets a second way out, plus a few extra loops
+    for (int y = 1; y < rows - 1; y += 2) {
+        for (int x = 1; x < halfCols; x += 2) {
+            if (inRing(x, y)) continue;
+            bool dead = cellDegree(x, y) < 2;
+            if (!dead && uniform_real_distribution<float>(0, 1)(rng) >= loopChance) continue;
+
+            int order[4] = { 0, 1, 2, 3 };
+            shuffle(order, order + 4, rng);
+            for (int d : order) {
+                int nx = x + dx[d], ny = y + dy[d];
+                int wx = x + dx[d] / 2, wy = y + dy[d] / 2;
+                bool crossCentre = (wx == cx);
+                if (!crossCentre && (!isCell(nx, ny) || nx >= halfCols)) continue;
+                if (inRing(wx, wy) || m[wy][wx] != '#') continue;
+                if (crossCentre && inRing(cx, y)) continue;
+                open(wx, wy);
+                break;
+            }
+        }
+    }
+
+    // Mirror the left half onto the right
+    for (int y = 0; y < rows; y++)
+        for (int x = 0; x < cx; x++)
+            m[y][cols - 1 - x] = m[y][x];
+
+    // Ring (no pellets) and ghost house, same shape as the classic maze
+    for (int y = ringT; y <= ringB; y++)
+        for (int x = ringL; x <= ringR; x++)
+            m[y][x] = ' ';
+    for (int x = cx - 2; x <= cx + 2; x++) { m[cy - 1][x] = 'G'; m[cy + 1][x] = 'G'; }
+    m[cy][cx - 2] = '#'; m[cy][cx + 2] = '#';
+    for (int x = cx - 1; x <= cx + 1; x++) m[cy][x] = 'G';
+
+    // Energizers in the corners, Pacman below the house
+    m[1][1] = m[1][cols - 2] = m[rows - 2][1] = m[rows - 2][cols - 2] = 'O';
+    m[pacY][cx] = 'P';
+    return m;
+}
+
+// -------------------- Validation --------------------
+static bool findGate(const vector<string>& m, int& gx, int& gy) {
+    int minX = INT32_MAX, maxX = -1, minY = INT32_MAX;
+    for (int y = 0; y < (int)m.size(); y++)
+        for (int x = 0; x < (int)m[y].size(); x++)
+            if (m[y][x] == 'G') { minX = min(minX, x); maxX = max(maxX, x); minY = min(minY, y); }
+    if (maxX < 0) return false;
+    gx = (minX + maxX) / 2;
+    gy = minY;
+    return true;
+}
+
+bool ValidateMaze(const vector<string>& layout, string* why) {
+    auto fail = [&](const string& reason) { if (why) *why = reason; return false; };
+
+    if (layout.empty()) return fail("empty layout");
+    int rows = (int)layout.size(), cols = (int)layout[0].size();
+    int pacX = -1, pacY = -1;
+    for (int y = 0; y < rows; y++) {
+        if ((int)layout[y].size() != cols) return fail("ragged rows");
+        for (int x = 0; x < cols; x++) {
+            char c = layout[y][x];
+            if (c != '#' && c != '.' && c != 'O' && c != 'G' && c != 'P' && c != ' ') return fail("unknown tile character");
+            if (c == 'P') {
+                if (pacX != -1) return fail("more than one P");
+                pacX = x; pacY = y;
+            }
+        }
+    }
+    if (pacX == -1) return fail("no P");
+
+    int gateX, gateY;
+    if (!findGate(layout, gateX, gateY)) return fail("no ghost house");
+
+    // The same adjacency graph the game navigates on
+    MapNavStorage nav;
+    BuildMapNav(layout, gateX, gateY - 1, nav);
+
+    vector<char> seen(rows * cols, 0);
+    queue<int> q;
+    q.push(pacY * cols + pacX);
+    seen[pacY * cols + pacX] = 1;
+    while (!q.empty()) {
+        int cur = q.front(); q.pop();
+        int x = cur % cols, y = cur / cols;
+        unsigned char mask = nav.walkMask[cur];
+        for (int d = 0; d < 4; d++) {
+            if (!(mask & (1 << d))) continue;
+            int n = (y + NAV_DY[d]) * cols + (x + NAV_DX[d]);
+            if (!seen[n]) { seen[n] = 1; q.push(n); }
+        }
+    }
+
+    for (int y = 0; y < rows; y++)
+        for (int x = 0; x < cols; x++) {
+            char c = layout[y][x];
+            if ((c == '.' || c == 'O') && !seen[y * cols + x]) return fail("unreachable pellet");
+        }
+
+    if (gateY - 1 < 0 || !seen[(gateY - 1) * cols + gateX]) return fail("ghost house gate not connected");
+
+    // Dead ends: any reachable tile with a single way in
+    for (int i = 0; i < rows * cols; i++) {
+        if (!seen[i]) continue;
+        unsigned char mask = nav.walkMask[i];
+        int deg = (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+        if (deg < 2) return fail("dead end at " + to_string(i % cols) + "," + to_string(i / cols));
+    }
+
+    if (why) why->clear();
+    return true;
+}
+
+// -------------------- Scoring --------------------
+float ScoreMaze(const vector<string>& layout) {
+    int rows = (int)layout.size(), cols = (int)layout[0].size();
+    MapNavStorage nav;
+    BuildMapNav(layout, -1, -1, nav);
+
+    int walk = 0, junctions = 0, longStraights = 0;
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < cols; x++) {
+            unsigned char mask = nav.walkMask[y * cols + x];
+            if (nav.tileIndex[y * cols + x] < 0) continue;
+            walk++;
+            int deg = (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+            if (deg >= 3) junctions++;
+        }
+    }
+    if (walk == 0) return -1e9f;
+
+    // Straight runs longer than a third of the maze make chases boring
+    for (int y = 0; y < rows; y++) {
+        int run = 0;
+        for (int x = 0; x < cols; x++) {
+            run = IsNavWalkable(layout[y][x]) ? run + 1 : 0;
+            if (run == cols / 3) longStraights++;
+        }
+    }
+    for (int x = 0; x < cols; x++) {
+        int run = 0;
+        for (int y = 0; y < rows; y++) {
+            run = IsNavWalkable(layout[y][x]) ? run + 1 : 0;
+            if (run == rows / 3) longStraights++;
+        }
+    }
+
+    // Hand-made Pac-Man mazes sit around one junction in three to four tiles
+    float junctionRatio = (float)junctions / walk;
+    float coverage = (float)walk / (rows * cols);
+    return 10.0f - 20.0f * fabsf(junctionRatio - 0.3f) - 15.0f * fabsf(coverage - 0.5f) - 0.5f * longStraights;
+}
+
+// -------------------- Parallel Search --------------------
+vector<string> GenerateMaze(const MazeGenOptions& opts, MazeCandidate* best) {
+    int count = max(1, opts.candidates);
+    vector<MazeCandidate> candidates(count);
+
+    // Workers pull candidate indices; each candidate's seed depends only on its index
+    atomic<int> nextIndex(0);
+    auto work = [&]() {
+        for (int i = nextIndex++; i < count; i = nextIndex++) {
+            MazeCandidate& c = candidates[i];
+            c.layout = GenerateMazeCandidate(opts.cols, opts.rows, opts.seed * 7919u + (uint32_t)i, opts.loopChance);
+            c.valid = ValidateMaze(c.layout, &c.reason);
+            if (c.valid) c.score = ScoreMaze(c.layout);
+        }
+    };
+
+    int threads = opts.threads > 0 ? opts.threads : (int)thread::hardware_concurrency();
+    threads = max(1, min(threads, count));
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+
+    // Best score, lowest index on ties, so the pick never depends on scheduling
+    int bestIndex = -1;
+    for (int i = 0; i < count; i++)
+        if (candidates[i].valid && (bestIndex < 0 || candidates[i].score > candidates[bestIndex].score))
+            bestIndex = i;
+
+    if (bestIndex < 0) return {};
+    if (best) *best = candidates[bestIndex];
+    return candidates[bestIndex].layout;
+}
+
+bool SaveTextMap(const vector<string>& layout, const string& path) {
+    string text;
+    for (const auto& row : layout) text += row + "\n";
+    return WriteFileAtomic(path, text.data(), text.size());
+}
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef MAZE_GENERATOR_H
+#define MAZE_GENERATOR_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Procedural Mazes --------------------
+// Mazes use the same characters as main.cpp: # wall, . pellet, O energizer,
+// G ghost house, P Pacman start, space = empty floor.
+struct MazeGenOptions {
+    int cols = 21, rows = 21;       // rounded up to odd, at least 15
+    int candidates = 32;            // generated and validated in parallel
+    int threads = 0;                // 0 = one per core
+    uint32_t seed = 1;
+    float loopChance = 0.12f;       // extra openings on top of the braided maze
+};
+
+struct MazeCandidate {
+    vector<string> layout;
+    bool valid = false;
+    string reason;                  // why validation failed
+    float score = 0.0f;
+};
+
+// Generates opts.candidates mazes in parallel and returns the best valid one
+// (empty if none passed). Deterministic for a given seed whatever the thread count.
+vector<string> GenerateMaze(const MazeGenOptions& opts, MazeCandidate* best = nullptr);
+
+// One candidate from one seed, left-right symmetric
+vector<string> GenerateMazeCandidate(int cols, int rows, uint32_t seed, float loopChance);
+
+// Every pellet reachable from P over the adjacency graph, the ghost-house gate
+// reachable, and no dead ends in the playable area
+bool ValidateMaze(const vector<string>& layout, string* why = nullptr);
+
+// Higher is better: junction density close to hand-made mazes, long walks
+// between pellets, few long straight corridors
+float ScoreMaze(const vector<string>& layout);
+
+bool SaveTextMap(const vector<string>& layout, const string& path);
+
+#endif // MAZE_GENERATOR_H
@@ -1,5 +1,8 @@
 #include "Menu.h"
+#include "Profiler.h"
+#include "AllocTrack.h"
 #include <cmath>
+#include <algorithm>
 
 bool gameResetFlag = false;  // define the global flag
 
@@ -115,8 +118,65 @@ void DrawHowToScreen(int winW, int winH, Font instructionFont) {
     DrawTextEx(instructionFont, prompt, promptPos, 15.0f, 2.0f, LIGHTGRAY);
 }
 
+// -------------------- I/O Overlay --------------------
+// Top-right corner: main-thread file I/O last frame and worst so far
+void DrawIoStats(int screenWidth, size_t pendingWrites) {
+    const char* text = TextFormat("I/O %.2f ms  worst %.2f ms  queued %d",
+        IoLastFrameMs(), IoWorstFrameMs(), (int)pendingWrites);
+    int w = MeasureText(text, 14);
+    DrawRectangle(screenWidth - w - 16, 44, w + 12, 20, Fade(BLACK, 0.7f));
+    DrawText(text, screenWidth - w - 10, 47, 14, IoLastFrameMs() > 1.0 ? RED : GREEN);
+}
+
+// -------------------- Profiler Overlay --------------------
+// Left side: last / average / p99 per zone over the last PROFILE_HISTORY
+// frames (and last frame's allocations with --track-allocs), then one bar
+// per frame against the 60 fps budget line
+void DrawProfilerOverlay(int screenHeight) {
+    const int x = 10, rowH = 14, fontSize = 12;
+    const int graphH = 60;
+    bool allocs = AllocTrackingEnabled();
+    int panelW = PROFILE_HISTORY + 20 + (allocs ? 50 : 0);
+    int panelH = (PZ_COUNT + 3) * rowH + graphH + 24;
+    int y = max(50, screenHeight - panelH - 50);
+
+    DrawRectangle(x, y, panelW, panelH, Fade(BLACK, 0.75f));
+    const int col[4] = { x + 6, x + 100, x + 150, x + 200 };     // name, last, avg, p99
+    int ty = y + 6;
+    const char* header[4] = { "zone (ms)", "last", "avg", "p99" };
+    for (int i = 0; i < 4; i++) DrawText(header[i], col[i], ty, fontSize, LIGHTGRAY);
+    if (allocs) DrawText("allocs", x + 250, ty, fontSize, LIGHTGRAY);
+    if (profiler.isTracing()) DrawText("REC", x + panelW - 30, ty, fontSize, RED);
+    ty += rowH + 2;
+
+    for (int z = 0; z <= PZ_COUNT; z++) {
+        ProfileStats s = profiler.stats(z);
+        Color c = z == PZ_COUNT ? (s.p99Ms > PROFILE_FRAME_BUDGET_MS ? RED : GREEN) : WHITE;
+        DrawText(ProfileZoneName(z), col[0], ty, fontSize, c);
+        DrawText(TextFormat("%.2f", s.lastMs), col[1], ty, fontSize, c);
+        DrawText(TextFormat("%.2f", s.avgMs), col[2], ty, fontSize, c);
+        DrawText(TextFormat("%.2f", s.p99Ms), col[3], ty, fontSize, c);
+        if (allocs) {
+            AllocCounts a = z == PZ_COUNT ? AllocLastFrame() : AllocLastFrameInZone(z);
+            DrawText(TextFormat("%d", (int)a.count), x + 250, ty, fontSize, a.count ? ORANGE : c);
+        }
+        ty += rowH;
+    }
+
+    // Frame graph, newest on the right; the scale is twice the budget
+    int gx = x + 10, gy = ty + 6;
+    float scale = graphH / (float)(2.0 * PROFILE_FRAME_BUDGET_MS);
+    int budgetY = gy + graphH - (int)(PROFILE_FRAME_BUDGET_MS * scale);
+    for (int i = 0; i < profiler.frames(); i++) {
+        float ms = profiler.frameMs(i);
+        int h = min(graphH, (int)(ms * scale) + 1);
+        DrawRectangle(gx + PROFILE_HISTORY - 1 - i, gy + graphH - h, 1, h, ms > PROFILE_FRAME_BUDGET_MS ? RED : SKYBLUE);
+    }
+    DrawLine(gx, budgetY, gx + PROFILE_HISTORY, budgetY, YELLOW);
+}
+
 // -------------------- Enter Name --------------------
-void DrawEnterNameScreen(int winW, int winH, Font titleFont, string& playerName) {
+void DrawEnterNameScreen(int winW, int winH, Font titleFont, string& playerName, const NameSearch& search) {
     ClearBackground(BLACK);
 
     const char* title = "ENTER YOUR NAME";
@@ -154,11 +214,30 @@ void DrawEnterNameScreen(int winW, int winH, Font titleFont, string& playerName)
     Vector2 instr2Size = MeasureTextEx(titleFont, instr2, 15.0f, 2.0f);
     Vector2 instr2Pos = { (winW - instr2Size.x) / 2.0f, boxY + boxH + 110.0f };
     DrawTextEx(titleFont, instr2, instr2Pos, 15.0f, 2.0f, LIGHTGRAY);
+
+    // Players whose name starts with what has been typed, best first
+    if (search.matchCount == 0) return;
+    float listY = boxY + boxH + 150.0f;
+    const char* header = TextFormat("%d PLAYER%s MATCH  (TAB TO FILL IN)", (int)search.matchCount,
+        search.matchCount == 1 ? "" : "S");
+    Vector2 headerSize = MeasureTextEx(titleFont, header, 13.0f, 2.0f);
+    DrawTextEx(titleFont, header, { (winW - headerSize.x) / 2.0f, listY }, 13.0f, 2.0f, GRAY);
+
+    for (size_t i = 0; i < search.matches.size(); i++) {
+        const NameMatch& m = search.matches[i];
+        Color color = (m.name == playerName) ? YELLOW : WHITE;
+        float y = listY + 25.0f + i * 22.0f;
+        DrawTextEx(titleFont, m.name.c_str(), { boxX, y }, 15.0f, 2.0f, color);
+        const char* best = TextFormat("%d", m.best);
+        Vector2 bestSize = MeasureTextEx(titleFont, best, 15.0f, 2.0f);
+        DrawTextEx(titleFont, best, { boxX + boxW - bestSize.x, y }, 15.0f, 2.0f, color);
+    }
 }
 
 // -------------------- Loading Screen --------------------
 
-void DrawLoadingScreen(float& pacX, Font titleFont) {
+// Pacman eats its way along the box as assets finish loading
+void DrawLoadingScreen(float& pacX, Font titleFont, float progress) {
     loadingFrame++;
     ClearBackground(YELLOW);
 
@@ -180,9 +259,10 @@ void DrawLoadingScreen(float& pacX, Font titleFont) {
     }
 
     float mouthAngle = (loadingFrame % 20 < 10) ? 45.0f : 10.0f;
-    pacX += 4.0f;
-    if (pacX > boxX + boxW - 40)
-        pacX = boxX + 20;
+    float startX = boxX + 20.0f;
+    float targetX = startX + progress * (boxW - 60.0f);
+    if (pacX < startX || pacX > targetX) pacX = startX;     // a new loading screen starts over
+    pacX = min(targetX, pacX + 6.0f);
 
     DrawCircleSector({ pacX, (float)pelletY }, 24, mouthAngle, 360 - mouthAngle, 40, YELLOW);
 
@@ -212,16 +292,12 @@ void DrawExitScreen(int winW, int winH, Font titleFont, int& gameOverTimer) {
 
 // -------------------- Reset Game --------------------
 void resetGame(Map& maze, Pacman& pac, RedGhost& red, PinkGhost& pink, OrangeGhost& orange, BlueGhost& blue,
-    vector<string>& originalLayout, int tileSize, int& frightenedTimer,
+    int tileSize, int& frightenedTimer,
     int& globalFrames, int& waveTimer, bool& scatterMode,
     ReleaseInfo& redRelease, ReleaseInfo& pinkRelease, ReleaseInfo& orangeRelease, ReleaseInfo& blueRelease,
     int& pacEnergizerTimer)
 {
-    maze.layout = originalLayout;
-    maze.coins = CoinList();
-    for (int y = 0; y < maze.rows; y++)
-        for (int x = 0; x < maze.cols; x++)
-            if (maze.layout[y][x] == '.') maze.coins.addCoin(x, y);
+    maze.reset();
 
     pac.x = pac.startXPos;
     pac.y = pac.startYPos;
@@ -234,10 +310,10 @@ void resetGame(Map& maze, Pacman& pac, RedGhost& red, PinkGhost& pink, OrangeGho
     pac.energizer_timer = 0;
     pac.score = 0;
 
-    red.position = { 10.f * tileSize, 8.f * tileSize };
-    pink.position = { 9.f * tileSize, 9.f * tileSize };
-    orange.position = { 10.f * tileSize, 9.f * tileSize };
-    blue.position = { 11.f * tileSize, 9.f * tileSize };
+    red.position = { (float)red.cageX * tileSize, (float)red.cageY * tileSize };
+    pink.position = { (float)pink.cageX * tileSize, (float)pink.cageY * tileSize };
+    orange.position = { (float)orange.cageX * tileSize, (float)orange.cageY * tileSize };
+    blue.position = { (float)blue.cageX * tileSize, (float)blue.cageY * tileSize };
     red.frightened_mode = pink.frightened_mode = orange.frightened_mode = blue.frightened_mode = 0;
 
     redRelease.state = R_ACTIVE;
@@ -28,19 +28,21 @@ public:
 
 // Menu-related drawing functions
 void DrawLives(int lives, int tileSize, int screenWidth);
+void DrawIoStats(int screenWidth, size_t pendingWrites);
+void DrawProfilerOverlay(int screenHeight);
 void DrawMenuPacman(float x, float y, float radius, int animFrame, Color pacColor = YELLOW);
 void DrawBlinkingTextFrames(const char* text, Vector2 pos, int fontSize, int spacing, Color color, Font titleFont);
 void DrawLevelSelectScreen(int winW, int winH, Font font, int selected);
 
 void DrawStartScreen(int winW, int winH, Font titleFont, int selectedOption);
 void DrawHowToScreen(int winW, int winH, Font instructionFont);
-void DrawEnterNameScreen(int winW, int winH, Font titleFont, string& playerName);
-void DrawLoadingScreen(float& pacX, Font titleFont);
+void DrawEnterNameScreen(int winW, int winH, Font titleFont, string& playerName, const NameSearch& search);
+void DrawLoadingScreen(float& pacX, Font titleFont, float progress);
 void DrawExitScreen(int winW, int winH, Font titleFont, int& gameOverTimer);
 
 // Reset game function
 void resetGame(Map& maze, Pacman& pac, RedGhost& red, PinkGhost& pink, OrangeGhost& orange, BlueGhost& blue,
-    vector<string>& originalLayout, int tileSize, int& frightenedTimer,
+    int tileSize, int& frightenedTimer,
     int& globalFrames, int& waveTimer, bool& scatterMode,
     ReleaseInfo& redRelease, ReleaseInfo& pinkRelease, ReleaseInfo& orangeRelease, ReleaseInfo& blueRelease,
     int& pacEnergizerTimer);
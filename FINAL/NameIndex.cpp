@@ -0,0 +1,170 @@
+#include "NameIndex.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <chrono>
+
+using namespace std;
+
+// The character after depth, or -1 when the name ends there (it sorts first)
+static int CharAt(const string& s, size_t depth) {
+    return depth < s.size() ? (unsigned char)s[depth] : -1;
+}
+
+// -------------------- NameIndex --------------------
+void NameIndex::build(vector<NameMatch> players) {
+    sort(players.begin(), players.end(), [](const NameMatch& a, const NameMatch& b) { return a.name < b.name; });
+    names.clear();
+    bests.clear();
+    names.reserve(players.size());
+    bests.reserve(players.size());
+    for (auto& p : players) {
+        names.push_back(move(p.name));
+        bests.push_back(p.best);
+    }
+    rebuildBlocks(0);
+    changes++;
+}
+
+void NameIndex::update(const string& name, int best) {
+    size_t i = lower_bound(names.begin(), names.end(), name) - names.begin();
+    if (i < names.size() && names[i] == name) {
+        bests[i] = best;    // ranges are unchanged, but cached matches are stale
+        blockBests[i / NAME_BLOCK] = max(blockBests[i / NAME_BLOCK], best);
+    }
+    else {
+        // O(n) shift, but only once per new player
+        names.insert(names.begin() + i, name);
+        bests.insert(bests.begin() + i, best);
+        rebuildBlocks(i);
+    }
+    changes++;
+}
+
+void NameIndex::rebuildBlocks(size_t fromName) {
+    size_t first = fromName / NAME_BLOCK;
+    blockBests.resize((bests.size() + NAME_BLOCK - 1) / NAME_BLOCK);
+    for (size_t b = first; b < blockBests.size(); b++) {
+        size_t end = min(bests.size(), (b + 1) * NAME_BLOCK);
+        int m = bests[b * NAME_BLOCK];
+        for (size_t i = b * NAME_BLOCK + 1; i < end; i++) m = max(m, bests[i]);
+        blockBests[b] = m;
+    }
+}
+
+NameIndex::Range NameIndex::prefixRange(const string& prefix) const {
+    Range r = all();
+    for (size_t d = 0; d < prefix.size() && r.first < r.second; d++) r = narrow(r, d, prefix[d]);
+    return r;
+}
+
+NameIndex::Range NameIndex::narrow(Range range, size_t depth, char c) const {
+    int key = (unsigned char)c;
+    auto first = names.begin() + range.first;
+    auto last = names.begin() + range.second;
+    auto lo = lower_bound(first, last, key, [depth](const string& s, int k) { return CharAt(s, depth) < k; });
+    auto hi = upper_bound(lo, last, key, [depth](int k, const string& s) { return k < CharAt(s, depth); });
+    return { (size_t)(lo - names.begin()), (size_t)(hi - names.begin()) };
+}
+
+void NameIndex::topMatches(Range range, int k, vector<NameMatch>& out) const {
+    out.clear();
+    if (k <= 0) return;
+
+    // A scan keeping the k best indices; once k are found, whole blocks
+    // that can't beat the worst of them are skipped
+    vector<size_t> top;
+    top.reserve(k + 1);
+    for (size_t i = range.first; i < range.second; i++) {
+        bool full = (int)top.size() == k;
+        if (full && i % NAME_BLOCK == 0 && blockBests[i / NAME_BLOCK] <= bests[top.back()]) {
+            i += NAME_BLOCK - 1;
+            continue;
+        }
+        if (full && bests[i] <= bests[top.back()]) continue;
+        size_t at = top.size();
+        while (at > 0 && bests[i] > bests[top[at - 1]]) at--;
+        top.insert(top.begin() + at, i);
+        if ((int)top.size() > k) top.pop_back();
+    }
+    for (size_t i : top) out.push_back({ names[i], bests[i] });
+}
+
+// -------------------- NameSearch --------------------
+void NameSearch::clear() {
+    typed.clear();
+    ranges.clear();
+    matches.clear();
+    matchCount = 0;
+}
+
+void NameSearch::update(const NameIndex& index, const string& prefix) {
+    if (indexVersion != index.version() || ranges.empty()) {
+        typed.clear();
+        ranges.assign(1, index.all());
+        indexVersion = index.version();
+    }
+    else if (prefix == typed) {
+        return;
+    }
+
+    // Keep the ranges for the part still typed the same, then narrow for the rest
+    size_t common = 0;
+    while (common < typed.size() && common < prefix.size() && typed[common] == prefix[common]) common++;
+    ranges.resize(common + 1);
+    for (size_t d = common; d < prefix.size(); d++) ranges.push_back(index.narrow(ranges.back(), d, prefix[d]));
+    typed = prefix;
+
+    // Nothing typed yet: suggesting every player isn't useful
+    NameIndex::Range r = ranges.back();
+    matchCount = prefix.empty() ? 0 : r.second - r.first;
+    if (matchCount == 0) matches.clear();
+    else index.topMatches(r, MAX_MATCHES, matches);
+}
+
+// -------------------- Benchmark --------------------
+void BenchmarkNameSearch(int n) {
+    mt19937 rng(99);
+    vector<NameMatch> players;
+    players.reserve(n);
+    for (int i = 0; i < n; i++) {
+        string name;
+        int len = 3 + rng() % 8;
+        for (int c = 0; c < len; c++) name += (char)('A' + rng() % 26);
+        players.push_back({ name, (int)(rng() % 100000) });
+    }
+
+    using Clock = chrono::steady_clock;
+    auto us = [](Clock::time_point a, Clock::time_point b) { return chrono::duration<double, micro>(b - a).count(); };
+
+    auto t0 = Clock::now();
+    NameIndex index;
+    index.build(players);
+    auto t1 = Clock::now();
+
+    // Type a few names character by character, then erase them again
+    const int words = 1000;
+    int keystrokes = 0;
+    double worst = 0;
+    size_t checksum = 0;
+    NameSearch search;
+    auto t2 = Clock::now();
+    for (int w = 0; w < words; w++) {
+        const string& target = players[rng() % n].name;
+        string typed;
+        for (int step = 0; step < 2 * (int)target.size(); step++) {
+            if (step < (int)target.size()) typed += target[step];
+            else typed.pop_back();
+            auto k0 = Clock::now();
+            search.update(index, typed);
+            worst = max(worst, us(k0, Clock::now()));
+            checksum += search.matchCount;
+            keystrokes++;
+        }
+    }
+    auto t3 = Clock::now();
+
+    cout << n << " names: build " << us(t0, t1) / 1000.0 << " ms\n"
+        << "search as you type: " << us(t2, t3) / keystrokes << " us per keystroke, worst "
+        << worst << " us (" << keystrokes << " keystrokes, checksum " << checksum << ")\n";
+}
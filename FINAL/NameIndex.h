@@ -0,0 +1,72 @@
+#pragma once
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstddef>
+
+using namespace std;
+
+struct NameMatch {
+    string name;
+    int best;
+};
+
+const size_t NAME_BLOCK = 64;
+
+// -------------------- Name Index --------------------
+// Every player name in sorted order next to their best score. Names sharing
+// a prefix are one contiguous range, so a prefix is found by binary search
+// and typing one more character only narrows the range it already has.
+class NameIndex {
+public:
+    typedef pair<size_t, size_t> Range;     // [first, last)
+
+    void build(vector<NameMatch> players);
+    void update(const string& name, int best);  // a new name or a new best
+
+    size_t size() const { return names.size(); }
+    unsigned version() const { return changes; }    // bumped whenever ranges shift
+
+    Range all() const { return { 0, names.size() }; }
+    Range prefixRange(const string& prefix) const;
+    // Names in range all share their first depth characters; keeps those whose next one is c
+    Range narrow(Range range, size_t depth, char c) const;
+
+    // The k best players in range, best first (earlier name first on ties)
+    void topMatches(Range range, int k, vector<NameMatch>& out) const;
+
+private:
+    vector<string> names;
+    vector<int> bests;          // bests[i] belongs to names[i]
+    vector<int> blockBests;     // max of bests per NAME_BLOCK names, lets topMatches skip blocks
+    unsigned changes = 0;
+
+    void rebuildBlocks(size_t fromName);
+};
+
+// -------------------- Search As You Type --------------------
+// Keeps one range per typed character: appending narrows the last one and
+// backspace just drops it, so a keystroke never rescans the index.
+class NameSearch {
+public:
+    static const int MAX_MATCHES = 5;
+
+    vector<NameMatch> matches;      // best first
+    size_t matchCount = 0;          // all names with the prefix, not just those shown
+
+    void update(const NameIndex& index, const string& prefix);
+    void clear();
+
+private:
+    string typed;
+    vector<NameIndex::Range> ranges;    // ranges[i] matches typed.substr(0, i)
+    unsigned indexVersion = 0;
+};
+
+// Times prefix searches over n random names
+void BenchmarkNameSearch(int n);
+
+#endif // NAME_INDEX_H
@@ -0,0 +1,159 @@
+#include "Net.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET NativeSocket;
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+typedef int NativeSocket;
+#endif
+
+static NativeSocket Native(intptr_t h) { return (NativeSocket)h; }
+
+// A peer that hung up must not kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+// WSAStartup once per process; a no-op elsewhere
+static bool NetInit() {
+#ifdef _WIN32
+    static bool ok = []() {
+        WSADATA wsa;
+        return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+    }();
+    return ok;
+#else
+    return true;
+#endif
+}
+
+static sockaddr_in LoopbackAddress(int port) {
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((unsigned short)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+// -------------------- NetSocket --------------------
+NetSocket::~NetSocket() {
+    close();
+}
+
+NetSocket& NetSocket::operator=(NetSocket&& other) noexcept {
+    if (this == &other) return *this;
+    close();
+    handle = other.handle;
+    other.handle = INVALID;
+    return *this;
+}
+
+bool NetSocket::listen(int port) {
+    close();
+    if (!NetInit()) return false;
+
+    intptr_t s = (intptr_t)::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID) return false;
+    handle = s;
+
+    // Only one server may own the port. On POSIX SO_REUSEADDR just allows a
+    // restart while old connections sit in TIME_WAIT; on Winsock it would let
+    // a second process bind the same port, so ask for exclusive use instead
+    int yes = 1;
+#ifdef _WIN32
+    setsockopt(Native(handle), SOL_SOCKET, SO_EXCLUSIVEADDRUSE, (const char*)&yes, sizeof(yes));
+#else
+    setsockopt(Native(handle), SOL_SOCKET, SO_REUSEADDR, (const char*)&yes, sizeof(yes));
+#endif
+
+    sockaddr_in addr = LoopbackAddress(port);
+    if (::bind(Native(handle), (sockaddr*)&addr, sizeof(addr)) != 0 ||
+        ::listen(Native(handle), 16) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+NetSocket NetSocket::accept() {
+    NetSocket client;
+    if (!isOpen()) return client;
+    intptr_t s = (intptr_t)::accept(Native(handle), nullptr, nullptr);
+    if (s == INVALID) return client;
+    client.handle = s;
+
+    // Requests are tiny; don't let Nagle hold them back
+    int yes = 1;
+    setsockopt(Native(s), IPPROTO_TCP, TCP_NODELAY, (const char*)&yes, sizeof(yes));
+    return client;
+}
+
+bool NetSocket::connect(int port) {
+    close();
+    if (!NetInit()) return false;
+
+    intptr_t s = (intptr_t)::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == INVALID) return false;
+    handle = s;
+
+    sockaddr_in addr = LoopbackAddress(port);
+    if (::connect(Native(handle), (sockaddr*)&addr, sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+    int yes = 1;
+    setsockopt(Native(handle), IPPROTO_TCP, TCP_NODELAY, (const char*)&yes, sizeof(yes));
+    return true;
+}
+
+bool NetSocket::sendAll(const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        int sent = (int)::send(Native(handle), p, (int)len, SEND_FLAGS);
+        if (sent <= 0) return false;
+        p += sent;
+        len -= (size_t)sent;
+    }
+    return true;
+}
+
+bool NetSocket::recvAll(void* data, size_t len) {
+    char* p = (char*)data;
+    while (len > 0) {
+        int got = (int)::recv(Native(handle), p, (int)len, 0);
+        if (got <= 0) return false;
+        p += got;
+        len -= (size_t)got;
+    }
+    return true;
+}
+
+void NetSocket::shutdown() {
+    if (!isOpen()) return;
+#ifdef _WIN32
+    ::shutdown(Native(handle), SD_BOTH);
+#else
+    ::shutdown(Native(handle), SHUT_RDWR);
+#endif
+}
+
+void NetSocket::close() {
+    if (!isOpen()) return;
+#ifdef _WIN32
+    closesocket(Native(handle));
+#else
+    ::close(Native(handle));
+#endif
+    handle = INVALID;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#ifndef NET_H
+#define NET_H
+
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+// Kept free of raylib.h: winsock2.h clashes with it, like windows.h in FileIO.
+
+// -------------------- Loopback Socket --------------------
+// Blocking TCP socket bound to 127.0.0.1 only, for talking to local processes.
+class NetSocket {
+public:
+    NetSocket() = default;
+    ~NetSocket();
+    NetSocket(const NetSocket&) = delete;
+    NetSocket& operator=(const NetSocket&) = delete;
+    NetSocket(NetSocket&& other) noexcept : handle(other.handle) { other.handle = INVALID; }
+    NetSocket& operator=(NetSocket&& other) noexcept;
+
+    bool listen(int port);                  // 127.0.0.1:port
+    NetSocket accept();                     // blocks; closed socket on failure
+    bool connect(int port);                 // to 127.0.0.1:port
+
+    bool sendAll(const void* data, size_t len);
+    bool recvAll(void* data, size_t len);   // false on error or when the peer closed
+
+    void shutdown();                        // wakes a thread blocked in accept/recv
+    void close();
+    bool isOpen() const { return handle != INVALID; }
+
+private:
+    static const intptr_t INVALID = -1;
+    intptr_t handle = INVALID;
+};
+
+#endif // NET_H
@@ -1,5 +1,7 @@
 #include "Pacman.h"
 #include "Map.h" // needed for Map methods
+#include "Audio.h"
+#include "AllocTrack.h"
 #include <cmath>
 #include <algorithm>
 
@@ -17,13 +19,15 @@ Pacman::Pacman(int startX, int startY, int tSize)
     startXPos = (float)x;
     startYPos = (float)y;
     speed = NORMAL_SPEED;
+    baseSpeed = NORMAL_SPEED;
+    energizerFrames = GameConstants::FRIGHTENED_TOTAL_FRAMES;
     isHard = false;
 
 }
 
 void Pacman::setHardMode(bool hard) {
     isHard = hard;
-    speed = isHard ? HARD_SPEED : NORMAL_SPEED;
+    speed = isHard ? baseSpeed + (HARD_SPEED - NORMAL_SPEED) : baseSpeed;
 }
 
 void Pacman::resetPosition() {
@@ -68,9 +72,10 @@ void Pacman::checkLargePellet(Map& map) {
     int gx = (int)((x + tileSize * 0.5f) / tileSize);
     int gy = (int)((y + tileSize * 0.5f) / tileSize);
     if (gx >= 0 && gx < map.cols && gy >= 0 && gy < map.rows &&
-        map.layout[gy][gx] == 'O') {
+        map.tile(gx, gy) == 'O') {
         map.eatLargePelletAt(gx, gy);
-        energizer_timer = 7 * 60;  // 7 seconds
+        energizer_timer = energizerFrames;  // 7 seconds on the classic level
+        PlaySfx(SFX_PELLET);
     }
 }
 
@@ -137,7 +142,10 @@ void Pacman::updatePacMan(Map& map, CoinList& coins) {
     int eatGX = (int)((x + tileSize / 2) / tileSize);
     int eatGY = (int)((y + tileSize / 2) / tileSize);
 
-    if (map.coins.eatCoinAt(eatGX, eatGY)) score += 50;
+    if (map.eatCoinAt(eatGX, eatGY)) {
+        score += 50;
+        PlaySfx(SFX_PELLET);
+    }
 
     checkLargePellet(map);
 
@@ -178,6 +186,7 @@ bool PowerUp::operator<(const PowerUp& other) const {
 }
 
 void processMysteryPowerUp(Pacman& pac) {
+    ScopedAllocSite allocSite("processMysteryPowerUp");
     priority_queue<PowerUp> pq;
     const int maxLives = 3;
 
@@ -19,6 +19,7 @@ public:
     float x, y;
     int tileSize;
     float speed;
+    float baseSpeed;        // easy-mode speed for the current level
     float radius;
 
     // Game state
@@ -32,11 +33,12 @@ public:
     bool alive;
     bool dying;
     int death_timer;
-    const int DEATH_FRAMES = 30;
+    static constexpr int DEATH_FRAMES = 30;
     float startXPos, startYPos;
     bool animation_over;
     unsigned short animation_timer;
     unsigned short energizer_timer;
+    int energizerFrames;    // frightened duration for the current level
     
 
     // Directions
@@ -0,0 +1,290 @@
+#include "PacmanEnv.h"
+#include "PacmanEnvC.h"
+#include "DefaultMaze.h"
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+// -------------------- PacmanEnv --------------------
+bool PacmanEnv::open(const EnvConfig& cfg) {
+    config = cfg;
+    config.frameSkip = max(1, config.frameSkip);
+    LevelInfo& level = config.level;
+    if (level.layout.empty() && level.mapPath.empty() && level.genCols <= 0) {
+        level.name = "Classic";
+        level.layout = DefaultMaze::Layout();
+    }
+
+    unique_ptr<Map> map = BuildLevelMap(level, TILE_SIZE);
+    if (!map) {
+        cout << "Environment: level '" << level.name << "' failed to load\n";
+        return false;
+    }
+    world.reset(new GameWorld(move(*map), Texture2D(), TILE_SIZE));
+    SetGameDifficulty(*world, config.hard);
+    ResetGameWorld(*world, level);
+
+    // Walls and energizer spots never change within an episode
+    Map& maze = world->maze;
+    wallPlane.assign((size_t)maze.rows * maze.cols, 0.0f);
+    energizerTiles.clear();
+    for (int y = 0; y < maze.rows; y++) {
+        for (int x = 0; x < maze.cols; x++) {
+            if (maze.isWall(x, y)) wallPlane[(size_t)y * maze.cols + x] = 1.0f;
+            if (maze.tile(x, y) == 'O') energizerTiles.push_back(y * maze.cols + x);
+        }
+    }
+    return true;
+}
+
+bool PacmanEnv::isOver() const {
+    return world->pac.lives <= 0 || world->maze.pelletsLeft <= 0;
+}
+
+void PacmanEnv::reset(uint32_t seed, float* observation) {
+    ResetGameWorld(*world, config.level);
+    stepCount = 0;
+
+    // Every chunk's coins up front, so observe() only has to walk the coin lists
+    for (MapChunk& c : world->maze.chunks)
+        if (!c.loaded) world->maze.loadChunk(c);
+
+    // A few frames of random drift so seeds give different starts
+    mt19937 rng(seed);
+    int drift = (int)(rng() % (ENV_NOOP_START_FRAMES + 1));
+    world->pac.desiredDirection = (Pacman::Direction)(rng() % 4);
+    for (int f = 0; f < drift && !isOver(); f++) UpdateGameplay(*world, config.level);
+
+    if (observation) observe(observation);
+}
+
+EnvStep PacmanEnv::step(int action, float* observation) {
+    Pacman& pac = world->pac;
+    if (action >= 0 && action < ENV_NOOP) pac.desiredDirection = (Pacman::Direction)action;
+
+    int score = pac.score, lives = pac.lives;
+    for (int f = 0; f < config.frameSkip && !isOver(); f++) UpdateGameplay(*world, config.level);
+    stepCount++;
+
+    EnvStep result;
+    result.reward = (float)(pac.score - score) - config.deathPenalty * (float)(lives - pac.lives);
+    result.done = isOver() || (config.maxSteps > 0 && stepCount >= config.maxSteps);
+    if (observation) observe(observation);
+    return result;
+}
+
+void PacmanEnv::observe(float* obs) const {
+    const Map& maze = world->maze;
+    const int cols = maze.cols, rows = maze.rows;
+    const size_t plane = (size_t)rows * cols;
+    const int tileSize = maze.tileSize;
+
+    copy(wallPlane.begin(), wallPlane.end(), obs + OBS_WALLS * plane);
+    fill(obs + OBS_PELLETS * plane, obs + OBS_CHANNELS * plane, 0.0f);
+
+    // reset() loaded every chunk, so the coin lists hold every pellet left
+    for (const MapChunk& c : maze.chunks)
+        for (CoinNode* n = c.coins.head; n; n = n->next)
+            obs[OBS_PELLETS * plane + (size_t)n->y * cols + n->x] = 1.0f;
+    for (int t : energizerTiles)
+        if (maze.layout[t / cols][t % cols] == 'O') obs[OBS_ENERGIZERS * plane + t] = 1.0f;
+
+    auto tileOf = [&](float px, float py) {
+        int x = min(max((int)((px + tileSize / 2.0f) / tileSize), 0), cols - 1);
+        int y = min(max((int)((py + tileSize / 2.0f) / tileSize), 0), rows - 1);
+        return (size_t)y * cols + x;
+    };
+    obs[OBS_PACMAN * plane + tileOf(world->pac.x, world->pac.y)] = 1.0f;
+
+    const Ghost* ghosts[4] = { &world->red, &world->pink, &world->orange, &world->blue };
+    for (int i = 0; i < 4; i++) {
+        const Ghost& g = *ghosts[i];
+        size_t t = tileOf(g.position.x, g.position.y);
+        obs[(OBS_RED + i) * plane + t] = g.frightened_mode == 2 ? 0.5f : 1.0f;
+        if (g.frightened_mode == 1) obs[OBS_FRIGHTENED * plane + t] = 1.0f;
+    }
+}
+
+// -------------------- PacmanEnvBatch --------------------
+PacmanEnvBatch::~PacmanEnvBatch() {
+    close();
+}
+
+bool PacmanEnvBatch::open(int count, const EnvConfig& config, int threads) {
+    close();
+    if (count < 1) return false;
+    for (int i = 0; i < count; i++) {
+        unique_ptr<PacmanEnv> e(new PacmanEnv());
+        if (!e->open(config)) {
+            envs.clear();
+            return false;
+        }
+        envs.push_back(move(e));
+    }
+    nextSeeds.assign(count, 0);
+
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+    threads = max(1, min(threads, count));
+    quitting = false;
+    for (int i = 1; i < threads; i++) workers.emplace_back([this]() { workerLoop(); });
+    return true;
+}
+
+void PacmanEnvBatch::close() {
+    {
+        lock_guard<mutex> lock(poolMutex);
+        quitting = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) t.join();
+    workers.clear();
+    envs.clear();
+}
+
+void PacmanEnvBatch::reset(uint32_t seed, float* observations) {
+    size_t obsSize = observationSize();
+    for (int i = 0; i < size(); i++) nextSeeds[i] = seed + (uint32_t)i;
+    forEachEnv([&](int i) {
+        envs[i]->reset(nextSeeds[i], observations ? observations + i * obsSize : nullptr);
+        nextSeeds[i] += (uint32_t)size();
+    });
+}
+
+void PacmanEnvBatch::step(const int* actions, float* observations, float* rewards, uint8_t* dones) {
+    size_t obsSize = observationSize();
+    forEachEnv([&](int i) {
+        float* obs = observations ? observations + i * obsSize : nullptr;
+        EnvStep r = envs[i]->step(actions[i], obs);
+        if (r.done) {
+            envs[i]->reset(nextSeeds[i], obs);
+            nextSeeds[i] += (uint32_t)size();
+        }
+        if (rewards) rewards[i] = r.reward;
+        if (dones) dones[i] = r.done ? 1 : 0;
+    });
+}
+
+// Hands perEnv(i) for every environment to the workers and joins in
+void PacmanEnvBatch::forEachEnv(const function<void(int)>& perEnv) {
+    if (workers.empty()) {
+        for (int i = 0; i < size(); i++) perEnv(i);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(poolMutex);
+        job = &perEnv;
+        nextEnv = 0;
+        busyWorkers = (int)workers.size();
+        generation++;
+    }
+    wake.notify_all();
+    runJob(perEnv);
+
+    unique_lock<mutex> lock(poolMutex);
+    finished.wait(lock, [this]() { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+void PacmanEnvBatch::runJob(const function<void(int)>& perEnv) {
+    for (int i = nextEnv.fetch_add(1); i < size(); i = nextEnv.fetch_add(1)) perEnv(i);
+}
+
+void PacmanEnvBatch::workerLoop() {
+    int seen = 0;
+    for (;;) {
+        const function<void(int)>* current;
+        {
+            unique_lock<mutex> lock(poolMutex);
+            wake.wait(lock, [&]() { return quitting || generation != seen; });
+            if (quitting) return;
+            seen = generation;
+            current = job;
+        }
+        runJob(*current);
+        {
+            lock_guard<mutex> lock(poolMutex);
+            if (--busyWorkers == 0) finished.notify_one();
+        }
+    }
+}
+
+// -------------------- Benchmark --------------------
+int BenchmarkEnv(int count, int steps, int threads) {
+    PacmanEnvBatch batch;
+    if (!batch.open(count, EnvConfig(), threads)) return 1;
+
+    vector<float> obs(batch.observationSize() * batch.size());
+    vector<float> rewards(batch.size());
+    vector<uint8_t> dones(batch.size());
+    vector<int> actions(batch.size());
+    mt19937 rng(1);
+
+    batch.reset(1, obs.data());
+    long long episodes = 0;
+    auto start = chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        for (int& a : actions) a = (int)(rng() % ENV_ACTIONS);
+        batch.step(actions.data(), obs.data(), rewards.data(), dones.data());
+        for (uint8_t d : dones) episodes += d;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double total = (double)steps * batch.size();
+    cout << batch.size() << " envs x " << steps << " steps (" << EnvConfig().frameSkip << " frames each, "
+        << episodes << " episodes) in " << seconds << " s: " << total / seconds << " steps/s, "
+        << total / seconds * 3600.0 / 1e6 << "M steps/hour\n";
+    return 0;
+}
+
+// -------------------- C Interface --------------------
+struct PacEnvBatch {
+    PacmanEnvBatch batch;
+};
+
+void pacenv_default_config(PacEnvConfig* config) {
+    EnvConfig defaults;
+    config->mapPath = nullptr;
+    config->hard = defaults.hard ? 1 : 0;
+    config->frameSkip = defaults.frameSkip;
+    config->maxSteps = defaults.maxSteps;
+    config->deathPenalty = defaults.deathPenalty;
+}
+
+PacEnvBatch* pacenv_create(int count, const PacEnvConfig* config, int threads) {
+    EnvConfig cfg;
+    if (config) {
+        if (config->mapPath) {
+            cfg.level.name = config->mapPath;
+            cfg.level.mapPath = config->mapPath;
+        }
+        cfg.hard = config->hard != 0;
+        cfg.frameSkip = config->frameSkip;
+        cfg.maxSteps = config->maxSteps;
+        cfg.deathPenalty = config->deathPenalty;
+    }
+    PacEnvBatch* b = new PacEnvBatch();
+    if (!b->batch.open(count, cfg, threads)) {
+        delete b;
+        return nullptr;
+    }
+    return b;
+}
+
+void pacenv_destroy(PacEnvBatch* batch) { delete batch; }
+
+int pacenv_count(const PacEnvBatch* batch) { return batch->batch.size(); }
+int pacenv_rows(const PacEnvBatch* batch) { return batch->batch.env(0).rows(); }
+int pacenv_cols(const PacEnvBatch* batch) { return batch->batch.env(0).cols(); }
+int pacenv_channels(void) { return OBS_CHANNELS; }
+int pacenv_actions(void) { return ENV_ACTIONS; }
+size_t pacenv_observation_size(const PacEnvBatch* batch) { return batch->batch.observationSize(); }
+
+void pacenv_reset(PacEnvBatch* batch, uint32_t seed, float* observations) {
+    batch->batch.reset(seed, observations);
+}
+
+void pacenv_step(PacEnvBatch* batch, const int* actions, float* observations, float* rewards, uint8_t* dones) {
+    batch->batch.step(actions, observations, rewards, dones);
+}
@@ -0,0 +1,124 @@
+#pragma once
+#ifndef PACMAN_ENV_H
+#define PACMAN_ENV_H
+
+#include "Game.h"
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Reinforcement Learning Environment --------------------
+// Gym-style wrapper around GameWorld: the shipped Map, Pacman and ghost AI,
+// stepped by UpdateGameplay() with no window. An action steers Pacman (it
+// turns at the next tile centre where it can, like a held arrow key); one
+// step plays frameSkip game frames.
+//
+// Observations are float planes written straight into the caller's buffer,
+// channel-major: obs[(channel * rows + y) * cols + x]. A tile is 1 where the
+// channel has something on it, except the ghost planes, which hold 0.5 for
+// ghosts that are only eyes on their way home.
+//
+// Reward is the score gained in the step, minus deathPenalty per life lost.
+// An episode is done on game over, when the level is cleared, or after
+// maxSteps steps.
+enum EnvAction { ENV_LEFT = Pacman::LEFT, ENV_RIGHT = Pacman::RIGHT, ENV_DOWN = Pacman::DOWN, ENV_UP = Pacman::UP,
+    ENV_NOOP, ENV_ACTIONS };
+
+enum EnvChannel {
+    OBS_WALLS, OBS_PELLETS, OBS_ENERGIZERS, OBS_PACMAN,
+    OBS_RED, OBS_PINK, OBS_ORANGE, OBS_BLUE, OBS_FRIGHTENED,
+    OBS_CHANNELS
+};
+
+const int ENV_NOOP_START_FRAMES = 30;   // reset(seed) plays up to this many frames of random drift first
+
+struct EnvConfig {
+    LevelInfo level;            // no map set = the built-in maze
+    bool hard = false;
+    int frameSkip = 4;
+    int maxSteps = 0;           // 0 = no limit
+    float deathPenalty = 500.0f;
+};
+
+struct EnvStep {
+    float reward = 0.0f;
+    bool done = false;
+};
+
+class PacmanEnv {
+public:
+    bool open(const EnvConfig& config);
+
+    int rows() const { return world->maze.rows; }
+    int cols() const { return world->maze.cols; }
+    size_t observationSize() const { return (size_t)OBS_CHANNELS * rows() * cols(); }   // floats
+
+    // observation may be null when only the state is wanted
+    void reset(uint32_t seed, float* observation);
+    EnvStep step(int action, float* observation);
+    void observe(float* observation) const;
+
+    const GameWorld& state() const { return *world; }
+    int steps() const { return stepCount; }
+
+private:
+    EnvConfig config;
+    unique_ptr<GameWorld> world;
+    vector<float> wallPlane;
+    vector<int> energizerTiles;     // y * cols + x of every energizer at the start
+    int stepCount = 0;
+
+    bool isOver() const;
+};
+
+// -------------------- Batch --------------------
+// Many environments stepped together on a pool of threads; the calling
+// thread works too. Buffers hold size() consecutive observations. An
+// environment that finishes starts a new episode straight away (with the next
+// seed in its sequence), so its observation after a done step is the new
+// episode's first one.
+class PacmanEnvBatch {
+public:
+    ~PacmanEnvBatch();
+
+    bool open(int count, const EnvConfig& config, int threads = 0);    // threads 0 = one per core
+    void close();
+
+    int size() const { return (int)envs.size(); }
+    size_t observationSize() const { return envs.empty() ? 0 : envs[0]->observationSize(); }
+    PacmanEnv& env(int i) { return *envs[i]; }
+    const PacmanEnv& env(int i) const { return *envs[i]; }
+
+    // Environment i is seeded with seed + i, and seed + i + k * size() for its k-th automatic reset
+    void reset(uint32_t seed, float* observations);
+    void step(const int* actions, float* observations, float* rewards, uint8_t* dones);
+
+private:
+    vector<unique_ptr<PacmanEnv>> envs;
+    vector<uint32_t> nextSeeds;
+
+    vector<thread> workers;
+    mutex poolMutex;
+    condition_variable wake, finished;
+    const function<void(int)>* job = nullptr;
+    atomic<int> nextEnv{ 0 };
+    int generation = 0;
+    int busyWorkers = 0;
+    bool quitting = false;
+
+    void forEachEnv(const function<void(int)>& perEnv);
+    void runJob(const function<void(int)>& perEnv);
+    void workerLoop();
+};
+
+// Steps a batch of random agents and prints steps per second; returns the exit code
+int BenchmarkEnv(int count, int steps, int threads);
+
+#endif // PACMAN_ENV_H
@@ -0,0 +1,53 @@
+#ifndef PACMAN_ENV_C_H
+#define PACMAN_ENV_C_H
+
+/* -------------------- C interface to PacmanEnvBatch --------------------
+   Plain C, for Python (ctypes / cffi) and other languages. See PacmanEnv.h
+   for observations, rewards and episode ends. Build with PACENV_BUILD_DLL
+   defined to export these from a Windows DLL. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && defined(PACENV_BUILD_DLL)
+#define PACENV_API __declspec(dllexport)
+#else
+#define PACENV_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct PacEnvBatch PacEnvBatch;     /* opaque */
+
+typedef struct PacEnvConfig {
+    const char* mapPath;        /* .pmap or text maze; NULL = the built-in maze */
+    int hard;                   /* 0 = easy, 1 = hard */
+    int frameSkip;              /* game frames per step */
+    int maxSteps;               /* 0 = no limit */
+    float deathPenalty;
+} PacEnvConfig;
+
+PACENV_API void pacenv_default_config(PacEnvConfig* config);
+
+/* NULL if the map could not be loaded; threads 0 = one per core */
+PACENV_API PacEnvBatch* pacenv_create(int count, const PacEnvConfig* config, int threads);
+PACENV_API void pacenv_destroy(PacEnvBatch* batch);
+
+PACENV_API int pacenv_count(const PacEnvBatch* batch);
+PACENV_API int pacenv_rows(const PacEnvBatch* batch);
+PACENV_API int pacenv_cols(const PacEnvBatch* batch);
+PACENV_API int pacenv_channels(void);
+PACENV_API int pacenv_actions(void);
+PACENV_API size_t pacenv_observation_size(const PacEnvBatch* batch);    /* floats per environment */
+
+/* observations: count * pacenv_observation_size floats; rewards, dones: count each */
+PACENV_API void pacenv_reset(PacEnvBatch* batch, uint32_t seed, float* observations);
+PACENV_API void pacenv_step(PacEnvBatch* batch, const int* actions, float* observations, float* rewards, uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PACMAN_ENV_C_H */
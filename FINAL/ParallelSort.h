@@ -0,0 +1,81 @@
+#pragma once
+#ifndef PARALLEL_SORT_H
+#define PARALLEL_SORT_H
+
+#include <vector>
+#include <thread>
+#include <utility>
+#include <cstddef>
+
+using namespace std;
+
+// -------------------- Parallel Merge Sort --------------------
+// Stable merge sort that splits the range into tasks on worker threads and
+// merges through one buffer allocated up front (no allocation per merge).
+// before(a, b) is true when a must come first; equal elements keep their order.
+const size_t PARALLEL_SORT_MIN_TASK = 1 << 14;  // smaller ranges stay on the calling thread
+const size_t PARALLEL_SORT_INSERTION = 32;      // runs this short use insertion sort
+
+template <typename T, typename Before>
+void InsertionSortRange(T* data, size_t left, size_t right, Before& before) {
+    for (size_t i = left + 1; i < right; i++) {
+        T value = move(data[i]);
+        size_t j = i;
+        while (j > left && before(value, data[j - 1])) {
+            data[j] = move(data[j - 1]);
+            j--;
+        }
+        data[j] = move(value);
+    }
+}
+
+// Merges [left, mid) and [mid, right): the left run is moved out to the
+// buffer, then both runs are merged back into place
+template <typename T, typename Before>
+void MergeRange(T* data, T* buffer, size_t left, size_t mid, size_t right, Before& before) {
+    if (!before(data[mid], data[mid - 1])) return;     // already in order
+
+    for (size_t i = left; i < mid; i++) buffer[i] = move(data[i]);
+    size_t i = left, j = mid, k = left;
+    while (i < mid && j < right) {
+        if (before(data[j], buffer[i])) data[k++] = move(data[j++]);
+        else data[k++] = move(buffer[i++]);
+    }
+    while (i < mid) data[k++] = move(buffer[i++]);
+}
+
+template <typename T, typename Before>
+void MergeSortRange(T* data, T* buffer, size_t left, size_t right, Before& before, int splits) {
+    if (right - left <= PARALLEL_SORT_INSERTION) {
+        InsertionSortRange(data, left, right, before);
+        return;
+    }
+    size_t mid = left + (right - left) / 2;
+
+    if (splits > 0 && right - left >= PARALLEL_SORT_MIN_TASK) {
+        // Left half on a new thread, right half here
+        thread worker([&]() { MergeSortRange(data, buffer, left, mid, before, splits - 1); });
+        MergeSortRange(data, buffer, mid, right, before, splits - 1);
+        worker.join();
+    }
+    else {
+        MergeSortRange(data, buffer, left, mid, before, 0);
+        MergeSortRange(data, buffer, mid, right, before, 0);
+    }
+    MergeRange(data, buffer, left, mid, right, before);
+}
+
+// threads = 0 uses one per core
+template <typename T, typename Before>
+void ParallelMergeSort(vector<T>& v, Before before, int threads = 0) {
+    if (v.size() < 2) return;
+    if (threads <= 0) threads = (int)thread::hardware_concurrency();
+
+    int splits = 0;
+    while ((1 << splits) < threads) splits++;
+
+    vector<T> buffer(v.size());
+    MergeSortRange(v.data(), buffer.data(), 0, v.size(), before, splits);
+}
+
+#endif // PARALLEL_SORT_H
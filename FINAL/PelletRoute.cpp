@@ -0,0 +1,547 @@
+#include "PelletRoute.h"
+#include "GameConstants.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <climits>
+
+using namespace std;
+using namespace GameConstants;
+
+static const uint16_t ROUTE_UNREACHABLE = 0xFFFF;
+static const int ROUTE_MAX_PASSES = 200;        // local search passes per thread, a safety net
+
+// -------------------- Distances --------------------
+// Steps from tile to every tile over the nav walk mask, -1 where unreachable
+static void NavBfs(const MapNav& nav, int tile, vector<int>& out, vector<int>& queue) {
+    out.assign((size_t)nav.cols * nav.rows, -1);
+    queue.clear();
+    out[tile] = 0;
+    queue.push_back(tile);
+    for (size_t head = 0; head < queue.size(); head++) {
+        int t = queue[head];
+        unsigned char mask = nav.walkMask[t];
+        for (int d = 0; d < 4; d++) {
+            if (!(mask >> d & 1)) continue;
+            int n = t + NAV_DX[d] + NAV_DY[d] * nav.cols;
+            if (out[n] >= 0) continue;
+            out[n] = out[t] + 1;
+            queue.push_back(n);
+        }
+    }
+}
+
+static uint16_t RouteDistance(int d) {
+    return d < 0 || d >= ROUTE_UNREACHABLE ? ROUTE_UNREACHABLE : (uint16_t)d;
+}
+
+// -------------------- Local Search --------------------
+// One thread's route, kept as seq[0] = start followed by the pellets, with
+// pos[node] = index in seq
+struct RouteSearch {
+    const uint16_t* dist;
+    int stride;                 // nodeCount + 1
+    int start;                  // node id of the start
+    const vector<int>* neighbours;
+    vector<int> seq, pos;
+
+    int d(int a, int b) const { return dist[(size_t)a * stride + b]; }
+
+    int length() const {
+        int total = 0;
+        for (size_t i = 0; i + 1 < seq.size(); i++) total += d(seq[i], seq[i + 1]);
+        return total;
+    }
+
+    void reindex(size_t from, size_t to) {
+        for (size_t i = from; i <= to && i < seq.size(); i++) pos[seq[i]] = (int)i;
+    }
+
+    void reverseRange(int from, int to) {
+        reverse(seq.begin() + from, seq.begin() + to + 1);
+        reindex(from, to);
+    }
+
+    // Nearest neighbour from the start; with a seed, a quarter of the steps
+    // take the second nearest instead, so threads start from different routes
+    void nearestNeighbour(int nodes, uint32_t seed) {
+        mt19937 rng(seed);
+        vector<char> used(nodes, 0);
+        seq.assign(1, start);
+        int cur = start;
+        for (int step = 0; step < nodes; step++) {
+            int first = -1, second = -1;
+            for (int n = 0; n < nodes; n++) {
+                if (used[n]) continue;
+                if (first < 0 || d(cur, n) < d(cur, first)) { second = first; first = n; }
+                else if (second < 0 || d(cur, n) < d(cur, second)) second = n;
+            }
+            int pick = (seed && second >= 0 && rng() % 4 == 0) ? second : first;
+            used[pick] = 1;
+            seq.push_back(pick);
+            cur = pick;
+        }
+        pos.assign(stride, -1);
+        reindex(0, seq.size() - 1);
+    }
+
+    // Pellets to try against a: its nearest neighbours, or everyone for the start
+    template <typename Fn>
+    void forCandidates(int a, Fn fn) const {
+        if (a == start) {
+            for (size_t i = 1; i < seq.size(); i++) if (!fn(seq[i])) return;
+            return;
+        }
+        const int* list = &(*neighbours)[(size_t)a * PELLET_ROUTE_NEIGHBOURS];
+        for (int k = 0; k < PELLET_ROUTE_NEIGHBOURS && list[k] >= 0; k++) if (!fn(list[k])) return;
+    }
+
+    // 2-opt on an open path: new edges (a, c) and (b, e) replace (a, b) and (c, e)
+    bool twoOptPass() {
+        bool improved = false;
+        int m = (int)seq.size();
+        for (int i = 0; i + 1 < m; i++) {
+            int a = seq[i], b = seq[i + 1];
+            int dab = d(a, b);
+            bool moved = false;
+            forCandidates(a, [&](int c) {
+                if (c == b) return true;
+                int dac = d(a, c);
+                if (dac >= dab) return a == start;      // sorted lists can stop here
+                int pc = pos[c];
+                if (pc > i) {
+                    int e = pc + 1 < m ? seq[pc + 1] : -1;
+                    int delta = dac - dab + (e >= 0 ? d(b, e) - d(c, e) : 0);
+                    if (delta < 0) { reverseRange(i + 1, pc); moved = true; }
+                }
+                else {
+                    int e = seq[pc + 1];
+                    int delta = dac + d(e, b) - d(c, e) - dab;
+                    if (delta < 0) { reverseRange(pc + 1, i); moved = true; }
+                }
+                return !moved;
+            });
+            improved |= moved;
+        }
+        return improved;
+    }
+
+    // Or-opt: move a run of 1-3 pellets, either way round, next to one of
+    // its ends' neighbours
+    bool orOptPass() {
+        bool improved = false;
+        for (int p = 1; p < (int)seq.size(); p++) {
+            for (int len = 1; len <= 3; len++) {
+                int m = (int)seq.size();
+                if (p + len - 1 >= m) break;
+                int s1 = seq[p], sL = seq[p + len - 1], pv = seq[p - 1];
+                int nx = p + len < m ? seq[p + len] : -1;
+                int gain = d(pv, s1) + (nx >= 0 ? d(sL, nx) - d(pv, nx) : 0);
+                if (gain <= 0) continue;
+
+                int bestCost = gain, bestAfter = -1;
+                bool bestReversed = false;
+                auto consider = [&](int x, int y) {   // insert between seq positions x and y (y = -1: at the end)
+                    int a = seq[x], b = y >= 0 ? seq[y] : -1;
+                    int dxy = b >= 0 ? d(a, b) : 0;
+                    int fwd = d(a, s1) + (b >= 0 ? d(sL, b) : 0) - dxy;
+                    int rev = d(a, sL) + (b >= 0 ? d(s1, b) : 0) - dxy;
+                    if (fwd < bestCost) { bestCost = fwd; bestAfter = x; bestReversed = false; }
+                    if (rev < bestCost) { bestCost = rev; bestAfter = x; bestReversed = true; }
+                };
+                for (int end : { s1, sL }) {
+                    forCandidates(end, [&](int c) {
+                        int q = pos[c];
+                        if (q >= p && q < p + len) return true;
+                        if (q != p - 1) consider(q, q + 1 < m ? q + 1 : -1);
+                        if (q - 1 != p + len - 1) consider(q - 1, q);
+                        return true;
+                    });
+                }
+                if (bestAfter < 0) continue;
+
+                // Cut the run out and put it back after the chosen pellet
+                vector<int> run(seq.begin() + p, seq.begin() + p + len);
+                if (bestReversed) reverse(run.begin(), run.end());
+                seq.erase(seq.begin() + p, seq.begin() + p + len);
+                int at = (bestAfter < p ? bestAfter : bestAfter - len) + 1;
+                seq.insert(seq.begin() + at, run.begin(), run.end());
+                reindex(0, seq.size() - 1);
+                improved = true;
+                break;
+            }
+        }
+        return improved;
+    }
+
+    void optimise() {
+        for (int pass = 0; pass < ROUTE_MAX_PASSES; pass++) {
+            bool improved = twoOptPass();
+            improved |= orOptPass();
+            if (!improved) break;
+        }
+    }
+};
+
+// -------------------- PelletRoute --------------------
+void PelletRoute::bfsFrom(int tile, vector<int>& out) const {
+    vector<int> queue;
+    NavBfs(nav, tile, out, queue);
+}
+
+void PelletRoute::setStart(int tile) {
+    startTile = tile;
+    int n = nodeCount, stride = nodeCount + 1;
+    int sx = tile % nav.cols, sy = tile / nav.cols;
+    if (tileNode[tile] >= 0) {
+        // Standing on a pellet tile (eaten or not): its row is already known
+        int from = tileNode[tile];
+        for (int i = 0; i < n; i++)
+            dist[(size_t)n * stride + i] = dist[(size_t)i * stride + n] = dist[(size_t)from * stride + i];
+    }
+    else if (nav.hasAllPairs()) {
+        for (int i = 0; i < n; i++) {
+            uint16_t v = RouteDistance(nav.distance(sx, sy, nodeTile[i] % nav.cols, nodeTile[i] / nav.cols));
+            dist[(size_t)n * stride + i] = dist[(size_t)i * stride + n] = v;
+        }
+    }
+    else {
+        vector<int> steps;
+        bfsFrom(tile, steps);
+        for (int i = 0; i < n; i++)
+            dist[(size_t)n * stride + i] = dist[(size_t)i * stride + n] = RouteDistance(steps[nodeTile[i]]);
+    }
+    dist[(size_t)n * stride + n] = 0;
+}
+
+bool PelletRoute::solve(Map& maze, int x, int y, int threadCount) {
+    auto started = chrono::steady_clock::now();
+    threads = threadCount;
+    source = nullptr;           // set once solved, so a failed solve is retried by sync()
+    nav = maze.nav;
+    route.clear();
+    routeLength = 0;
+    exact = false;
+    nodeCount = 0;
+    unreachableCount = 0;
+    syncedHash = maze.eatenHash;
+    if (!nav.walkable(x, y)) {
+        cout << "Pellet route: start tile " << x << "," << y << " is not walkable\n";
+        return false;
+    }
+
+    // Every '.' pellet left that the start can reach
+    for (MapChunk& c : maze.chunks)
+        if (!c.loaded) maze.loadChunk(c);
+    vector<int> fromStart;
+    if (!nav.hasAllPairs()) bfsFrom(y * nav.cols + x, fromStart);
+    nodeTile.clear();
+    for (const MapChunk& c : maze.chunks)
+        for (CoinNode* p = c.coins.head; p; p = p->next) {
+            if (maze.layout[p->y][p->x] != '.') continue;
+            int t = p->y * nav.cols + p->x;
+            bool reachable = nav.hasAllPairs() ? nav.distance(x, y, p->x, p->y) >= 0 : fromStart[t] >= 0;
+            if (reachable) nodeTile.push_back(t);
+            else unreachableCount++;
+        }
+    sort(nodeTile.begin(), nodeTile.end());     // coin list order depends on load order
+    if ((int)nodeTile.size() > PELLET_ROUTE_MAX_NODES) {
+        cout << "Pellet route: " << nodeTile.size() << " pellets, the limit is " << PELLET_ROUTE_MAX_NODES << "\n";
+        nodeTile.clear();
+        return false;
+    }
+
+    int n = nodeCount = (int)nodeTile.size();
+    int stride = n + 1;
+    tileNode.assign((size_t)nav.cols * nav.rows, -1);
+    for (int i = 0; i < n; i++) tileNode[nodeTile[i]] = i;
+    live.assign(n, 1);
+    dist.assign((size_t)stride * stride, ROUTE_UNREACHABLE);
+
+    int workers = threads > 0 ? threads : (int)thread::hardware_concurrency();
+    workers = max(1, workers);
+
+    // Pellet to pellet: table lookups, or one BFS per pellet spread over the threads
+    if (nav.hasAllPairs()) {
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                dist[(size_t)i * stride + j] = RouteDistance(nav.distance(nodeTile[i] % nav.cols, nodeTile[i] / nav.cols,
+                    nodeTile[j] % nav.cols, nodeTile[j] / nav.cols));
+    }
+    else {
+        atomic<int> nextNode{ 0 };
+        auto work = [&]() {
+            vector<int> steps, queue;
+            for (int i = nextNode++; i < n; i = nextNode++) {
+                NavBfs(nav, nodeTile[i], steps, queue);
+                for (int j = 0; j < n; j++) dist[(size_t)i * stride + j] = RouteDistance(steps[nodeTile[j]]);
+            }
+        };
+        vector<thread> pool;
+        for (int t = 1; t < workers; t++) pool.emplace_back(work);
+        work();
+        for (thread& t : pool) t.join();
+    }
+    setStart(y * nav.cols + x);
+
+    if (n <= PELLET_ROUTE_EXACT_MAX) buildExact();
+    else {
+        // Nearest pellets of each pellet, for the local search
+        vector<int> neighbours((size_t)n * PELLET_ROUTE_NEIGHBOURS, -1);
+        vector<int> order(n);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) order[j] = j;
+            swap(order[i], order[n - 1]);
+            int k = min(PELLET_ROUTE_NEIGHBOURS, n - 1);
+            partial_sort(order.begin(), order.begin() + k, order.begin() + (n - 1),
+                [&](int a, int b) { return dist[(size_t)i * stride + a] < dist[(size_t)i * stride + b]; });
+            copy(order.begin(), order.begin() + k, neighbours.begin() + (size_t)i * PELLET_ROUTE_NEIGHBOURS);
+        }
+
+        // Multi-start: each thread improves its own starting route
+        vector<RouteSearch> searches(workers);
+        vector<thread> pool;
+        for (int t = 0; t < workers; t++) {
+            RouteSearch& s = searches[t];
+            s.dist = dist.data();
+            s.stride = stride;
+            s.start = n;
+            s.neighbours = &neighbours;
+        }
+        auto run = [&](int t) {
+            searches[t].nearestNeighbour(n, t == 0 ? 0 : 0x9E3779B9u * (uint32_t)t);
+            searches[t].optimise();
+        };
+        for (int t = 1; t < workers; t++) pool.emplace_back(run, t);
+        run(0);
+        for (thread& t : pool) t.join();
+
+        int bestThread = 0;
+        for (int t = 1; t < workers; t++)
+            if (searches[t].length() < searches[bestThread].length()) bestThread = t;
+        route.assign(searches[bestThread].seq.begin() + 1, searches[bestThread].seq.end());
+    }
+    updateLength();
+    source = &maze;
+    sourceNav = maze.nav.walkMask;
+    lastSolveMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    return true;
+}
+
+void PelletRoute::buildExact() {
+    exact = true;
+    exactNode.clear();
+    for (int i = 0; i < nodeCount; i++)
+        if (live[i]) exactNode.push_back(i);
+    route.clear();
+
+    int k = (int)exactNode.size();
+    liveMask = k ? (uint32_t)((1u << k) - 1) : 0;
+    best.assign(((size_t)1 << k) * max(k, 1), UINT16_MAX);
+    int local[PELLET_ROUTE_EXACT_MAX][PELLET_ROUTE_EXACT_MAX];
+    for (int i = 0; i < k; i++)
+        for (int j = 0; j < k; j++) local[i][j] = d(exactNode[i], exactNode[j]);
+
+    // best[mask][i]: i in mask, walk starts at i and covers mask. Capped at
+    // UINT16_MAX like the distances, which only a huge open map can reach.
+    for (uint32_t mask = 1; mask < (1u << k); mask++) {
+        for (int i = 0; i < k; i++) {
+            if (!(mask >> i & 1)) continue;
+            uint32_t rest = mask & ~(1u << i);
+            if (!rest) { best[(size_t)mask * k + i] = 0; continue; }
+            int value = INT_MAX;
+            const uint16_t* restBest = &best[(size_t)rest * k];
+            for (int j = 0; j < k; j++)
+                if (rest >> j & 1) value = min(value, local[i][j] + restBest[j]);
+            best[(size_t)mask * k + i] = (uint16_t)min(value, (int)UINT16_MAX);
+        }
+    }
+}
+
+void PelletRoute::remove(int node) {
+    live[node] = 0;
+    if (exact) {
+        for (int i = 0; i < (int)exactNode.size(); i++)
+            if (exactNode[i] == node) liveMask &= ~(1u << i);
+        return;
+    }
+    route.erase(find(route.begin(), route.end(), node));
+    if ((int)route.size() <= PELLET_ROUTE_SYNC_EXACT) buildExact();
+}
+
+// The start moved: try every 2-opt move on the first leg (a few linear scans)
+void PelletRoute::improveStart() {
+    int s = nodeCount, m = (int)route.size();
+    for (int round = 0; round < 3 && m > 1; round++) {
+        int b = route[0], bestDelta = 0, bestAt = -1;
+        for (int j = 1; j < m; j++) {
+            int c = route[j];
+            int e = j + 1 < m ? route[j + 1] : -1;
+            int delta = d(s, c) - d(s, b) + (e >= 0 ? d(b, e) - d(c, e) : 0);
+            if (delta < bestDelta) { bestDelta = delta; bestAt = j; }
+        }
+        if (bestAt < 0) break;
+        reverse(route.begin(), route.begin() + bestAt + 1);
+    }
+}
+
+void PelletRoute::updateLength() {
+    routeLength = 0;
+    if (exact) {
+        int k = (int)exactNode.size(), bestValue = INT_MAX;
+        for (int i = 0; i < k; i++)
+            if (liveMask >> i & 1) bestValue = min(bestValue, d(nodeCount, exactNode[i]) + best[(size_t)liveMask * k + i]);
+        routeLength = liveMask ? bestValue : 0;
+        return;
+    }
+    int cur = nodeCount;
+    for (int node : route) {
+        routeLength += d(cur, node);
+        cur = node;
+    }
+}
+
+bool PelletRoute::sync(Map& maze, int x, int y) {
+    if (&maze != source || maze.nav.walkMask != sourceNav) return solve(maze, x, y, threads);
+    if (!nav.walkable(x, y)) return false;
+    int tile = y * nav.cols + x;
+    bool changed = false;
+
+    // Pacman eats at most the pellet (and energizer) on its own tile; the
+    // maze's eaten-hash tells whether that is all that happened
+    if (maze.eatenHash != syncedHash) {
+        uint64_t pellet = StateKey(SF_PELLET, tile), energizer = StateKey(SF_ENERGIZER, tile);
+        uint64_t h = maze.eatenHash;
+        bool atePellet;
+        if (h == (syncedHash ^ pellet) || h == (syncedHash ^ pellet ^ energizer)) atePellet = true;
+        else if (h == (syncedHash ^ energizer)) atePellet = false;
+        else return solve(maze, x, y, threads);
+
+        syncedHash = h;
+        int node = tileNode[tile];
+        if (atePellet && node >= 0 && live[node]) {
+            remove(node);
+            changed = true;
+        }
+    }
+    if (tile != startTile) {
+        setStart(tile);
+        if (!exact) improveStart();
+        changed = true;
+    }
+    if (changed) updateLength();
+    return changed;
+}
+
+int PelletRoute::remaining() const {
+    if (!exact) return (int)route.size();
+    int count = 0;
+    for (uint32_t m = liveMask; m; m &= m - 1) count++;
+    return count;
+}
+
+void PelletRoute::order(vector<pair<int, int>>& out) const {
+    out.clear();
+    auto push = [&](int node) { out.push_back({ nodeTile[node] % nav.cols, nodeTile[node] / nav.cols }); };
+    if (!exact) {
+        for (int node : route) push(node);
+        return;
+    }
+
+    // Follow the DP: each step goes where the rest of the walk is shortest
+    int k = (int)exactNode.size(), cur = nodeCount;
+    for (uint32_t mask = liveMask; mask;) {
+        int pick = -1, pickValue = INT_MAX;
+        for (int i = 0; i < k; i++) {
+            if (!(mask >> i & 1)) continue;
+            int value = d(cur, exactNode[i]) + best[(size_t)mask * k + i];
+            if (value < pickValue) { pickValue = value; pick = i; }
+        }
+        push(exactNode[pick]);
+        cur = exactNode[pick];
+        mask &= ~(1u << pick);
+    }
+}
+
+bool PelletRoute::next(int& x, int& y) const {
+    int node = -1;
+    if (!exact) node = route.empty() ? -1 : route[0];
+    else {
+        int k = (int)exactNode.size(), bestValue = INT_MAX;
+        for (int i = 0; i < k; i++) {
+            if (!(liveMask >> i & 1)) continue;
+            int value = d(nodeCount, exactNode[i]) + best[(size_t)liveMask * k + i];
+            if (value < bestValue) { bestValue = value; node = exactNode[i]; }
+        }
+    }
+    if (node < 0) return false;
+    x = nodeTile[node] % nav.cols;
+    y = nodeTile[node] / nav.cols;
+    return true;
+}
+
+// -------------------- Command Line --------------------
+int RunPelletRouteTool(const LevelInfo& level, int threads) {
+    unique_ptr<Map> map = BuildLevelMap(level, TILE_SIZE);
+    if (!map) {
+        cout << "Level '" << level.name << "' failed to load\n";
+        return 1;
+    }
+    Map& maze = *map;
+    PelletRoute route;
+    if (!route.solve(maze, maze.pacStartX, maze.pacStartY, threads)) return 1;
+
+    // Baseline: always walk to the nearest pellet left
+    vector<pair<int, int>> order;
+    route.order(order);
+    vector<int> steps, queue;
+    vector<char> taken(order.size(), 0);
+    int greedy = 0, cur = maze.pacStartY * maze.cols + maze.pacStartX;
+    for (size_t n = 0; n < order.size(); n++) {
+        NavBfs(maze.nav, cur, steps, queue);
+        int pick = -1;
+        for (size_t i = 0; i < order.size(); i++) {
+            int t = order[i].second * maze.cols + order[i].first;
+            if (!taken[i] && (pick < 0 || steps[t] < steps[order[pick].second * maze.cols + order[pick].first])) pick = (int)i;
+        }
+        int t = order[pick].second * maze.cols + order[pick].first;
+        greedy += steps[t];
+        taken[pick] = 1;
+        cur = t;
+    }
+
+    cout << "Pellet route for '" << level.name << "': " << order.size() << " pellets";
+    if (route.unreachable()) cout << " (" << route.unreachable() << " unreachable)";
+    cout << ", " << route.length() << " steps (" << (route.isExact() ? "exact" : "2-opt / Or-opt") << ", "
+        << fixed << setprecision(2) << route.solveMs() << " ms); nearest-pellet walk " << greedy << " steps";
+    if (route.length() > 0) cout << ", " << setprecision(1) << 100.0 * (greedy - route.length()) / route.length() << "% longer";
+    cout << "\n";
+
+    // Eat along the route, replanning after every pellet as a bot would
+    double totalUs = 0.0, worstUs = 0.0;
+    int exactFrom = route.isExact() ? (int)order.size() : -1;
+    for (auto& p : order) {
+        maze.eatCoinAt(p.first, p.second);
+        auto start = chrono::steady_clock::now();
+        route.sync(maze, p.first, p.second);
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        totalUs += us;
+        worstUs = max(worstUs, us);
+        if (exactFrom < 0 && route.isExact()) exactFrom = route.remaining();
+    }
+    cout << "sync after each pellet: avg " << (order.empty() ? 0.0 : totalUs / order.size()) << " us, worst "
+        << worstUs << " us";
+    if (exactFrom >= 0) cout << " (exact from " << exactFrom << " pellets left)";
+    cout << "\n";
+    cout.unsetf(ios::floatfield);
+
+    if (route.remaining() != 0) {
+        cout << "FAIL: " << route.remaining() << " pellets still on the route\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef PELLET_ROUTE_H
+#define PELLET_ROUTE_H
+
+#include "Map.h"
+#include "Level.h"
+#include <vector>
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Pellet Route --------------------
+// Shortest walk from a tile through every '.' pellet left in a maze, in maze
+// steps. Distances come from the map's all-pairs nav tables, or from a BFS
+// per pellet (spread over threads) on maps too big to have them.
+//
+// Up to PELLET_ROUTE_EXACT_MAX pellets the route is exact: a bitmask DP over
+// "shortest walk from pellet i through every pellet in this subset", which
+// covers every subset at once, so later eats and start moves are lookups.
+// Above that, each thread builds a nearest-neighbour route (the first one
+// greedy, the others randomised) and improves it with 2-opt and Or-opt
+// moves over each pellet's nearest neighbours; the shortest one wins.
+//
+// sync() keeps a solved route current as the game plays: an eaten pellet is
+// spliced out, and a new start only re-checks the moves that touch the
+// route's first leg, so replanning every frame costs microseconds. A larger
+// route drops to the exact solver once few enough pellets are left.
+const int PELLET_ROUTE_EXACT_MAX = 12;
+const int PELLET_ROUTE_SYNC_EXACT = 8;      // sync() switches at this many, so the DP stays in the microseconds
+const int PELLET_ROUTE_NEIGHBOURS = 8;      // candidate pellets per move in the local search
+const int PELLET_ROUTE_MAX_NODES = 4096;    // the distance matrix is (n + 1)^2 shorts
+
+class PelletRoute {
+public:
+    // Plans from tile (x, y). Loads every chunk of a .pmap maze so all its
+    // pellets are seen; pellets that can't be reached are left out.
+    // threads = 0 uses one per core.
+    bool solve(Map& maze, int x, int y, int threads = 0);
+
+    // Call with Pacman's tile every frame, or at least on every tile it
+    // enters. Splices out the pellet it just ate and moves the start; any
+    // other change to the maze (a reset, a restored snapshot) re-solves.
+    // True when the route changed.
+    bool sync(Map& maze, int x, int y);
+
+    int remaining() const;
+    int length() const { return routeLength; }      // steps from the start through every pellet
+    bool isExact() const { return exact; }
+    int unreachable() const { return unreachableCount; }
+    double solveMs() const { return lastSolveMs; }
+
+    bool next(int& x, int& y) const;                // first pellet on the route
+    void order(vector<pair<int, int>>& out) const;  // every pellet, in route order
+
+private:
+    const Map* source = nullptr;
+    const unsigned char* sourceNav = nullptr;
+    MapNav nav;
+    int threads = 0;
+
+    int nodeCount = 0;                  // pellets; node nodeCount is the start
+    vector<int> nodeTile;               // y * cols + x
+    vector<int> tileNode;               // per tile, -1 if no pellet
+    vector<uint16_t> dist;              // (nodeCount + 1)^2
+    vector<char> live;
+    int startTile = -1;
+    uint64_t syncedHash = 0;
+    int unreachableCount = 0;
+    double lastSolveMs = 0.0;
+
+    // Heuristic route: live nodes in visit order
+    vector<int> route;
+    int routeLength = 0;
+
+    // Exact route: best[mask * k + i] = shortest walk from exactNode[i] through every node in mask
+    bool exact = false;
+    vector<int> exactNode;
+    vector<uint16_t> best;             // capped at UINT16_MAX, like dist
+    uint32_t liveMask = 0;
+
+    int d(int a, int b) const { return dist[(size_t)a * (nodeCount + 1) + b]; }
+    void setStart(int tile);
+    void bfsFrom(int tile, vector<int>& out) const;
+    void buildExact();
+    void remove(int node);
+    void improveStart();
+    void updateLength();
+};
+
+// --pellet-route [threads]: solves the first level from Pacman's start and
+// prints the route against a nearest-neighbour walk, then eats its way along
+// the route timing sync(). Returns the process exit code.
+int RunPelletRouteTool(const LevelInfo& level, int threads);
+
+#endif // PELLET_ROUTE_H
@@ -0,0 +1,144 @@
+#include "Profiler.h"
+#include "FileIO.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <iostream>
+
+using namespace std;
+
+FrameProfiler profiler;
+
+// Static initialisation runs on the main thread
+static const thread::id profileMainThread = this_thread::get_id();
+
+static long long NowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static const char* const ZONE_NAMES[PZ_COUNT + 1] = {
+    "Power-ups", "Release", "Pacman", "Red", "Pink", "Orange", "Blue",
+    "Frightened", "Collision", "Map::Draw", "Actors", "HUD", "Autopilot", "Ghost jobs", "Crowd", "Frame"
+};
+
+const char* ProfileZoneName(int zone) {
+    return zone >= 0 && zone <= PZ_COUNT ? ZONE_NAMES[zone] : "?";
+}
+
+// -------------------- FrameProfiler --------------------
+FrameProfiler::FrameProfiler() {
+    frameStartNs = NowNs();
+}
+
+void FrameProfiler::frameBegin() {
+    long long now = NowNs();
+    float* row = history[head];
+    for (int z = 0; z < PZ_COUNT; z++) {
+        row[z] = (float)(zoneFrameNs[z] / 1e6);
+        zoneFrameNs[z] = 0;
+    }
+    row[PZ_COUNT] = (float)((now - frameStartNs) / 1e6);
+    head = (head + 1) % PROFILE_HISTORY;
+    recorded = min(recorded + 1, PROFILE_HISTORY);
+
+    if (tracing) {
+        trace.push_back({ PZ_COUNT, frameStartNs, now - frameStartNs });
+        if (++traceFrames >= PROFILE_TRACE_FRAMES) stopTrace();
+    }
+    frameStartNs = now;
+}
+
+void FrameProfiler::clear() {
+    for (int z = 0; z < PZ_COUNT; z++) zoneFrameNs[z] = 0;
+    head = 0;
+    recorded = 0;
+    frameStartNs = NowNs();
+}
+
+void FrameProfiler::begin(ProfileZone zone) {
+    if (this_thread::get_id() != profileMainThread || paused > 0) return;
+    if (openZones < PROFILE_MAX_DEPTH) zoneStack[openZones] = zone;
+    openZones++;
+    if (depth[zone]++ == 0) zoneStartNs[zone] = NowNs();
+}
+
+void FrameProfiler::end(ProfileZone zone) {
+    if (this_thread::get_id() != profileMainThread || paused > 0) return;
+    openZones--;
+    if (--depth[zone] != 0) return;
+    long long now = NowNs();
+    zoneFrameNs[zone] += now - zoneStartNs[zone];
+    if (tracing) trace.push_back({ zone, zoneStartNs[zone], now - zoneStartNs[zone] });
+}
+
+void FrameProfiler::pause() {
+    if (this_thread::get_id() == profileMainThread) paused++;
+}
+
+void FrameProfiler::resume() {
+    if (this_thread::get_id() == profileMainThread) paused--;
+}
+
+ProfileStats FrameProfiler::stats(int zone) const {
+    ProfileStats s;
+    if (recorded == 0 || zone < 0 || zone > PZ_COUNT) return s;
+
+    float samples[PROFILE_HISTORY];
+    double sum = 0.0;
+    for (int i = 0; i < recorded; i++) {
+        samples[i] = history[(head - 1 - i + PROFILE_HISTORY) % PROFILE_HISTORY][zone];
+        sum += samples[i];
+    }
+    s.lastMs = samples[0];
+    s.avgMs = sum / recorded;
+
+    // Nearest-rank p99: the sample 99% of frames are at or under
+    int rank = max(0, (int)((recorded * 99 + 99) / 100) - 1);
+    nth_element(samples, samples + rank, samples + recorded);
+    s.p99Ms = samples[rank];
+    return s;
+}
+
+float FrameProfiler::frameMs(int ago) const {
+    if (ago < 0 || ago >= recorded) return 0.0f;
+    return history[(head - 1 - ago + PROFILE_HISTORY) % PROFILE_HISTORY][PZ_COUNT];
+}
+
+// -------------------- Trace Export --------------------
+void FrameProfiler::startTrace(const string& path) {
+    tracePathName = path;
+    trace.clear();
+    trace.reserve((size_t)PROFILE_TRACE_FRAMES * (PZ_COUNT + 4));
+    traceStartNs = frameStartNs;
+    traceFrames = 0;
+    tracing = true;
+}
+
+// Chrome trace-event JSON: one complete ("X") event per scope, times in microseconds
+bool FrameProfiler::stopTrace() {
+    if (!tracing) return false;
+    tracing = false;
+
+    ostringstream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}";
+    json.setf(ios::fixed);
+    json.precision(3);
+    for (const TraceEvent& e : trace) {
+        json << ",\n{\"name\":\"" << ProfileZoneName(e.zone) << "\",\"cat\":\""
+            << (e.zone == PZ_COUNT ? "frame" : "zone") << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+            << (e.startNs - traceStartNs) / 1e3 << ",\"dur\":" << e.durNs / 1e3 << "}";
+    }
+    json << "\n]}\n";
+    trace.clear();
+    trace.shrink_to_fit();
+
+    string text = json.str();
+    if (!WriteFileAtomic(tracePathName, text.data(), text.size())) {
+        cout << "Could not write trace " << tracePathName << "\n";
+        return false;
+    }
+    cout << "Wrote " << traceFrames << " frames of trace to " << tracePathName << "\n";
+    return true;
+}
@@ -0,0 +1,113 @@
+#pragma once
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+using namespace std;
+
+// -------------------- Frame Profiler --------------------
+// Scoped timers around the phases of a gameplay frame. Each zone's time is
+// summed per frame; the last PROFILE_HISTORY frames give rolling averages,
+// p99 and the frame-time graph. While a trace is recording, every scope is
+// also kept as a Chrome trace event (open the file in chrome://tracing or
+// ui.perfetto.dev). Main thread only: scopes on other threads are ignored.
+enum ProfileZone {
+    PZ_POWER_UPS, PZ_RELEASE, PZ_PACMAN,
+    PZ_GHOST_RED, PZ_GHOST_PINK, PZ_GHOST_ORANGE, PZ_GHOST_BLUE,
+    PZ_FRIGHTENED, PZ_COLLISION, PZ_MAP_DRAW, PZ_ACTOR_DRAW, PZ_HUD,
+    PZ_AUTOPILOT, PZ_GHOST_JOBS, PZ_CROWD,
+    PZ_COUNT
+};
+
+const int PROFILE_HISTORY = 240;                // frames kept for averages, p99 and the graph
+const int PROFILE_TRACE_FRAMES = 600;           // a trace stops by itself after this many frames
+const double PROFILE_FRAME_BUDGET_MS = 1000.0 / 60.0;
+const int PROFILE_MAX_DEPTH = 16;               // zones nested deeper than this aren't tracked as current
+
+const char* ProfileZoneName(int zone);          // zone == PZ_COUNT is the whole frame
+
+struct ProfileStats {
+    double lastMs = 0.0;
+    double avgMs = 0.0;
+    double p99Ms = 0.0;
+};
+
+class FrameProfiler {
+public:
+    FrameProfiler();
+
+    // Once per frame, before anything is timed: closes the previous frame
+    void frameBegin();
+    void clear();                                           // forget the history; a new frame starts now
+
+    void begin(ProfileZone zone);
+    void end(ProfileZone zone);
+    void pause();                                           // zones opened while paused aren't timed
+    void resume();
+    int currentZone() const { return openZones > 0 ? zoneStack[min(openZones, PROFILE_MAX_DEPTH) - 1] : PZ_COUNT; }
+
+    // zone == PZ_COUNT gives the whole frame (begin to begin, vsync included)
+    ProfileStats stats(int zone) const;
+    int frames() const { return recorded; }                 // frames in the history so far
+    float frameMs(int ago) const;                           // 0 = last finished frame
+
+    // Trace capture: start, then stop (or let it stop after PROFILE_TRACE_FRAMES)
+    void startTrace(const string& path);
+    bool stopTrace();                                       // writes the file; false on failure
+    bool isTracing() const { return tracing; }
+    const string& tracePath() const { return tracePathName; }
+
+private:
+    struct TraceEvent {
+        int zone;               // PZ_COUNT for a frame
+        long long startNs;
+        long long durNs;
+    };
+
+    long long frameStartNs = 0;
+    long long zoneStartNs[PZ_COUNT] = {};
+    long long zoneFrameNs[PZ_COUNT] = {};
+    int depth[PZ_COUNT] = {};                               // re-entered zones count once
+    int zoneStack[PROFILE_MAX_DEPTH] = {};                  // open zones, innermost last
+    int openZones = 0;
+    int paused = 0;
+
+    float history[PROFILE_HISTORY][PZ_COUNT + 1] = {};      // ms, one row per frame
+    int head = 0;                                           // next row to write
+    int recorded = 0;
+
+    bool tracing = false;
+    string tracePathName;
+    long long traceStartNs = 0;
+    int traceFrames = 0;
+    vector<TraceEvent> trace;
+};
+
+extern FrameProfiler profiler;
+
+class ScopedZone {
+public:
+    explicit ScopedZone(ProfileZone zone) : zone(zone) { profiler.begin(zone); }
+    ~ScopedZone() { profiler.end(zone); }
+    ScopedZone(const ScopedZone&) = delete;
+    ScopedZone& operator=(const ScopedZone&) = delete;
+
+private:
+    ProfileZone zone;
+};
+
+// Stops zones from being timed while alive, e.g. while a search AI plays
+// ahead on the main thread: its simulated frames aren't this frame's work
+class ScopedProfilePause {
+public:
+    ScopedProfilePause() { profiler.pause(); }
+    ~ScopedProfilePause() { profiler.resume(); }
+    ScopedProfilePause(const ScopedProfilePause&) = delete;
+    ScopedProfilePause& operator=(const ScopedProfilePause&) = delete;
+};
+
+#endif // PROFILER_H
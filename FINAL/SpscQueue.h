@@ -0,0 +1,43 @@
+#pragma once
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+using namespace std;
+
+// -------------------- Single-Producer Single-Consumer Queue --------------------
+// Fixed-size ring buffer with no locks: one thread pushes, one other thread
+// pops. Capacity must be a power of two; one slot is always left free.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0 && Capacity >= 2, "capacity must be a power of two");
+
+public:
+    // Producer only. False when full; the item is dropped.
+    bool push(const T& item) {
+        size_t t = tail.load(memory_order_relaxed);
+        size_t next = (t + 1) & (Capacity - 1);
+        if (next == head.load(memory_order_acquire)) return false;
+        items[t] = item;
+        tail.store(next, memory_order_release);
+        return true;
+    }
+
+    // Consumer only. False when empty.
+    bool pop(T& item) {
+        size_t h = head.load(memory_order_relaxed);
+        if (h == tail.load(memory_order_acquire)) return false;
+        item = items[h];
+        head.store((h + 1) & (Capacity - 1), memory_order_release);
+        return true;
+    }
+
+private:
+    T items[Capacity];
+    alignas(64) atomic<size_t> head{ 0 };   // next to pop, written by the consumer
+    alignas(64) atomic<size_t> tail{ 0 };   // next free slot, written by the producer
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,45 @@
+#pragma once
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstdint>
+
+using namespace std;
+
+// -------------------- Zobrist Keys --------------------
+// A game state hashes to the XOR of one key per (feature, value) it has, so
+// a change only XORs out the old key and XORs in the new one. The keys are
+// mixed from the feature and value instead of read from random tables, which
+// keeps them the same for any map size and in every build.
+//
+// Pellets and energizers count once each, by tile, when eaten, and power-ups
+// by tile while still on the floor; the other features hold one value each
+// (see UpdateStateHash in Game.h).
+// Timers are included: the same tiles at a different time hash differently.
+enum StateFeature {
+    SF_PELLET, SF_ENERGIZER, SF_POWER_UP,
+
+    SF_PAC_TILE, SF_PAC_DIRECTION, SF_PAC_DYING, SF_LIVES, SF_SCORE, SF_ENERGIZER_TIMER,
+    SF_GHOST_TILE,                                  // 4 each: red, pink, orange, blue
+    SF_GHOST_DIRECTION = SF_GHOST_TILE + 4,
+    SF_GHOST_MODE = SF_GHOST_DIRECTION + 4,
+    SF_GHOST_RELEASE = SF_GHOST_MODE + 4,
+    SF_RELEASE = SF_GHOST_RELEASE + 4,              // ReleaseInfo state
+    SF_RELEASE_TIMER = SF_RELEASE + 4,
+    SF_SCATTER = SF_RELEASE_TIMER + 4, SF_WAVE_TIMER, SF_FRIGHTENED_TIMER, SF_FRAME,
+    SF_COUNT
+};
+
+const int SF_FIRST_VALUE = SF_PAC_TILE;             // features with one value each
+const int SF_VALUES = SF_COUNT - SF_FIRST_VALUE;
+
+// SplitMix64 finalizer over the feature and value
+inline uint64_t StateKey(int feature, int64_t value) {
+    uint64_t z = ((uint64_t)feature << 56) ^ (uint64_t)value ^ 0x9E3779B97F4A7C15ull;
+    z += 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+#endif // STATE_HASH_H
@@ -5,6 +5,19 @@
 #include "Map.h"
 #include "Menu.h"
 #include "Highscore.h"
+#include "MapFile.h"
+#include "Level.h"
+#include "LeaderboardServer.h"
+#include "MazeGenerator.h"
+#include "DefaultMaze.h"
+#include "Assets.h"
+#include "Audio.h"
+#include "Profiler.h"
+#include "Game.h"
+#include "AllocTrack.h"
+#include "PacmanEnv.h"
+#include "Autopilot.h"
+#include "PelletRoute.h"
 
 #include<iostream>
 #include <vector>
@@ -16,52 +29,257 @@
 #include <queue>
 #include <fstream>
 #include <sstream>
+#include <random>
+#include <chrono>
+#include <cstdlib>
 
 using namespace std;
 using namespace GameConstants;
 
-int main() {
-    vector<string> mazeLayout = {
-        " ################### ",
-        " #.O......#..... ..# ",
-        " #.##.###.#.###.##.# ",
-        " #.................# ",
-        " #.##.#.#####.#.##.# ",
-        " #. ..#...#...#....# ",
-        " ####.### # ###.#### ",
-        "    #.#       #.#    ",
-        "#####.# GGGGG #.#####",
-        "     .  #GGG#  .     ",
-        "#####.# GGGGG #.#####",
-        "    #.#....O..#.#    ",
-        " ####.#.#####.#.#### ",
-        " #.. .....#.... ...# ",
-        " #.##.###.#.###.##.# ",
-        " #..#.O... .....#..# ",
-        " ##.#.#.#####.P.#.## ",
-        " #....#...#...#....# ",
-        " #.######.#.######.# ",
-        " #.. ............O.# ",
-        " ################### "
-    };
+int main(int argc, char** argv) {
+    auto programStart = chrono::steady_clock::now();
+    vector<string> mazeLayout = DefaultMaze::Layout();
 
     int tileSize = 45;
-    Map maze(mazeLayout, tileSize);
 
-    // Find Pacman start
-    int startGX = -1, startGY = -1;
-    for (int y = 0; y < maze.rows; y++) {
-        for (int x = 0; x < maze.cols; x++) {
-            if (maze.layout[y][x] == 'P') { startGX = x; startGY = y; break; }
+    // Command line:
+    //   --map <file.pmap>                   play a binary map instead of the level pack
+    //   --convert-map <out.pmap> [in.txt]   write the built-in (or a text) maze as .pmap and exit
+    //   --random-maze [seed]                play a single generated maze
+    //   --gen-maze <out.txt> <cols> <rows> [seed]   write a generated maze (e.g. a large benchmark) and exit
+    //   --bench-leaderboard [n]             time the highscore leaderboard with n entries (default 10M) and exit
+    //   --bench-names [n]                   time search-as-you-type over n player names (default 500k) and exit
+    //   --bench-env [envs] [steps] [threads]   step a batch of RL environments with random actions and exit
+    //   --sort-highscores <out.bin> [in.bin ...] [--run-records n]   merge score files (default highscores.bin) into rank order and exit
+    //   --pack-assets <out.pak> [dir]       pack the game's asset files (from dir) into one archive and exit
+    //   --sync-assets                       load every asset before the first frame (the old way, for timing)
+    //   --profile-trace <file.json>         record a Chrome trace of the first PROFILE_TRACE_FRAMES frames
+    //   --track-allocs                      count main-thread allocations per zone (F4 overlay, report on exit)
+    //   --headless [frames] [seed]          play the first level without a window, print frame times and exit
+    //   --alloc-budget <n>                  with --headless: report allocations, exit 1 if a frame makes more than n
+    //   --autopilot-eval [games] [iterations] [threads]   let the search AI play the first level on easy and hard, print results and exit
+    //   --pellet-route [threads]            solve the shortest walk through every pellet of the first level and exit
+    //   --crowd [ghosts]                    party mode: a crowd of ghosts (default 2000) chases Pacman from the start (F9)
+    //   --bench-crowd [ghosts] [frames] [threads]   time a ghost crowd on the first level without a window and exit
+    //   --ghost-jobs [threads]              tick the ghosts in two phases on a job system (F8 toggles), headless runs too
+    //   --ghost-lod [budget-us]             start with the ghost AI level of detail on (F7), headless runs too; budget 0 = none
+    //   --leaderboard [port]                also submit scores to a local leaderboard server
+    //   --leaderboard-server [port], --lb-submit, --lb-top, --lb-rank   see LeaderboardServer.h
+    string mapPath;
+    int leaderboardPort = 0;
+    int headlessFrames = -1;
+    uint32_t headlessSeed = 1;
+    int allocBudget = -1;
+    GhostLodConfig ghostLod;
+    int ghostThreads = -1;
+    int crowdGhosts = CROWD_DEFAULT_GHOSTS;
+    bool crowdOn = false;
+    int crowdBenchFrames = 0, crowdBenchThreads = 0;
+    int evalGames = 0, evalIterations = 64, evalThreads = 0;
+    int routeThreads = -1;
+    bool trackAllocs = false;
+    bool syncAssets = false;
+    bool randomMaze = false;
+    uint32_t randomSeed = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--map" && i + 1 < argc) mapPath = argv[++i];
+        else if (arg == "--random-maze") {
+            randomMaze = true;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) randomSeed = (uint32_t)stoul(argv[++i]);
+        }
+        else if (arg == "--pack-assets" && i + 1 < argc) {
+            string outPath = argv[++i];
+            string dir = (i + 1 < argc) ? argv[++i] : "";
+            return BuildAssetPack(outPath, dir, vector<string>(begin(ASSET_FILES), end(ASSET_FILES))) ? 0 : 1;
+        }
+        else if (arg == "--profile-trace" && i + 1 < argc) profiler.startTrace(argv[++i]);
+        else if (arg == "--track-allocs") trackAllocs = true;
+        else if (arg == "--alloc-budget" && i + 1 < argc) allocBudget = atoi(argv[++i]);
+        else if (arg == "--crowd" || arg == "--bench-crowd") {
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) crowdGhosts = atoi(argv[++i]);
+            if (arg == "--crowd") crowdOn = true;
+            else {
+                crowdBenchFrames = 3600;
+                if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) crowdBenchFrames = atoi(argv[++i]);
+                if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) crowdBenchThreads = atoi(argv[++i]);
+            }
+        }
+        else if (arg == "--ghost-jobs") {
+            ghostThreads = 0;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ghostThreads = atoi(argv[++i]);
+        }
+        else if (arg == "--ghost-lod") {
+            ghostLod.enabled = true;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) ghostLod.budgetMs = atoi(argv[++i]) / 1000.0f;
+        }
+        else if (arg == "--headless") {
+            headlessFrames = 3600;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) headlessFrames = atoi(argv[++i]);
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) headlessSeed = (uint32_t)stoul(argv[++i]);
+        }
+        else if (arg == "--autopilot-eval") {
+            evalGames = 3;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) evalGames = atoi(argv[++i]);
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) evalIterations = atoi(argv[++i]);
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) evalThreads = atoi(argv[++i]);
+        }
+        else if (arg == "--pellet-route") {
+            routeThreads = 0;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) routeThreads = atoi(argv[++i]);
+        }
+        else if (arg == "--sync-assets") {
+            syncAssets = true;
+        }
+        else if (arg == "--leaderboard") {
+            leaderboardPort = LEADERBOARD_PORT;
+            if (i + 1 < argc && isdigit((unsigned char)argv[i + 1][0])) leaderboardPort = atoi(argv[++i]);
+        }
+        else if (arg == "--leaderboard-server" || arg.rfind("--lb-", 0) == 0) {
+            return RunLeaderboardTool(arg, vector<string>(argv + i + 1, argv + argc));
+        }
+        else if (arg == "--bench-env") {
+            int envs = (i + 1 < argc) ? atoi(argv[++i]) : 64;
+            int steps = (i + 1 < argc) ? atoi(argv[++i]) : 2000;
+            int threads = (i + 1 < argc) ? atoi(argv[++i]) : 0;
+            return BenchmarkEnv(envs, steps, threads);
+        }
+        else if (arg == "--bench-names") {
+            int n = (i + 1 < argc) ? atoi(argv[++i]) : 500000;
+            BenchmarkNameSearch(max(1, n));
+            return 0;
+        }
+        else if (arg == "--bench-leaderboard") {
+            int n = (i + 1 < argc) ? atoi(argv[++i]) : 10000000;
+            BenchmarkLeaderboard(max(1, n));
+            return 0;
+        }
+        else if (arg == "--sort-highscores" && i + 1 < argc) {
+            string outPath = argv[++i];
+            vector<string> inPaths;
+            size_t runRecords = (size_t)1 << 20;
+            while (++i < argc) {
+                string next = argv[i];
+                if (next == "--run-records" && i + 1 < argc) runRecords = (size_t)max(1ll, atoll(argv[++i]));
+                else inPaths.push_back(next);
+            }
+            if (inPaths.empty()) inPaths.push_back("highscores.bin");
+            return SortHighscoreFilesExternal(inPaths, outPath, runRecords) ? 0 : 1;
+        }
+        else if (arg == "--gen-maze") {
+            // Whole unsigned numbers only: atoi/stoul would take "abc" as 0 or throw
+            auto number = [](const char* s, unsigned long& out) {
+                char* end = nullptr;
+                out = strtoul(s, &end, 10);
+                return isdigit((unsigned char)s[0]) && *end == '\0' && out <= 0xFFFFFFFFul;
+            };
+            unsigned long cols = 0, rows = 0, seed = random_device()();
+            bool hasSeed = i + 4 < argc && argv[i + 4][0] != '-';
+            if (i + 3 >= argc || !number(argv[i + 2], cols) || !number(argv[i + 3], rows) ||
+                cols > MAPFILE_MAX_SIDE || rows > MAPFILE_MAX_SIDE || (hasSeed && !number(argv[i + 4], seed))) {
+                cout << "Usage: --gen-maze <out.txt> <cols> <rows> [seed]\n";
+                return 1;
+            }
+            string outPath = argv[i + 1];
+            i += hasSeed ? 4 : 3;
+            MazeGenOptions opts;
+            opts.cols = (int)cols;
+            opts.rows = (int)rows;
+            opts.seed = (uint32_t)seed;
+            MazeCandidate best;
+            vector<string> layout = GenerateMaze(opts, &best);
+            if (layout.empty() || !SaveTextMap(layout, outPath)) {
+                cout << "Could not generate " << outPath << "\n";
+                return 1;
+            }
+            cout << "Wrote " << outPath << " (" << layout[0].size() << "x" << layout.size()
+                << ", seed " << opts.seed << ", score " << best.score << ")\n";
+            return 0;
+        }
+        else if (arg == "--convert-map" && i + 1 < argc) {
+            string outPath = argv[++i];
+            vector<string> source = mazeLayout;
+            if (i + 1 < argc && !LoadTextMap(argv[++i], source)) {
+                cout << "Could not read text map " << argv[i] << "\n";
+                return 1;
+            }
+            Map textMap(source, tileSize);
+            if (!ConvertMapToBinary(textMap, outPath)) {
+                cout << "Could not write " << outPath << "\n";
+                return 1;
+            }
+            cout << "Wrote " << outPath << " (" << textMap.cols << "x" << textMap.rows << ")\n";
+            return 0;
         }
-        if (startGX != -1) break;
     }
-    if (startGX == -1) { startGX = maze.cols / 2; startGY = maze.rows - 2; }
 
-    Pacman pac(startGX * tileSize, startGY * tileSize, tileSize);
+    // Level sequence: levels.txt, a single --map, or just the built-in maze
+    vector<LevelInfo> levels;
+    if (randomMaze) {
+        LevelInfo generated;
+        generated.name = "Random";
+        generated.genCols = 21;
+        generated.genRows = 21;
+        generated.genSeed = randomSeed;
+        levels.push_back(generated);
+    }
+    else if (!mapPath.empty()) {
+        LevelInfo single;
+        single.name = mapPath;
+        single.mapPath = mapPath;
+        levels.push_back(single);
+    }
+    else if (!LoadLevelPack("levels.txt", levels)) {
+        LevelInfo classic;
+        classic.name = "Classic";
+        classic.layout = mazeLayout;
+        levels.push_back(classic);
+    }
 
-    int winW = maze.cols * tileSize;
-    int winH = maze.rows * tileSize;
+    if (headlessFrames >= 0) {
+        unique_ptr<JobSystem> jobs(ghostThreads >= 0 ? new JobSystem(ghostThreads) : nullptr);
+        return RunHeadless(levels[0], headlessFrames, headlessSeed, allocBudget, ghostLod, jobs.get());
+    }
+    if (evalGames > 0) return RunAutopilotEval(levels[0], evalGames, evalIterations, evalThreads);
+    if (routeThreads >= 0) return RunPelletRouteTool(levels[0], routeThreads);
+    if (crowdBenchFrames > 0) return RunCrowdBenchmark(levels[0], crowdGhosts, crowdBenchFrames, crowdBenchThreads);
+
+    int currentLevel = 0;
+    unique_ptr<Map> firstMaze = BuildLevelMap(levels[0], tileSize);
+    if (!firstMaze) {
+        cout << "Falling back to the built-in maze\n";
+        levels.assign(1, LevelInfo());
+        levels[0].name = "Classic";
+        levels[0].layout = mazeLayout;
+        firstMaze = BuildLevelMap(levels[0], tileSize);
+    }
+    // Ghosts get their texture once it has loaded
+    GameWorld world(move(*firstMaze), Texture2D(), tileSize);
+    world.ghostAI.config = ghostLod;    // F7 toggles it
+    JobSystem ghostJobs(ghostThreads > 0 ? ghostThreads : 0);
+    world.ghostJobs = &ghostJobs;
+    world.twoPhaseGhosts = ghostThreads >= 0;   // F8 toggles it
+    firstMaze.reset();
+    Map& maze = world.maze;
+    Pacman& pac = world.pac;
+
+    // The next level is built on a worker thread while this one is played,
+    // then its chunk textures are baked a few per frame
+    LevelLoader levelLoader;
+    unique_ptr<Map> nextMaze;
+    int levelLoadFailures = 0;      // in a row; once every level has failed the current one is replayed
+    bool replayLevel = false;
+    bool restartPending = false;    // level 0 is being built for the next game
+    levelLoader.request(levels[1 % levels.size()], 1 % (int)levels.size(), tileSize);
+
+    // Window shows at most VIEW_MAX_COLS x VIEW_MAX_ROWS tiles; larger mazes scroll
+    int winW = min(maze.cols, VIEW_MAX_COLS) * tileSize;
+    int winH = min(maze.rows, VIEW_MAX_ROWS) * tileSize;
+    Camera2D camera = {};
+    camera.offset = { 0.0f, 0.0f };
+    camera.target = { 0.0f, 0.0f };
+    camera.rotation = 0.0f;
+    camera.zoom = 1.0f;
 
     // ---------------------- FIXED AUDIO ----------------------
     InitWindow(winW, winH, "PacMaze - Raylib Grid Integrated");
@@ -69,15 +287,45 @@ int main() {
     InitAudioDevice();              // MUST BE BEFORE ANY SOUND LOAD
     SetMasterVolume(1.0f);
 
-    Sound gameOverSound = LoadSound("C:/Users/ARMEEN_AZAM/Desktop/coal lab tasks/Ray/x64/Debug/gameover2.wav");
-    Music loadingMusic;  // Declare globally or in main for persistence across frames
-    loadingMusic = LoadMusicStream("wakawaka.mp3");  // Replace with your audio file path
-    loadingMusic.looping = true;  // Enable looping
+    // Assets load on worker threads behind the loading screen; textures and
+    // audio buffers are created on this thread as they become ready
+    GameAssets assets;
+    HighscoreLog scoreLog;
+
+    // Optional shared leaderboard. While linked, the server is the only
+    // writer of highscores.bin: the local log is read for name suggestions
+    // but never written, and is only the fallback when no server answers.
+    LeaderboardLink leaderboard;
+    if (leaderboardPort) {
+        if (leaderboard.start(leaderboardPort)) scoreLog.readOnly = true;
+        else cout << "No leaderboard server on port " << leaderboardPort << ", saving locally only\n";
+    }
+    auto saveScore = [&](const string& name, int score) {
+        scoreLog.add(name, score);      // memory only while linked
+        if (leaderboard.isLinked()) leaderboard.submit(name, score);
+    };
+    // stop() makes a last attempt to send, so anything it hands back never
+    // reached a server (refused scores are dropped, not returned): no other
+    // process is writing highscores.bin and it is safe to save them locally
+    auto closeScores = [&]() {
+        vector<HighscoreEntry> unsent = leaderboard.stop();
+        if (!unsent.empty()) {
+            cout << unsent.size() << " score(s) did not reach the leaderboard server, saving them locally\n";
+            HighscoreLog local;
+            local.load("highscores.bin", "highscores.txt");
+            for (const auto& e : unsent) local.add(e.name, e.score);
+            local.flush();
+        }
+        scoreLog.flush();
+    };
+    AssetLoader assetLoader;
+    if (syncAssets) assetLoader.loadNow(assets, scoreLog);
+    else assetLoader.start(assets, scoreLog);
 
-    Music introMusic;
-    introMusic = LoadMusicStream("pacIntro.mp3");
-    introMusic.looping = false;
-  
+    // Music streaming and sound effects run on their own thread; the loop
+    // only queues commands, and sounds are handed over as they load
+    AudioSystem audio;
+    audio.start();
 
     //-----------------------------------------------------------
 
@@ -88,37 +336,72 @@ int main() {
     GameState currentState = STATE_LOADING;
 
 
-    // Load Texture
-    Texture2D ghostTexture = LoadTexture("Ghost16.png");
-    if (ghostTexture.id == 0)
-        cout << "?? Ghost texture not found! Check path.\n";
+    Texture2D& ghostTexture = assets.ghostTexture;
 
     // Ghosts
-    RedGhost red(10, 8, 0, ghostTexture, tileSize);
-    PinkGhost pink(9, 9, 1, ghostTexture, tileSize);
-    OrangeGhost orange(10, 9, 3, ghostTexture, tileSize);
-    BlueGhost blue(11, 9, 2, ghostTexture, tileSize);
-
-    ReleaseInfo redRelease;  redRelease.state = R_ACTIVE;
-    ReleaseInfo pinkRelease, orangeRelease, blueRelease;
-
-    int globalFrames = 0;
-    int waveTimer = 0;
-    bool scatterMode = true;
-    int frightenedTimer = 0;
+    RedGhost& red = world.red;
+    PinkGhost& pink = world.pink;
+    OrangeGhost& orange = world.orange;
+    BlueGhost& blue = world.blue;
+
+    ReleaseInfo& redRelease = world.redRelease;
+    ReleaseInfo& pinkRelease = world.pinkRelease;
+    ReleaseInfo& orangeRelease = world.orangeRelease;
+    ReleaseInfo& blueRelease = world.blueRelease;
+
+    StartLevel(levels[currentLevel], maze, pac, red, pink, orange, blue, tileSize);
+
+    int& globalFrames = world.globalFrames;
+    int& waveTimer = world.waveTimer;
+    bool& scatterMode = world.scatterMode;
+    int& frightenedTimer = world.frightenedTimer;
     int gameOverTimer = 0;  // New: Timer for game over screen duration
     bool nameEntered = false;  // Track if player has entered name (only once at start)
+    NameSearch nameSearch;     // name suggestions while typing
     int pacEnergizerTimer = 0;  // <-- NEW: Declare this as an int (initialize to 0 or your default)
 
     bool savedGameScore = false;
 
-    Font titleFont = LoadFont("pacman_font.ttf");  // Replace with your font file
-    Font instructionFont = LoadFont("instruction.ttf");
-    vector<HighscoreEntry> highscores;
-    LoadHighscores(highscores);
+    Font& titleFont = assets.titleFont;   // the default font is drawn until it loads
+
+    bool highscoresByPlayer = false;
+
+    // Overlays drawn over every screen, last thing before the frame ends
+    bool showIoStats = false;   // F3: main-thread time blocked on file I/O
+    bool showProfiler = false;  // F4: per-zone frame times; F5 starts / stops a trace
+    bool autopilotOn = false;   // F6: the search AI steers Pacman
+    Autopilot autopilot;
+    {
+        AutopilotConfig pilotConfig;
+        pilotConfig.iterations = 0;
+        pilotConfig.timeMs = 6.0f;      // per decision, roughly one every tile
+        autopilot.configure(pilotConfig);
+    }
+    bool firstFrame = true;
+    auto endFrame = [&]() {
+        if (showIoStats) DrawIoStats(winW, assetLoader.done() ? scoreLog.pendingWrites() : 0);
+        if (showProfiler) DrawProfilerOverlay(winH);
+        EndDrawing();
+        if (firstFrame) {
+            firstFrame = false;
+            cout << "First frame after " << chrono::duration<double, milli>(chrono::steady_clock::now() - programStart).count()
+                << " ms" << (syncAssets ? " (assets loaded up front)" : "") << "\n";
+        }
+    };
+
+    if (trackAllocs) AllocTrackingEnable(true);
 
     // -------------------- GAME LOOP --------------------
     while (!WindowShouldClose()) {
+        IoFrameBegin();
+        profiler.frameBegin();
+        AllocFrameBegin();
+        if (IsKeyPressed(KEY_F3)) showIoStats = !showIoStats;
+        if (IsKeyPressed(KEY_F4)) showProfiler = !showProfiler;
+        if (IsKeyPressed(KEY_F5)) {
+            if (profiler.isTracing()) profiler.stopTrace();
+            else profiler.startTrace("profile_trace.json");
+        }
 
         BeginDrawing();
 
@@ -127,20 +410,44 @@ int main() {
         // ---------------- LOADING SCREEN ----------------
         if (currentState == STATE_LOADING)
         {
-            if (!IsMusicStreamPlaying(loadingMusic)) {
-                PlayMusicStream(loadingMusic);
+            if (!assetLoader.done() && assetLoader.update()) {
+                cout << "Assets ready after " << chrono::duration<double, milli>(chrono::steady_clock::now() - programStart).count()
+                    << " ms\n";
+                red.texture = pink.texture = orange.texture = blue.texture = ghostTexture;
             }
 
-            // Update the music stream each frame
-            UpdateMusicStream(loadingMusic);
-
-            ClearBackground(BLACK);
-            DrawLoadingScreen(loadPacX, titleFont);
+            if (assetLoader.isLoaded(ASSET_LOADING_MUSIC) && !audio.hasMusic(MUSIC_LOADING))
+                audio.setMusic(MUSIC_LOADING, assets.loadingMusic);
+            if (assetLoader.isLoaded(ASSET_INTRO_MUSIC) && !audio.hasMusic(MUSIC_INTRO))
+                audio.setMusic(MUSIC_INTRO, assets.introMusic);
+            if (assetLoader.isLoaded(ASSET_GAME_OVER_SOUND) && !audio.hasSfx(SFX_GAME_OVER))
+                audio.setSfx(SFX_GAME_OVER, assets.gameOverWave);
 
+            if (audio.hasMusic(MUSIC_LOADING) && !audio.isMusicPlaying(MUSIC_LOADING)) {
+                audio.playMusic(MUSIC_LOADING);
+            }
 
-            loadingFrame++;
-            if (loadingFrame > 300) {
-                StopMusicStream(loadingMusic);
+            ClearBackground(BLACK);
+            DrawLoadingScreen(loadPacX, titleFont, assetLoader.progress());
+
+            // Leave once everything is loaded, but show the screen for at least a second
+            if (assetLoader.done() && loadingFrame > LOADING_MIN_FRAMES && (!restartPending || levelLoader.ready())) {
+                audio.stopMusic(MUSIC_LOADING);
+
+                if (restartPending) {
+                    // If level 0 fails to build the next game starts on this one
+                    unique_ptr<Map> first = levelLoader.take();
+                    if (first) {
+                        maze.replaceWith(move(*first));
+                        autopilot.forget();
+                        world.crowd.clear();
+                        currentLevel = 0;
+                    }
+                    else cout << "Level '" << levels[0].name << "' failed to load\n";
+                    StartLevel(levels[currentLevel], maze, pac, red, pink, orange, blue, tileSize);
+                    levelLoader.request(levels[(currentLevel + 1) % levels.size()], (currentLevel + 1) % (int)levels.size(), tileSize);
+                    restartPending = false;
+                }
 
                 if (!nameEntered) {
                     currentState = STATE_ENTER_NAME;  // First time: go to enter name
@@ -153,7 +460,7 @@ int main() {
             }
 
 
-            EndDrawing();
+            endFrame();
             continue;
         }
 
@@ -164,7 +471,7 @@ int main() {
             DrawExitScreen(winW, winH, titleFont, gameOverTimer);
             static bool soundPlayed = false;
             if (!soundPlayed) {
-                PlaySound(gameOverSound);
+                PlaySfx(SFX_GAME_OVER);
                 soundPlayed = true;
             }
 
@@ -174,15 +481,22 @@ int main() {
                 if (!savedGameScore) {
                     // Use playerName if set, otherwise fallback to "ANON"
                     string nameToSave = playerName.empty() ? string("ANON") : playerName;
-                    highscores.push_back({ nameToSave, pac.score });
-                    SaveHighscores(highscores);
+                    saveScore(nameToSave, pac.score);
                     savedGameScore = true;
                 }
-                resetGame(maze, pac, red, pink, orange, blue, mazeLayout, tileSize,
+                resetGame(maze, pac, red, pink, orange, blue, tileSize,
                     frightenedTimer, globalFrames, waveTimer, scatterMode,
                     redRelease, pinkRelease, orangeRelease, blueRelease,
                     pacEnergizerTimer);  // <-- Pass the new parameter
 
+                // Back to the first level (already loaded if we never left it); it is
+                // built on the loader's thread while the loading screen shows
+                if (currentLevel != 0) {
+                    nextMaze.reset();
+                    levelLoader.request(levels[0], 0, tileSize);
+                    restartPending = true;
+                }
+                else StartLevel(levels[currentLevel], maze, pac, red, pink, orange, blue, tileSize);
 
                 // Reset static flags for next game over
                 soundPlayed = false;
@@ -195,21 +509,19 @@ int main() {
                 loadingFrame = 0;
                 loadPacX = 0.0f;
             }
-            EndDrawing();
+            endFrame();
             continue;
         }
 
         if (currentState == STATE_ENTER_NAME) {
 
-            if (!IsMusicStreamPlaying(introMusic)) {
-                PlayMusicStream(introMusic);
+            if (!audio.isMusicPlaying(MUSIC_INTRO)) {
+                audio.playMusic(MUSIC_INTRO);
             }
 
-            // Update the music stream each frame
-            UpdateMusicStream(introMusic);
 
-
-            DrawEnterNameScreen(winW, winH, titleFont, playerName);
+            nameSearch.update(scoreLog.names, playerName);
+            DrawEnterNameScreen(winW, winH, titleFont, playerName, nameSearch);
             // Handle input
             int key = GetKeyPressed();
             if (key >= 32 && key <= 126 && playerName.length() < 10) {  // Printable characters, max 10
@@ -218,15 +530,17 @@ int main() {
             if (IsKeyPressed(KEY_BACKSPACE) && !playerName.empty()) {
                 playerName.pop_back();
             }
+            if (IsKeyPressed(KEY_TAB) && !nameSearch.matches.empty()) {
+                playerName = nameSearch.matches[0].name.substr(0, 10);   // fill in the best match
+            }
             if (IsKeyPressed(KEY_ENTER) && !playerName.empty()) {
-                highscores.push_back({ playerName, pac.score });
-                SaveHighscores(highscores);
+                saveScore(playerName, pac.score);
                 nameEntered = true;  // Mark as entered
 
                 currentState = STATE_MENU;  // Proceed to menu if name is entered
                 selectedOption = MENU_PLAY;
             }
-            EndDrawing();
+            endFrame();
             continue;
         }
 
@@ -234,9 +548,6 @@ int main() {
 
         // -------------------- START MENU --------------------
         if (currentState == STATE_MENU) {
-            if (IsMusicStreamPlaying(introMusic)) {
-                UpdateMusicStream(introMusic);
-            }
             // Handle navigation
             if (IsKeyPressed(KEY_DOWN)) {
                 selectedOption = static_cast<MenuOption>((static_cast<int>(selectedOption) + 1) % 4);
@@ -255,9 +566,11 @@ int main() {
                     break;
                 case MENU_HIGHSCORE:
                     currentState = STATE_HIGHSCORE;  // Implement this state/screen
+                    if (leaderboard.isLinked()) leaderboard.requestView(playerName);
                     break;
                 case MENU_EXIT:
-                    StopMusicStream(introMusic);  // Stop music on exit
+                    audio.stop();                 // Stop music on exit
+                    closeScores();                // queued scores reach the server or the disk first
 
                     CloseWindow();  // Exit the game entirely
                     return 0;
@@ -266,41 +579,39 @@ int main() {
             }
 
             DrawStartScreen(winW, winH, titleFont, selectedOption);
-            EndDrawing();
+            endFrame();
             continue;
         }
 
         // -------------------- HOW TO PLAY --------------------
 
         if (currentState == STATE_HOW_TO) {
-            if (IsMusicStreamPlaying(introMusic)) {
-                UpdateMusicStream(introMusic);
-            }
-            DrawHowToScreen(winW, winH, titleFont);
+            DrawHowToScreen(winW, winH, assets.instructionFont);
             // Handle input to return to menu
             if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_ESCAPE)) {
                 currentState = STATE_MENU;
                 selectedOption = MENU_PLAY;  // Reset to "Play" for convenience
             }
-            EndDrawing();
+            endFrame();
             continue;  // Skip rest of loop
         }
 
 
         // -------------------- HIGH SCORE SCREEN --------------------
         if (currentState == STATE_HIGHSCORE) {
-            if (IsMusicStreamPlaying(introMusic)) {
-                UpdateMusicStream(introMusic);
-            }
 
-            DrawHighscoreScreen(winW, winH, titleFont, highscores, playerName);
+            if (IsKeyPressed(KEY_TAB)) highscoresByPlayer = !highscoresByPlayer;
+            // The server's view once it has arrived; the local log until then
+            HighscoreView view;
+            if (!leaderboard.isLinked() || !leaderboard.view(view)) view = MakeHighscoreView(scoreLog, playerName);
+            DrawHighscoreScreen(winW, winH, titleFont, view, highscoresByPlayer);
 
             if (IsKeyPressed(KEY_ENTER) || IsKeyPressed(KEY_ESCAPE)) {
                 currentState = STATE_MENU;
                 selectedOption = MENU_PLAY;
             }
 
-            EndDrawing();
+            endFrame();
             continue;
         }
 
@@ -311,9 +622,6 @@ int main() {
 
         if (currentState == STATE_LEVEL_SELECT){
 
-            if (IsMusicStreamPlaying(introMusic)) {
-                UpdateMusicStream(introMusic);
-            }
         
             DrawLevelSelectScreen(winW, winH, titleFont, selectedDifficulty);
 
@@ -327,24 +635,10 @@ int main() {
             {
                 gameDifficulty = (selectedDifficulty == 0 ? DIFF_EASY : DIFF_HARD);
 
-                // Apply difficulty BEFORE starting game
-                pac.lives = (gameDifficulty == DIFF_EASY ? 3 : 1);
-
-                // Set Pacman hard mode
-                //pac.isHard = (gameDifficulty == DIFF_HARD);
-				pac.setHardMode(gameDifficulty == DIFF_HARD);
-
-                // Set map mode
-                    maze.isHard = (gameDifficulty == DIFF_HARD);
-
-
-                // Increase ghost speed in hard mode
-                    red.setHardMode(gameDifficulty == DIFF_HARD);
-                    pink.setHardMode(gameDifficulty == DIFF_HARD);
-                    blue.setHardMode(gameDifficulty == DIFF_HARD);
-                    orange.setHardMode(gameDifficulty == DIFF_HARD);
+                // Apply difficulty BEFORE starting game: lives, speeds and the map's pellets
+                SetGameDifficulty(world, gameDifficulty == DIFF_HARD);
 
-                    StopMusicStream(introMusic);
+                    audio.stopMusic(MUSIC_INTRO);
 
 
                 currentState = STATE_PLAYING;
@@ -358,7 +652,7 @@ int main() {
                 selectedOption = MENU_PLAY;
             }
 
-            EndDrawing();
+            endFrame();
             continue;
         }
 
@@ -366,187 +660,134 @@ int main() {
 
         // -------------------- GAMEPLAY MODE --------------------
         ClearBackground(BLACK);
-        globalFrames++;
-
-        int pacGridX = (int)((pac.x + pac.tileSize / 2) / pac.tileSize);
-        int pacGridY = (int)((pac.y + pac.tileSize / 2) / pac.tileSize);
-
-        for (int i = 0; i < maze.mysteryPowerUps.size(); i++) {
-            int mx = maze.mysteryPowerUps[i].first;
-            int my = maze.mysteryPowerUps[i].second;
+        if (IsKeyPressed(KEY_F6)) autopilotOn = !autopilotOn;
+        if (IsKeyPressed(KEY_F8)) world.twoPhaseGhosts = !world.twoPhaseGhosts;
+        if (IsKeyPressed(KEY_F9)) crowdOn = !crowdOn;
+        if (crowdOn && world.crowd.empty() && !pac.dying) {
+            if (!world.crowd.spawn(maze, pac, crowdGhosts, random_device()())) crowdOn = false;
+        }
+        if (!crowdOn && !world.crowd.empty()) world.crowd.clear();
+        if (IsKeyPressed(KEY_F7)) {
+            world.ghostAI.config.enabled = !world.ghostAI.config.enabled;
+            world.ghostAI.resetStats();
+        }
+        if (autopilotOn) autopilot.drive(world, levels[currentLevel]);
+        UpdateGameplay(world, levels[currentLevel]);
 
-            if (pacGridX == mx && pacGridY == my) {
-                processMysteryPowerUp(pac);  // apply PQ logic
-                maze.mysteryPowerUps.erase(maze.mysteryPowerUps.begin() + i); // remove eaten tile
-                i--; // adjust index
+        // -------------------- NEXT LEVEL --------------------
+        if (!nextMaze && !replayLevel && levelLoader.ready()) {
+            nextMaze = levelLoader.take();
+            if (nextMaze) levelLoadFailures = 0;
+            else {
+                // Skip to the level after it; after a full lap of failures, replay this one
+                int failed = levelLoader.index();
+                cout << "Level '" << levels[failed].name << "' failed to load\n";
+                if (++levelLoadFailures < (int)levels.size())
+                    levelLoader.request(levels[(failed + 1) % levels.size()], (failed + 1) % (int)levels.size(), tileSize);
+                else replayLevel = true;
             }
         }
+        if (nextMaze) {
+            // Warm the next level's textures around its start, one chunk per frame
+            nextMaze->setHardMode(maze.isHard);
+            Rectangle startView = { nextMaze->pacStartX * (float)tileSize - winW / 2.0f,
+                nextMaze->pacStartY * (float)tileSize - winH / 2.0f, (float)winW, (float)winH };
+            nextMaze->prebake(startView, 1);
+        }
 
-        // Pacman death animation handler
-      
-            if (pac.dying) {
-                pac.death_timer++;
-                if (pac.death_timer > 90) {
-                    pac.dying = false;
-                    pac.death_timer = 0;
-
-                    // Reset Pac-Man
-                    pac.x = pac.startXPos;
-                    pac.y = pac.startYPos;
-                    pac.direction = Pacman::RIGHT;
-                    pac.desiredDirection = Pacman::RIGHT;
-
-                    // Reset Ghosts
-                    red.position = { (float)red.cageX * tileSize, (float)red.cageY * tileSize };
-                    pink.position = { (float)pink.cageX * tileSize, (float)pink.cageY * tileSize };
-                    orange.position = { (float)orange.cageX * tileSize, (float)orange.cageY * tileSize };  // Now correctly x=11
-                    blue.position = { (float)blue.cageX * tileSize, (float)blue.cageY * tileSize };        // Now correctly x=10
-
-
-                    red.frightened_mode = pink.frightened_mode = orange.frightened_mode = blue.frightened_mode = 0;
-
-                    // Ghost release reset
-                    redRelease.state = R_ACTIVE;
-                    pinkRelease.state = orangeRelease.state = blueRelease.state = R_IN_CAGE;
-
-                    globalFrames = 0;    // FOR RELEASE SYSTEM
-                }
+        // All pellets eaten: swap in the preloaded level, no loading in this frame
+        if (maze.pelletsLeft <= 0 && (nextMaze || replayLevel) && !pac.dying) {
+            if (nextMaze) {
+                currentLevel = levelLoader.index();
+                maze.replaceWith(move(*nextMaze));
+                nextMaze.reset();
             }
-        
-        else {
-            // Release ghosts
-            releaseGhost(pink, red, maze, tileSize, globalFrames, pinkRelease);
-            releaseGhost(orange, red, maze, tileSize, globalFrames, orangeRelease);
-            releaseGhost(blue, red, maze, tileSize, globalFrames, blueRelease);
+            else maze.reset();      // no level would load: play this one again
+            replayLevel = false;
+            levelLoadFailures = 0;
+            autopilot.forget();     // its copies read the old maze's nav tables
+            world.crowd.clear();    // respawned on the new maze below
+
+            StartLevel(levels[currentLevel], maze, pac, red, pink, orange, blue, tileSize);
+            redRelease = ReleaseInfo(); redRelease.state = R_ACTIVE;
+            pinkRelease = orangeRelease = blueRelease = ReleaseInfo();
+            frightenedTimer = 0;
+            globalFrames = 0;
+            waveTimer = 0;
+            scatterMode = true;
+
+            levelLoader.request(levels[(currentLevel + 1) % levels.size()], (currentLevel + 1) % (int)levels.size(), tileSize);
+        }
 
-            // 1?? Pac-Man moves
-            CoinList coins;
-            pac.updatePacMan(maze, coins);
+        // ---- Drawing ----
+        // Only chunks (and actors in chunks) under the camera are drawn
+        Rectangle view = maze.followCamera(camera, pac.x + tileSize / 2.0f, pac.y + tileSize / 2.0f, winW, winH);
+        maze.updateView(view);
 
-            // 2?? Check for large pellet
+        BeginMode2D(camera);
+        {
+            ScopedZone zone(PZ_MAP_DRAW);
+            maze.Draw();
+        }
+        {
+            ScopedZone zone(PZ_ACTOR_DRAW);
+            pac.draw();
 
-            // -------------------- Update ghosts (call in your main loop) --------------------
+            // ? ADDED ? proper flashing
+            bool flashing = (frightenedTimer >= pac.energizerFrames - FRIGHTENED_FLASH_FRAMES) && (frightenedTimer % 30 < 15);
 
-// Red
-            if (red.frightened_mode == 2) {
-                // eyes-eaten state ? backtrack to gate using BFS
-                backtrackToGate(red, maze, tileSize, 1.0f);
-            }
-            else {
-                // normal behaviour (frightened_mode==1 handled inside update if you implemented it)
-                red.update(pac, maze, tileSize, scatterMode);
-            }
+            if (maze.isVisible(red.position.x + tileSize / 2.0f, red.position.y + tileSize / 2.0f)) red.draw(flashing, tileSize);
+            if (maze.isVisible(pink.position.x + tileSize / 2.0f, pink.position.y + tileSize / 2.0f)) pink.draw(flashing, tileSize);
+            if (maze.isVisible(orange.position.x + tileSize / 2.0f, orange.position.y + tileSize / 2.0f)) orange.draw(flashing, tileSize);
+            if (maze.isVisible(blue.position.x + tileSize / 2.0f, blue.position.y + tileSize / 2.0f)) blue.draw(flashing, tileSize);
+            world.crowd.draw(maze, ghostTexture, pac.energizer_timer > 0, globalFrames);
+        }
+        EndMode2D();
 
-            // Pink
-            if (pink.frightened_mode == 2) {
-                backtrackToGate(pink, maze, tileSize, 1.0);
-            }
-            else {
-                pink.update(pac, maze, tileSize, scatterMode);
-            }
+        {
+            ScopedZone zone(PZ_HUD);
+            DrawLives(pac.lives, tileSize, winW);
 
-            // Orange
-            if (orange.frightened_mode == 2) {
-                backtrackToGate(orange, maze, tileSize, 1.0f);
-            }
-            else {
-                orange.update(pac, maze, tileSize, scatterMode);
-            }
+            DrawLives(pac.lives, tileSize, winW);
 
-            // Blue (note: Blue's update needs Red reference)
-            if (blue.frightened_mode == 2) {
-                backtrackToGate(blue, maze, tileSize, 1.0f);
-            }
-            else {
-                blue.update(pac, red, maze, tileSize, scatterMode);
-            }
+            string scoreText = "SCORE: " + to_string(pac.score);
+            DrawTextEx(titleFont, scoreText.c_str(), { 10, 10 }, 12, 2, WHITE);
 
+            string levelText = "LEVEL " + to_string(currentLevel + 1);
+            DrawTextEx(titleFont, levelText.c_str(), { 10, 28 }, 12, 2, WHITE);
 
+            int screenHeight = GetScreenHeight();
 
-            // -------------------- FRIGHTENED MODE --------------------
-            if (pac.energizer_timer > 0)
-            {
-                // Decrease energizer timer each frame
-                pac.energizer_timer--;
-
-                // Call frightened function
-                frightened(
-                    pac,
-                    red, pink, orange, blue,
-                    frightenedTimer,        // this will increment inside frightened()
-                    tileSize,
-                    redRelease, pinkRelease, orangeRelease, blueRelease,
-                    maze,
-                    globalFrames
-                );
+            string speedText = "Speed: " + to_string((int)(pac.speed * 10) / 10.0f);
+            DrawText(speedText.c_str(), 10, screenHeight - 30, 20, GREEN);
+            if (autopilotOn) DrawText("AUTOPILOT", 10, screenHeight - 55, 20, ORANGE);
+            if (!world.crowd.empty()) {
+                string crowdText = "CROWD " + to_string(world.crowd.size()) + "  " + to_string(world.crowd.stats().ms).substr(0, 5) + " ms";
+                DrawText(crowdText.c_str(), 10, screenHeight - 130, 20, PINK);
             }
-            else
-            {
-                // Energizer finished ? reset frightened mode if needed
-                if (frightenedTimer > 0)
-                {
-                    frightenedTimer = 0;
-                    red.frightened_mode = pink.frightened_mode = orange.frightened_mode = blue.frightened_mode = 0;
-
-                }
+            if (world.twoPhaseGhosts) DrawText(("GHOST JOBS x" + to_string(ghostJobs.threadCount())).c_str(), 10, screenHeight - 105, 20, SKYBLUE);
+            if (world.ghostAI.config.enabled) {
+                const GhostLodStats& s = world.ghostAI.frame;
+                string lodText = "GHOST LOD  decided " + to_string(s.decided) + " (" + to_string(s.forced) + " forced)  deferred "
+                    + to_string(s.deferred) + "  dropped " + to_string(s.dropped);
+                DrawText(lodText.c_str(), 10, screenHeight - 80, 20, SKYBLUE);
             }
-
-
-
-            // Collision detection
-            checkPacmanGhostCollision(
-                pac, red, pink, orange, blue,
-                tileSize, redRelease, blueRelease, pinkRelease, orangeRelease,
-                maze, globalFrames
-            );
-
-            // Scatter/Chase waves
-            waveTimer++;
-            if (scatterMode && waveTimer > 7 * 60) { scatterMode = false; waveTimer = 0; }
-            else if (!scatterMode && waveTimer > 20 * 60) { scatterMode = true; waveTimer = 0; }
-
-            // Update ghosts
-            red.update(pac, maze, tileSize, scatterMode);
-            if (pinkRelease.state == R_ACTIVE)   pink.update(pac, maze, tileSize, scatterMode);
-            if (orangeRelease.state == R_ACTIVE) orange.update(pac, maze, tileSize, scatterMode);
-            if (blueRelease.state == R_ACTIVE)   blue.update(pac, red, maze, tileSize, scatterMode);
         }
 
-        // ---- Drawing ----
-        maze.Draw();
-        pac.draw();
-
-        // ? ADDED ? proper flashing
-        bool flashing = (frightenedTimer >= FRIGHTENED_FLASH_START) && (frightenedTimer % 30 < 15);
-
-        red.draw(flashing, tileSize);
-        pink.draw(flashing, tileSize);
-        orange.draw(flashing, tileSize);
-        blue.draw(flashing, tileSize);
-
-        DrawLives(pac.lives, tileSize, winW);
-
-        DrawLives(pac.lives, tileSize, winW);
-
-        string scoreText = "SCORE: " + to_string(pac.score);
-        DrawTextEx(titleFont, scoreText.c_str(), { 10, 10 }, 12, 2, WHITE);
-
-        int screenWidth = GetScreenWidth();
-        int screenHeight = GetScreenHeight();
-
-        string speedText = "Speed: " + to_string((int)(pac.speed * 10) / 10.0f);
-        DrawText(speedText.c_str(), 10, screenHeight - 30, 20, GREEN);
-
-        EndDrawing();
+        endFrame();
     }
 
-    UnloadTexture(ghostTexture);
-
-    UnloadMusicStream(loadingMusic);
-    UnloadMusicStream(introMusic);
-
-    UnloadSound(gameOverSound);
+    maze.unloadChunks();
+    if (nextMaze) nextMaze->unloadChunks();
+    audio.stop();   // it streams from the music the loader owns
+    assetLoader.unload();
 
+    closeScores();
+    if (profiler.isTracing()) profiler.stopTrace();     // keep a trace cut short by quitting
+    if (trackAllocs) {
+        AllocTrackingEnable(false);
+        PrintAllocReport();
+    }
     CloseWindow();
     return 0;
 }
\ No newline at end of file